@@ -0,0 +1,209 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <cz/allocator.hpp>
+#include <cz/vector.hpp>
+#include "counting_allocator.hpp"
+
+namespace bench {
+
+uint64_t now_ns();
+
+/// Hardware performance counters read with `perf_event_open`.  Only Linux is
+/// supported.  Counters the kernel or CPU won't provide are left closed and
+/// skipped, so a benchmark run never fails because of them.
+///
+/// The counters are opened as one group so they are scheduled together and
+/// ratios like IPC compare counts from the same time window.
+struct Perf_Counters {
+    enum Counter {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        DTLB_MISSES,
+        NUM_COUNTERS,
+    };
+
+    static const char* const names[NUM_COUNTERS];
+
+    /// Open every counter.  Returns `false` if none could be opened.
+    bool open();
+    void close();
+
+    /// Zero the counters.  They start paused.
+    void reset();
+    void resume();
+    void pause();
+
+    /// Read the counts since `reset` into `values`, scaling them up
+    /// if the kernel had to multiplex the group with other events.
+    void read();
+
+    bool opened(size_t counter) const { return fds[counter] >= 0; }
+    /// Whether `values[counter]` is a real count from the last `read`.
+    bool available(size_t counter) const { return measured && opened(counter); }
+
+    int fds[NUM_COUNTERS];
+    uint64_t values[NUM_COUNTERS];
+    /// `false` if the last `read` failed or the kernel never scheduled the group.
+    bool measured;
+
+    /// The first counter opened.  The others are in its group.
+    int leader;
+    /// The position of each counter's value when reading the group.
+    size_t positions[NUM_COUNTERS];
+    size_t group_size;
+
+    /// The raw counts and times when `reset` was called.
+    uint64_t base_values[NUM_COUNTERS];
+    uint64_t base_time_enabled;
+    uint64_t base_time_running;
+    bool base_valid;
+};
+
+/// Counts the timed parts of the current benchmark if `--perf` was passed.
+extern Perf_Counters perf;
+extern bool perf_enabled;
+
+struct Context {
+    uint64_t start_ns;
+    uint64_t elapsed_ns;
+    uint64_t operations;
+
+    /// Latencies of individual operations timed by `sample`.
+    cz::Vector<uint64_t> samples;
+
+    /// Start timing.  Setup done before this call is not measured.
+    void start();
+
+    /// Stop timing and record that `operations` operations were performed.
+    void stop(uint64_t operations);
+
+    /// Time one operation.  Latency percentiles are reported for benchmarks that
+    /// use this.  Each call is counted as one operation so don't call `start`/`stop`.
+    template <class Func>
+    void sample(Func&& func) {
+        if (perf_enabled)
+            perf.resume();
+        uint64_t before = now_ns();
+        func();
+        uint64_t after = now_ns();
+        if (perf_enabled)
+            perf.pause();
+        elapsed_ns += after - before;
+        ++operations;
+        record_sample(after - before);
+    }
+
+    void record_sample(uint64_t ns);
+};
+
+typedef void (*Benchmark_Func)(Context* context);
+
+struct Benchmark {
+    const char* name;
+    Benchmark_Func func;
+};
+
+struct Register_Benchmark {
+    Register_Benchmark(const char* name, Benchmark_Func func);
+};
+
+/// Prevent the compiler from optimizing out the computation of `value`.
+template <class T>
+inline void keep(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+/// Deterministic pseudo random number generator (xorshift64*) so runs are reproducible.
+struct Random {
+    uint64_t state;
+
+    uint64_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1DULL;
+    }
+
+    /// Get a number in the range [0, bound).
+    uint64_t below(uint64_t bound) { return next() % bound; }
+
+    /// Get a number in the range [0, 1).
+    double uniform() { return (next() >> 11) * (1.0 / (1ull << 53)); }
+};
+
+/// Zipfian distributed ranks in the range [0, count) where rank 0 is the most
+/// popular.  This is the generator from YCSB (Gray et al., "Quickly Generating
+/// Billion-Record Synthetic Databases").  `init` is O(count).
+struct Zipfian {
+    uint64_t count;
+    double theta;
+    double alpha;
+    double zeta_n;
+    double eta;
+
+    void init(uint64_t count, double theta = 0.99);
+    uint64_t next(Random* random);
+
+    /// Same as `next` except popular ranks are scattered
+    /// throughout the range instead of clustered at the start.
+    uint64_t next_scrambled(Random* random);
+};
+
+/// Counts what the containers under test allocate.  Reset before each benchmark.
+extern ds::Counting_Allocator memory;
+
+/// The heap allocator, except usage is recorded in `memory`.
+cz::Allocator allocator();
+
+/// A standard library allocator that records usage in `memory` so
+/// standard containers can be compared against ours.
+template <class T>
+struct Std_Allocator {
+    typedef T value_type;
+
+    Std_Allocator() {}
+    template <class U>
+    Std_Allocator(const Std_Allocator<U>&) {}
+
+    T* allocate(size_t n) { return (T*)allocator().alloc({n * sizeof(T), alignof(T)}); }
+    void deallocate(T* pointer, size_t n) { allocator().dealloc({pointer, n * sizeof(T)}); }
+
+    template <class U>
+    bool operator==(const Std_Allocator<U>&) const {
+        return true;
+    }
+    template <class U>
+    bool operator!=(const Std_Allocator<U>&) const {
+        return false;
+    }
+};
+
+}
+
+#define BENCH_CAT2(x, y) x##y
+#define BENCH_CAT(x, y) BENCH_CAT2(x, y)
+
+/// Define a benchmark.  Example:
+/// ```
+/// BENCHMARK("Page_Table lookup") {
+///     /* setup */
+///     context->start();
+///     /* measured loop */
+///     context->stop(operations);
+/// }
+/// ```
+#define BENCHMARK(NAME)                                                                  \
+    static void BENCH_CAT(benchmark_, __LINE__)(bench::Context * context);               \
+    static bench::Register_Benchmark BENCH_CAT(register_benchmark_, __LINE__)(           \
+        NAME, BENCH_CAT(benchmark_, __LINE__));                                          \
+    static void BENCH_CAT(benchmark_, __LINE__)(bench::Context * context)
@@ -0,0 +1,502 @@
+#include "benchmark.hpp"
+
+#include <stdio.h>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <cz/defer.hpp>
+#include <cz/heap.hpp>
+#include "btree.hpp"
+#include "buffered_btree.hpp"
+#include "btree_map.hpp"
+#include "hash_map.hpp"
+#include "page_table.hpp"
+#include "splay_map.hpp"
+#include "splay_tree.hpp"
+#include "ssostr.hpp"
+#include "string_arena.hpp"
+
+// Compares our containers against the standard library across access patterns.
+// Memory is measured through `bench::allocator` and `bench::Std_Allocator` so only
+// the containers' own allocations count.  String keys live outside the container
+// (in a `String_Arena` for `SSOStr` or in `std::string`'s own buffer) and aren't counted.
+
+static const uint64_t lookups = 1 << 20;
+static const size_t scan_length = 100;
+
+/// Keys are generated from integers.  String keys are zero padded so they sort numerically.
+/// Long keys are 24 characters so `SSOStr` stores them in the arena and `std::string` on
+/// the heap.  Short keys are 15 characters so both store them inline.
+static void make_key(ds::String_Arena*, uint64_t number, bool, uint64_t* key) {
+    *key = number;
+}
+static int format_key(char (&buffer)[32], uint64_t number, bool short_key) {
+    if (short_key) {
+        // Keep 56 bits so the key fits.  Random keys are still distinct.
+        return snprintf(buffer, sizeof(buffer), "k%014llx",
+                        (unsigned long long)(number & (((uint64_t)1 << 56) - 1)));
+    }
+    return snprintf(buffer, sizeof(buffer), "key:%020llu", (unsigned long long)number);
+}
+static void make_key(ds::String_Arena* arena, uint64_t number, bool short_key, ds::SSOStr* key) {
+    char buffer[32];
+    int len = format_key(buffer, number, short_key);
+    *key = ds::SSOStr::in_arena(arena, cz::heap_allocator(), {buffer, (size_t)len});
+}
+static void make_key(ds::String_Arena*, uint64_t number, bool short_key, std::string* key) {
+    char buffer[32];
+    int len = format_key(buffer, number, short_key);
+    key->assign(buffer, len);
+}
+
+static uint64_t key_weight(uint64_t key) {
+    return key;
+}
+static uint64_t key_weight(const ds::SSOStr& key) {
+    return key.len();
+}
+static uint64_t key_weight(const std::string& key) {
+    return key.size();
+}
+
+template <class Key_>
+struct Btree_Set {
+    typedef Key_ Key;
+    static const bool random_keys = true;
+    ds::btree::Tree<Key> tree;
+
+    void insert(const Key& key) { tree.insert(bench::allocator(), key); }
+    bool contains(const Key& key) { return tree.find(key) != tree.end(); }
+    uint64_t scan(const Key& first, size_t count) {
+        uint64_t sum = 0;
+        for (auto it = tree.find_ge(first), end = tree.end(); it != end && count; ++it, --count) {
+            sum += key_weight(*it);
+        }
+        return sum;
+    }
+    void drop() { tree.drop(bench::allocator()); }
+};
+
+template <class Key_>
+struct Btree_Map {
+    typedef Key_ Key;
+    static const bool random_keys = true;
+    ds::btree::Map<Key, uint64_t> map;
+
+    void insert(const Key& key) { map.insert(bench::allocator(), key, 0); }
+    bool contains(const Key& key) { return map.find(key) != map.end(); }
+    uint64_t scan(const Key& first, size_t count) {
+        uint64_t sum = 0;
+        for (auto it = map.find_ge(first), end = map.end(); it != end && count; ++it, --count) {
+            sum += key_weight(it->key) + it->value;
+        }
+        return sum;
+    }
+    void drop() { map.drop(bench::allocator()); }
+};
+
+template <class Key_>
+struct Buffered_Btree_Set {
+    typedef Key_ Key;
+    static const bool random_keys = true;
+    ds::btree::Buffered_Tree<Key> tree;
+
+    void insert(const Key& key) { tree.insert(bench::allocator(), key); }
+    bool contains(const Key& key) { return tree.find(key) != nullptr; }
+    uint64_t scan(const Key& first, size_t count) {
+        uint64_t sum = 0;
+        for (const Key* it = tree.find_ge(first); it && count; it = tree.find_gt(*it), --count) {
+            sum += key_weight(*it);
+        }
+        return sum;
+    }
+    void drop() { tree.drop(bench::allocator()); }
+};
+
+template <class Key_>
+struct Splay_Set {
+    typedef Key_ Key;
+    static const bool random_keys = true;
+    ds::splay::Tree<Key> tree;
+
+    void insert(const Key& key) { tree.insert(bench::allocator(), key); }
+    bool contains(const Key& key) { return tree.contains(key); }
+    uint64_t scan(const Key& first, size_t count) {
+        uint64_t sum = 0;
+        for (auto it = tree.find_greater_equal(first); it != tree.end() && count; ++it, --count) {
+            sum += key_weight(*it);
+        }
+        return sum;
+    }
+    void drop() { tree.drop(bench::allocator()); }
+};
+
+template <class Key_>
+struct Splay_Map {
+    typedef Key_ Key;
+    static const bool random_keys = true;
+    ds::splay::Map<Key, uint64_t> map;
+
+    void insert(const Key& key) { map.insert(bench::allocator(), key, 0); }
+    bool contains(const Key& key) { return map.contains(key); }
+    uint64_t scan(const Key& first, size_t count) {
+        uint64_t sum = 0;
+        for (auto it = map.find_greater_equal(first); it != map.end() && count; ++it, --count) {
+            sum += key_weight(it->key) + it->value;
+        }
+        return sum;
+    }
+    void drop() { map.drop(bench::allocator()); }
+};
+
+template <class Key_>
+struct Std_Set {
+    typedef Key_ Key;
+    static const bool random_keys = true;
+    std::set<Key, std::less<Key>, bench::Std_Allocator<Key> > set;
+
+    void insert(const Key& key) { set.insert(key); }
+    bool contains(const Key& key) { return set.find(key) != set.end(); }
+    uint64_t scan(const Key& first, size_t count) {
+        uint64_t sum = 0;
+        for (auto it = set.lower_bound(first); it != set.end() && count; ++it, --count) {
+            sum += key_weight(*it);
+        }
+        return sum;
+    }
+    void drop() { set.clear(); }
+};
+
+template <class Key_>
+struct Std_Map {
+    typedef Key_ Key;
+    static const bool random_keys = true;
+    typedef std::pair<const Key, uint64_t> Pair;
+    std::map<Key, uint64_t, std::less<Key>, bench::Std_Allocator<Pair> > map;
+
+    void insert(const Key& key) { map.insert(Pair(key, 0)); }
+    bool contains(const Key& key) { return map.find(key) != map.end(); }
+    uint64_t scan(const Key& first, size_t count) {
+        uint64_t sum = 0;
+        for (auto it = map.lower_bound(first); it != map.end() && count; ++it, --count) {
+            sum += key_weight(it->first) + it->second;
+        }
+        return sum;
+    }
+    void drop() { map.clear(); }
+};
+
+template <class Key_>
+struct Std_Unordered_Map {
+    typedef Key_ Key;
+    static const bool random_keys = true;
+    typedef std::pair<const Key, uint64_t> Pair;
+    std::unordered_map<Key, uint64_t, std::hash<Key>, std::equal_to<Key>,
+                       bench::Std_Allocator<Pair> >
+        map;
+
+    void insert(const Key& key) { map.insert(Pair(key, 0)); }
+    bool contains(const Key& key) { return map.find(key) != map.end(); }
+    /// Unordered so scans are never registered.
+    uint64_t scan(const Key&, size_t) { return 0; }
+    void drop() { map.clear(); }
+};
+
+template <class Key_>
+struct Hash_Map {
+    typedef Key_ Key;
+    static const bool random_keys = true;
+    ds::hash::Map<Key, uint64_t> map;
+
+    void insert(const Key& key) { map.insert(bench::allocator(), key, 0); }
+    bool contains(const Key& key) { return map.find(key) != map.end(); }
+    /// Unordered so scans are never registered.
+    uint64_t scan(const Key&, size_t) { return 0; }
+    void drop() { map.drop(bench::allocator()); }
+};
+
+/// Ids are assigned by `add` so only dense sequential keys are supported.
+struct Page_Table_Adapter {
+    typedef uint64_t Key;
+    static const bool random_keys = false;
+    ds::pt::Page_Table<uint64_t> page_table;
+    ds::pt::Lookup_Cursor<uint64_t> cursor;
+
+    void insert(uint64_t key) {
+        uint64_t id = page_table.add(bench::allocator(), key);
+        CZ_DEBUG_ASSERT(id == key);
+        (void)id;
+    }
+    bool contains(uint64_t key) { return page_table.lookup(key) != nullptr; }
+    uint64_t scan(uint64_t first, size_t count) {
+        uint64_t sum = 0;
+        for (uint64_t id = first; id < page_table.next_id && count; ++id, --count) {
+            sum += *page_table.lookup(&cursor, id);
+        }
+        return sum;
+    }
+    void drop() { page_table.drop(bench::allocator()); }
+};
+
+/// Run `Container` with short string keys.  See `make_key`.
+template <class Container>
+struct Short_Keys : Container {};
+
+template <class Container>
+struct Uses_Short_Keys {
+    static const bool value = false;
+};
+template <class Container>
+struct Uses_Short_Keys<Short_Keys<Container> > {
+    static const bool value = true;
+};
+
+enum Operation {
+    INSERT_SEQUENTIAL,
+    INSERT_RANDOM,
+    INSERT_ZIPFIAN,
+    LOOKUP_RANDOM,
+    LOOKUP_ZIPFIAN,
+    SCAN,
+    DROP,
+};
+
+/// Fill `keys` with `size` keys.  Random keys are distinct with overwhelming probability.
+template <class Key>
+static void make_keys(ds::String_Arena* arena,
+                      std::vector<Key>* keys,
+                      uint64_t size,
+                      bool random,
+                      bool short_keys) {
+    bench::Random generator = {1};
+    keys->resize(size);
+    for (uint64_t i = 0; i < size; ++i) {
+        make_key(arena, random ? generator.next() : i, short_keys, &(*keys)[i]);
+    }
+}
+
+template <class Container, uint64_t Size, Operation Op>
+static void run(bench::Context* context) {
+    typedef typename Container::Key Key;
+
+    ds::String_Arena arena = {};
+    CZ_DEFER(arena.drop(cz::heap_allocator()));
+    Container container = {};
+
+    bool random_keys = Container::random_keys && Op != INSERT_SEQUENTIAL && Op != INSERT_ZIPFIAN;
+    std::vector<Key> keys;
+    make_keys(&arena, &keys, Size, random_keys, Uses_Short_Keys<Container>::value);
+
+    // Choose which keys to access up front so the generators aren't timed.
+    bool zipfian_access = Op == INSERT_ZIPFIAN || Op == LOOKUP_ZIPFIAN;
+    uint64_t accesses = Op == INSERT_ZIPFIAN ? Size : lookups;
+    std::vector<uint64_t> indices(accesses);
+    bench::Random random = {2};
+    bench::Zipfian zipfian = {};
+    if (zipfian_access)
+        zipfian.init(Size);
+    for (uint64_t i = 0; i < accesses; ++i) {
+        indices[i] = zipfian_access ? zipfian.next_scrambled(&random) : random.below(Size);
+    }
+
+    uint64_t sum = 0;
+    switch (Op) {
+    case INSERT_SEQUENTIAL:
+    case INSERT_RANDOM:
+        context->start();
+        for (uint64_t i = 0; i < Size; ++i) {
+            container.insert(keys[i]);
+        }
+        context->stop(Size);
+        break;
+
+    case INSERT_ZIPFIAN:
+        // Most inserts are of keys that are already present.
+        context->start();
+        for (uint64_t i = 0; i < Size; ++i) {
+            container.insert(keys[indices[i]]);
+        }
+        context->stop(Size);
+        break;
+
+    case LOOKUP_RANDOM:
+    case LOOKUP_ZIPFIAN:
+        for (uint64_t i = 0; i < Size; ++i) {
+            container.insert(keys[i]);
+        }
+        context->start();
+        for (uint64_t i = 0; i < lookups; ++i) {
+            sum += container.contains(keys[indices[i]]);
+        }
+        context->stop(lookups);
+        break;
+
+    case SCAN:
+        for (uint64_t i = 0; i < Size; ++i) {
+            container.insert(keys[i]);
+        }
+        context->start();
+        for (uint64_t i = 0; i < lookups / scan_length; ++i) {
+            sum += container.scan(keys[indices[i]], scan_length);
+        }
+        context->stop(lookups / scan_length * scan_length);
+        break;
+
+    case DROP:
+        for (uint64_t i = 0; i < Size; ++i) {
+            container.insert(keys[i]);
+        }
+        context->start();
+        container.drop();
+        context->stop(Size);
+        bench::keep(sum);
+        return;
+    }
+
+    container.drop();
+    bench::keep(sum);
+}
+
+#define UNORDERED_BENCHMARKS(NAME, CONTAINER, SIZE, SIZE_NAME)                                    \
+    bench::Register_Benchmark(NAME " " SIZE_NAME " insert sequential",                           \
+                              &run<CONTAINER, SIZE, INSERT_SEQUENTIAL>),                         \
+        bench::Register_Benchmark(NAME " " SIZE_NAME " insert random",                           \
+                                  &run<CONTAINER, SIZE, INSERT_RANDOM>),                         \
+        bench::Register_Benchmark(NAME " " SIZE_NAME " insert zipfian",                          \
+                                  &run<CONTAINER, SIZE, INSERT_ZIPFIAN>),                        \
+        bench::Register_Benchmark(NAME " " SIZE_NAME " lookup random",                           \
+                                  &run<CONTAINER, SIZE, LOOKUP_RANDOM>),                         \
+        bench::Register_Benchmark(NAME " " SIZE_NAME " lookup zipfian",                          \
+                                  &run<CONTAINER, SIZE, LOOKUP_ZIPFIAN>),                        \
+        bench::Register_Benchmark(NAME " " SIZE_NAME " drop", &run<CONTAINER, SIZE, DROP>)
+
+#define ORDERED_BENCHMARKS(NAME, CONTAINER, SIZE, SIZE_NAME)  \
+    UNORDERED_BENCHMARKS(NAME, CONTAINER, SIZE, SIZE_NAME),   \
+        bench::Register_Benchmark(NAME " " SIZE_NAME " scan", &run<CONTAINER, SIZE, SCAN>)
+
+#define ORDERED_BENCHMARKS_SIZES(NAME, CONTAINER)            \
+    ORDERED_BENCHMARKS(NAME, CONTAINER, 1 << 10, "1K"),      \
+        ORDERED_BENCHMARKS(NAME, CONTAINER, 1 << 18, "256K")
+
+#define UNORDERED_BENCHMARKS_SIZES(NAME, CONTAINER)          \
+    UNORDERED_BENCHMARKS(NAME, CONTAINER, 1 << 10, "1K"),    \
+        UNORDERED_BENCHMARKS(NAME, CONTAINER, 1 << 18, "256K")
+
+#define PAGE_TABLE_BENCHMARKS(SIZE, SIZE_NAME)                                                  \
+    bench::Register_Benchmark("pt::Page_Table " SIZE_NAME " insert sequential",                \
+                              &run<Page_Table_Adapter, SIZE, INSERT_SEQUENTIAL>),              \
+        bench::Register_Benchmark("pt::Page_Table " SIZE_NAME " lookup random",                \
+                                  &run<Page_Table_Adapter, SIZE, LOOKUP_RANDOM>),              \
+        bench::Register_Benchmark("pt::Page_Table " SIZE_NAME " lookup zipfian",               \
+                                  &run<Page_Table_Adapter, SIZE, LOOKUP_ZIPFIAN>),             \
+        bench::Register_Benchmark("pt::Page_Table " SIZE_NAME " scan",                         \
+                                  &run<Page_Table_Adapter, SIZE, SCAN>),                       \
+        bench::Register_Benchmark("pt::Page_Table " SIZE_NAME " drop",                         \
+                                  &run<Page_Table_Adapter, SIZE, DROP>)
+
+static bench::Register_Benchmark container_benchmarks[] = {
+    ORDERED_BENCHMARKS_SIZES("btree::Tree<u64>", Btree_Set<uint64_t>),
+    ORDERED_BENCHMARKS_SIZES("btree::Map<u64>", Btree_Map<uint64_t>),
+    ORDERED_BENCHMARKS_SIZES("btree::Buffered_Tree<u64>", Buffered_Btree_Set<uint64_t>),
+    ORDERED_BENCHMARKS_SIZES("splay::Tree<u64>", Splay_Set<uint64_t>),
+    ORDERED_BENCHMARKS_SIZES("splay::Map<u64>", Splay_Map<uint64_t>),
+    ORDERED_BENCHMARKS_SIZES("std::set<u64>", Std_Set<uint64_t>),
+    ORDERED_BENCHMARKS_SIZES("std::map<u64>", Std_Map<uint64_t>),
+    UNORDERED_BENCHMARKS_SIZES("hash::Map<u64>", Hash_Map<uint64_t>),
+    UNORDERED_BENCHMARKS_SIZES("std::unordered_map<u64>", Std_Unordered_Map<uint64_t>),
+    PAGE_TABLE_BENCHMARKS(1 << 10, "1K"),
+    PAGE_TABLE_BENCHMARKS(1 << 18, "256K"),
+
+    ORDERED_BENCHMARKS_SIZES("btree::Tree<SSOStr>", Btree_Set<ds::SSOStr>),
+    ORDERED_BENCHMARKS_SIZES("btree::Map<SSOStr>", Btree_Map<ds::SSOStr>),
+    ORDERED_BENCHMARKS_SIZES("btree::Buffered_Tree<SSOStr>", Buffered_Btree_Set<ds::SSOStr>),
+    ORDERED_BENCHMARKS_SIZES("splay::Tree<SSOStr>", Splay_Set<ds::SSOStr>),
+    ORDERED_BENCHMARKS_SIZES("splay::Map<SSOStr>", Splay_Map<ds::SSOStr>),
+    ORDERED_BENCHMARKS_SIZES("std::set<string>", Std_Set<std::string>),
+    ORDERED_BENCHMARKS_SIZES("std::map<string>", Std_Map<std::string>),
+    UNORDERED_BENCHMARKS_SIZES("hash::Map<SSOStr>", Hash_Map<ds::SSOStr>),
+    UNORDERED_BENCHMARKS_SIZES("std::unordered_map<string>", Std_Unordered_Map<std::string>),
+
+    ORDERED_BENCHMARKS_SIZES("btree::Tree<short SSOStr>", Short_Keys<Btree_Set<ds::SSOStr> >),
+    ORDERED_BENCHMARKS_SIZES("btree::Map<short SSOStr>", Short_Keys<Btree_Map<ds::SSOStr> >),
+    ORDERED_BENCHMARKS_SIZES("btree::Buffered_Tree<short SSOStr>",
+                             Short_Keys<Buffered_Btree_Set<ds::SSOStr> >),
+    ORDERED_BENCHMARKS_SIZES("splay::Tree<short SSOStr>", Short_Keys<Splay_Set<ds::SSOStr> >),
+    ORDERED_BENCHMARKS_SIZES("splay::Map<short SSOStr>", Short_Keys<Splay_Map<ds::SSOStr> >),
+    ORDERED_BENCHMARKS_SIZES("std::set<short string>", Short_Keys<Std_Set<std::string> >),
+    ORDERED_BENCHMARKS_SIZES("std::map<short string>", Short_Keys<Std_Map<std::string> >),
+    UNORDERED_BENCHMARKS_SIZES("hash::Map<short SSOStr>", Short_Keys<Hash_Map<ds::SSOStr> >),
+    UNORDERED_BENCHMARKS_SIZES("std::unordered_map<short string>",
+                               Short_Keys<Std_Unordered_Map<std::string> >),
+};
+
+/// Count how often each key appears, the way an aggregation loop would.  Keys are zipfian
+/// so most are already present.  Compares a `find` then `insert` with one descent.
+template <bool Single_Descent>
+static void count_keys(bench::Context* context) {
+    ds::btree::Map<uint64_t, uint64_t> map = {};
+    CZ_DEFER(map.drop(bench::allocator()));
+
+    const uint64_t size = 1 << 18;
+    std::vector<uint64_t> keys(lookups);
+    bench::Random random = {2};
+    bench::Zipfian zipfian = {};
+    zipfian.init(size);
+    for (uint64_t i = 0; i < lookups; ++i) {
+        keys[i] = zipfian.next_scrambled(&random);
+    }
+
+    context->start();
+    for (uint64_t i = 0; i < lookups; ++i) {
+        if (Single_Descent) {
+            ++map.get_or_insert_default(bench::allocator(), keys[i])->value;
+        } else {
+            auto it = map.find(keys[i]);
+            if (it != map.end()) {
+                ++it->value;
+            } else {
+                map.insert(bench::allocator(), keys[i], 1);
+            }
+        }
+    }
+    context->stop(lookups);
+}
+
+BENCHMARK("btree::Map<u64> 256K count find then insert") {
+    count_keys<false>(context);
+}
+BENCHMARK("btree::Map<u64> 256K count get_or_insert_default") {
+    count_keys<true>(context);
+}
+
+/// Expire the older half of a tree of timestamps, the way a retention job would.
+/// Compares removing one element at a time with one `erase_range`.
+template <bool Range>
+static void expire_keys(bench::Context* context) {
+    ds::btree::Tree<uint64_t> tree = {};
+    CZ_DEFER(tree.drop(bench::allocator()));
+
+    const uint64_t size = 1 << 18;
+    for (uint64_t i = 0; i < size; ++i) {
+        tree.insert(bench::allocator(), i);
+    }
+
+    context->start();
+    if (Range) {
+        tree.erase_range(bench::allocator(), 0, size / 2);
+    } else {
+        while (tree.count > 0 && *tree.start() < size / 2) {
+            tree.remove(bench::allocator(), tree.start());
+        }
+    }
+    context->stop(size / 2);
+}
+
+BENCHMARK("btree::Tree<u64> 256K expire half remove") {
+    expire_keys<false>(context);
+}
+BENCHMARK("btree::Tree<u64> 256K expire half erase_range") {
+    expire_keys<true>(context);
+}
@@ -0,0 +1,215 @@
+#include "benchmark.hpp"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <cz/heap.hpp>
+
+namespace bench {
+
+static Benchmark benchmarks[1024];
+static size_t num_benchmarks;
+
+Register_Benchmark::Register_Benchmark(const char* name, Benchmark_Func func) {
+    if (num_benchmarks < sizeof(benchmarks) / sizeof(benchmarks[0])) {
+        benchmarks[num_benchmarks++] = {name, func};
+    }
+}
+
+uint64_t now_ns() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(now).count();
+}
+
+void Context::start() {
+    if (perf_enabled)
+        perf.resume();
+    start_ns = now_ns();
+}
+
+void Context::stop(uint64_t ops) {
+    elapsed_ns += now_ns() - start_ns;
+    if (perf_enabled)
+        perf.pause();
+    operations += ops;
+}
+
+ds::Counting_Allocator memory = {};
+
+cz::Allocator allocator() {
+    return memory.allocator();
+}
+
+static double zeta(uint64_t count, double theta) {
+    double sum = 0;
+    for (uint64_t i = 1; i <= count; ++i) {
+        sum += 1 / pow((double)i, theta);
+    }
+    return sum;
+}
+
+void Zipfian::init(uint64_t count_, double theta_) {
+    count = count_;
+    theta = theta_;
+    alpha = 1 / (1 - theta);
+    zeta_n = zeta(count, theta);
+    eta = (1 - pow(2.0 / count, 1 - theta)) / (1 - zeta(2, theta) / zeta_n);
+}
+
+uint64_t Zipfian::next(Random* random) {
+    double u = random->uniform();
+    double uz = u * zeta_n;
+    if (uz < 1)
+        return 0;
+    if (uz < 1 + pow(0.5, theta))
+        return 1;
+    uint64_t rank = (uint64_t)(count * pow(eta * u - eta + 1, alpha));
+    return rank < count ? rank : count - 1;
+}
+
+uint64_t Zipfian::next_scrambled(Random* random) {
+    // Hash the rank so popular keys are not next to each other.
+    uint64_t rank = next(random);
+    Random scramble = {rank ^ 0xcbf29ce484222325ull};
+    return scramble.next() % count;
+}
+
+void Context::record_sample(uint64_t ns) {
+    samples.reserve(cz::heap_allocator(), 1);
+    samples.push(ns);
+}
+
+/// Get the latency at percentile `percent` of the sorted samples.
+static uint64_t percentile(cz::Vector<uint64_t>* samples, size_t percent) {
+    size_t index = (samples->len - 1) * percent / 100;
+    return (*samples)[index];
+}
+
+/// Print the hardware counters per operation.
+static void report_counters(uint64_t operations) {
+    const char* labels[Perf_Counters::NUM_COUNTERS] = {
+        "cyc", "ins", "L1D miss", "LLC miss", "br miss", "dTLB miss",
+    };
+    if (!perf.measured) {
+        printf("  (counters not scheduled)");
+        return;
+    }
+    for (size_t i = 0; i < Perf_Counters::NUM_COUNTERS; ++i) {
+        if (perf.available(i)) {
+            printf("  %8.2f %s/op", (double)perf.values[i] / operations, labels[i]);
+        }
+    }
+    if (perf.available(Perf_Counters::CYCLES) && perf.available(Perf_Counters::INSTRUCTIONS) &&
+        perf.values[Perf_Counters::CYCLES] > 0) {
+        printf("  %5.2f IPC", (double)perf.values[Perf_Counters::INSTRUCTIONS] /
+                                  perf.values[Perf_Counters::CYCLES]);
+    }
+}
+
+/// Print one benchmark's results.  `json` prints one JSON object per line for scripts.
+static void report(const char* name, Context* context, bool json) {
+    double ns_per_op = context->operations ? (double)context->elapsed_ns / context->operations : 0;
+    double ops_per_sec = ns_per_op > 0 ? 1e9 / ns_per_op : 0;
+
+    uint64_t p50 = 0, p99 = 0, max = 0;
+    if (context->samples.len > 0) {
+        std::sort(context->samples.begin(), context->samples.end());
+        p50 = percentile(&context->samples, 50);
+        p99 = percentile(&context->samples, 99);
+        max = context->samples.last();
+    }
+
+    ds::Allocation_Counts counts = memory.counts();
+
+    if (json) {
+        printf("{\"name\": \"%s\", \"ns_per_op\": %.3f, \"ops_per_sec\": %.1f, "
+               "\"operations\": %llu, \"peak_bytes\": %llu, \"allocations\": %llu, "
+               "\"deallocations\": %llu, \"reallocations\": %llu, \"bytes_allocated\": %llu",
+               name, ns_per_op, ops_per_sec, (unsigned long long)context->operations,
+               (unsigned long long)counts.peak_live_bytes,
+               (unsigned long long)counts.allocations, (unsigned long long)counts.deallocations,
+               (unsigned long long)counts.reallocations,
+               (unsigned long long)counts.bytes_allocated);
+        if (context->samples.len > 0) {
+            printf(", \"p50_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu",
+                   (unsigned long long)p50, (unsigned long long)p99, (unsigned long long)max);
+        }
+        if (perf_enabled && context->operations > 0) {
+            // Counters that were opened but not counted are null so every line has them.
+            for (size_t i = 0; i < Perf_Counters::NUM_COUNTERS; ++i) {
+                if (perf.available(i)) {
+                    printf(", \"%s_per_op\": %.3f", Perf_Counters::names[i],
+                           (double)perf.values[i] / context->operations);
+                } else if (perf.opened(i)) {
+                    printf(", \"%s_per_op\": null", Perf_Counters::names[i]);
+                }
+            }
+        }
+        printf("}\n");
+        return;
+    }
+
+    printf("%-56s %10.2f ns/op %10.2f Mop/s %12llu ops", name, ns_per_op, ops_per_sec / 1e6,
+           (unsigned long long)context->operations);
+    if (counts.peak_live_bytes > 0) {
+        printf(" %10.1f KiB peak", counts.peak_live_bytes / 1024.0);
+    }
+    if (context->samples.len > 0) {
+        printf("  p50 %8llu ns  p99 %8llu ns  max %10llu ns", (unsigned long long)p50,
+               (unsigned long long)p99, (unsigned long long)max);
+    }
+    if (perf_enabled && context->operations > 0) {
+        report_counters(context->operations);
+    }
+    printf("\n");
+}
+
+}
+
+int main(int argc, char** argv) {
+    using namespace bench;
+
+    // Usage: data_structures-bench [--json] [--perf] [filter]
+    // The filter limits the benchmarks to those whose name contains it.
+    // `--perf` also reports hardware counters per operation.
+    bool json = false;
+    const char* filter = "";
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--json") == 0)
+            json = true;
+        else if (strcmp(argv[i], "--perf") == 0)
+            perf_enabled = true;
+        else
+            filter = argv[i];
+    }
+
+    if (perf_enabled && !perf.open()) {
+        fprintf(stderr,
+                "Hardware counters are unavailable (check /proc/sys/kernel/perf_event_paranoid); "
+                "continuing without them.\n");
+        perf_enabled = false;
+    }
+
+    for (size_t i = 0; i < num_benchmarks; ++i) {
+        Benchmark* benchmark = &benchmarks[i];
+        if (!strstr(benchmark->name, filter))
+            continue;
+
+        Context context = {};
+        memory.reset();
+        memory.inner = cz::heap_allocator();
+        if (perf_enabled)
+            perf.reset();
+        benchmark->func(&context);
+        if (perf_enabled)
+            perf.read();
+        report(benchmark->name, &context, json);
+        context.samples.drop(cz::heap_allocator());
+    }
+
+    if (perf_enabled)
+        perf.close();
+    return 0;
+}
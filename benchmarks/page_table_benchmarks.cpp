@@ -0,0 +1,111 @@
+#include "benchmark.hpp"
+
+#include <stdio.h>
+#include <cz/defer.hpp>
+#include "page_table.hpp"
+
+using namespace ds::pt;
+
+static const uint64_t page_table_size = 1 << 20;
+static const uint64_t page_table_lookups = 1 << 24;
+
+static void fill(Page_Table<uint64_t>* page_table, uint64_t count) {
+    for (uint64_t i = 0; i < count; ++i) {
+        page_table->add(bench::allocator(), i);
+    }
+}
+
+BENCHMARK("Page_Table add") {
+    Page_Table<uint64_t> page_table = {};
+    CZ_DEFER(page_table.drop(bench::allocator()));
+
+    context->start();
+    fill(&page_table, page_table_size);
+    context->stop(page_table_size);
+}
+
+BENCHMARK("Page_Table lookup sequential") {
+    Page_Table<uint64_t> page_table = {};
+    CZ_DEFER(page_table.drop(bench::allocator()));
+    fill(&page_table, page_table_size);
+
+    uint64_t sum = 0;
+    context->start();
+    for (uint64_t i = 0; i < page_table_lookups; ++i) {
+        sum += *page_table.lookup(i & (page_table_size - 1));
+    }
+    context->stop(page_table_lookups);
+    bench::keep(sum);
+}
+
+BENCHMARK("Page_Table lookup sequential cursor") {
+    Page_Table<uint64_t> page_table = {};
+    CZ_DEFER(page_table.drop(bench::allocator()));
+    fill(&page_table, page_table_size);
+
+    Lookup_Cursor<uint64_t> cursor = {};
+    uint64_t sum = 0;
+    context->start();
+    for (uint64_t i = 0; i < page_table_lookups; ++i) {
+        sum += *page_table.lookup(&cursor, i & (page_table_size - 1));
+    }
+    context->stop(page_table_lookups);
+    bench::keep(sum);
+}
+
+BENCHMARK("Page_Table lookup random") {
+    Page_Table<uint64_t> page_table = {};
+    CZ_DEFER(page_table.drop(bench::allocator()));
+    fill(&page_table, page_table_size);
+
+    bench::Random random = {1};
+    uint64_t sum = 0;
+    context->start();
+    for (uint64_t i = 0; i < page_table_lookups; ++i) {
+        sum += *page_table.lookup(random.below(page_table_size));
+    }
+    context->stop(page_table_lookups);
+    bench::keep(sum);
+}
+
+BENCHMARK("Page_Table lookup random cursor") {
+    Page_Table<uint64_t> page_table = {};
+    CZ_DEFER(page_table.drop(bench::allocator()));
+    fill(&page_table, page_table_size);
+
+    Lookup_Cursor<uint64_t> cursor = {};
+    bench::Random random = {1};
+    uint64_t sum = 0;
+    context->start();
+    for (uint64_t i = 0; i < page_table_lookups; ++i) {
+        sum += *page_table.lookup(&cursor, random.below(page_table_size));
+    }
+    context->stop(page_table_lookups);
+    bench::keep(sum);
+}
+
+BENCHMARK("Page_Table save and load snapshot") {
+    FILE* file = tmpfile();
+    if (!file)
+        return;
+    CZ_DEFER(fclose(file));
+
+    {
+        Page_Table<uint64_t> page_table = {};
+        CZ_DEFER(page_table.drop(bench::allocator()));
+        fill(&page_table, page_table_size);
+
+        context->start();
+        bool saved = page_table.save(fileno(file));
+        context->stop(page_table_size);
+        if (!saved)
+            return;
+    }
+
+    Page_Table<uint64_t> page_table = {};
+    CZ_DEFER(page_table.drop(bench::allocator()));
+
+    context->start();
+    page_table.load(bench::allocator(), fileno(file));
+    context->stop(page_table_size);
+}
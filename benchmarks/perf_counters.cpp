@@ -0,0 +1,174 @@
+#include "benchmark.hpp"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bench {
+
+Perf_Counters perf;
+bool perf_enabled;
+
+const char* const Perf_Counters::names[NUM_COUNTERS] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses", "dtlb_misses",
+};
+
+#ifdef __linux__
+
+static uint64_t cache_config(uint64_t cache, uint64_t op, uint64_t result) {
+    return cache | (op << 8) | (result << 16);
+}
+
+static int open_counter(uint32_t type, uint64_t config, int group) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    // Members follow the leader so only it starts disabled.
+    attr.disabled = group < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format =
+        PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+bool Perf_Counters::open() {
+    struct Config {
+        uint32_t type;
+        uint64_t config;
+    };
+    const Config configs[NUM_COUNTERS] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, cache_config(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                                          PERF_COUNT_HW_CACHE_RESULT_MISS)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, cache_config(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                                          PERF_COUNT_HW_CACHE_RESULT_MISS)},
+    };
+
+    // The first counter that opens leads the group.  Counters that can't
+    // be opened or can't be scheduled alongside the group are skipped.
+    leader = -1;
+    group_size = 0;
+    measured = false;
+    base_valid = false;
+    for (size_t i = 0; i < NUM_COUNTERS; ++i) {
+        fds[i] = open_counter(configs[i].type, configs[i].config, leader);
+        if (fds[i] < 0)
+            continue;
+        if (leader < 0)
+            leader = fds[i];
+        positions[i] = group_size++;
+    }
+    return leader >= 0;
+}
+
+void Perf_Counters::close() {
+    // Close the members before the leader.
+    for (size_t i = NUM_COUNTERS; i-- > 0;) {
+        if (fds[i] >= 0)
+            ::close(fds[i]);
+        fds[i] = -1;
+    }
+    leader = -1;
+}
+
+/// Read the raw counts and the group's times.  Returns `false` on failure.
+static bool read_group(const Perf_Counters* perf,
+                       uint64_t raw[Perf_Counters::NUM_COUNTERS],
+                       uint64_t* time_enabled,
+                       uint64_t* time_running) {
+    if (perf->leader < 0)
+        return false;
+
+    // Number of counters, time enabled, time running, then the values.
+    uint64_t buffer[3 + Perf_Counters::NUM_COUNTERS];
+    ssize_t size = (ssize_t)((3 + perf->group_size) * sizeof(uint64_t));
+    if (::read(perf->leader, buffer, size) != size || buffer[0] != perf->group_size)
+        return false;
+
+    *time_enabled = buffer[1];
+    *time_running = buffer[2];
+    for (size_t i = 0; i < Perf_Counters::NUM_COUNTERS; ++i) {
+        raw[i] = perf->fds[i] >= 0 ? buffer[3 + perf->positions[i]] : 0;
+    }
+    return true;
+}
+
+void Perf_Counters::reset() {
+    // Resetting only zeroes the counts and not the times so keep
+    // a baseline of everything and subtract it in `read`.
+    base_valid = read_group(this, base_values, &base_time_enabled, &base_time_running);
+    memset(values, 0, sizeof(values));
+    measured = false;
+}
+
+void Perf_Counters::resume() {
+    if (leader >= 0)
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void Perf_Counters::pause() {
+    if (leader >= 0)
+        ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void Perf_Counters::read() {
+    memset(values, 0, sizeof(values));
+    measured = false;
+
+    uint64_t raw[NUM_COUNTERS];
+    uint64_t time_enabled;
+    uint64_t time_running;
+    if (!base_valid || !read_group(this, raw, &time_enabled, &time_running))
+        return;
+
+    // If the group never ran there is nothing to scale.  Report
+    // the counters as unavailable rather than as zero.
+    uint64_t enabled = time_enabled - base_time_enabled;
+    uint64_t running = time_running - base_time_running;
+    if (running == 0)
+        return;
+    measured = true;
+
+    for (size_t i = 0; i < NUM_COUNTERS; ++i) {
+        if (fds[i] >= 0)
+            values[i] = (uint64_t)((double)(raw[i] - base_values[i]) * enabled / running);
+    }
+}
+
+#else
+
+bool Perf_Counters::open() {
+    for (size_t i = 0; i < NUM_COUNTERS; ++i) {
+        fds[i] = -1;
+    }
+    leader = -1;
+    measured = false;
+    return false;
+}
+
+void Perf_Counters::close() {}
+
+void Perf_Counters::reset() {
+    for (size_t i = 0; i < NUM_COUNTERS; ++i) {
+        values[i] = 0;
+    }
+    measured = false;
+}
+
+void Perf_Counters::resume() {}
+void Perf_Counters::pause() {}
+void Perf_Counters::read() {}
+
+#endif
+
+}
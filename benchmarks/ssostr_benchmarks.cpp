@@ -0,0 +1,154 @@
+#include "benchmark.hpp"
+
+#include <stdio.h>
+#include <cz/defer.hpp>
+#include <cz/heap.hpp>
+#include "ssostr.hpp"
+#include "string_pool.hpp"
+
+static const size_t num_strings = 1 << 12;
+static const uint64_t num_operations = 1 << 22;
+
+/// Identifier like keys that share a prefix so comparisons look past the first few bytes.
+static void make_strings(cz::Vector<ds::SSOStr>* strings, size_t min_len, size_t max_len) {
+    bench::Random random = {1};
+    strings->reserve(cz::heap_allocator(), num_strings);
+    for (size_t i = 0; i < num_strings; ++i) {
+        char buffer[128];
+        size_t len = min_len + random.below(max_len - min_len + 1);
+        memset(buffer, 'k', len);
+        // Vary the tail so most of the string is a shared prefix.
+        size_t tail = len < 4 ? len : 4;
+        for (size_t j = len - tail; j < len; ++j) {
+            buffer[j] = (char)('a' + random.below(4));
+        }
+        strings->push(ds::SSOStr::as_duplicate(cz::heap_allocator(), {buffer, len}));
+    }
+}
+
+static void drop_strings(cz::Vector<ds::SSOStr>* strings) {
+    for (size_t i = 0; i < strings->len; ++i) {
+        (*strings)[i].drop(cz::heap_allocator());
+    }
+    strings->drop(cz::heap_allocator());
+}
+
+/// Compare through `as_str()` with a plain byte loop like callers did before.
+static int64_t compare_bytes(cz::Str left, cz::Str right) {
+    size_t len = left.len < right.len ? left.len : right.len;
+    for (size_t i = 0; i < len; ++i) {
+        if (left.buffer[i] != right.buffer[i])
+            return (unsigned char)left.buffer[i] - (unsigned char)right.buffer[i];
+    }
+    return (int64_t)left.len - (int64_t)right.len;
+}
+
+enum Kernel {
+    COMPARE_BYTES,
+    COMPARE,
+    EQUAL,
+    HASH,
+};
+
+static void run(bench::Context* context, Kernel kernel, size_t min_len, size_t max_len) {
+    cz::Vector<ds::SSOStr> strings = {};
+    CZ_DEFER(drop_strings(&strings));
+    make_strings(&strings, min_len, max_len);
+
+    bench::Random random = {2};
+    uint64_t result = 0;
+    context->start();
+    for (uint64_t i = 0; i < num_operations; ++i) {
+        const ds::SSOStr& left = strings[random.below(num_strings)];
+        const ds::SSOStr& right = strings[random.below(num_strings)];
+        switch (kernel) {
+        case COMPARE_BYTES:
+            result += compare_bytes(left.as_str(), right.as_str()) < 0;
+            break;
+        case COMPARE:
+            result += compare(left, right) < 0;
+            break;
+        case EQUAL:
+            result += left == right;
+            break;
+        case HASH:
+            result += left.hash();
+            break;
+        }
+    }
+    context->stop(num_operations);
+    bench::keep(result);
+}
+
+BENCHMARK("SSOStr short (4-15) compare bytes") {
+    run(context, COMPARE_BYTES, 4, 15);
+}
+BENCHMARK("SSOStr short (4-15) compare") {
+    run(context, COMPARE, 4, 15);
+}
+BENCHMARK("SSOStr short (4-15) ==") {
+    run(context, EQUAL, 4, 15);
+}
+BENCHMARK("SSOStr short (4-15) hash") {
+    run(context, HASH, 4, 15);
+}
+
+BENCHMARK("SSOStr mixed (4-40) compare bytes") {
+    run(context, COMPARE_BYTES, 4, 40);
+}
+BENCHMARK("SSOStr mixed (4-40) compare") {
+    run(context, COMPARE, 4, 40);
+}
+BENCHMARK("SSOStr mixed (4-40) ==") {
+    run(context, EQUAL, 4, 40);
+}
+BENCHMARK("SSOStr mixed (4-40) hash") {
+    run(context, HASH, 4, 40);
+}
+
+BENCHMARK("SSOStr long (32-96) compare bytes") {
+    run(context, COMPARE_BYTES, 32, 96);
+}
+BENCHMARK("SSOStr long (32-96) compare") {
+    run(context, COMPARE, 32, 96);
+}
+BENCHMARK("SSOStr long (32-96) ==") {
+    run(context, EQUAL, 32, 96);
+}
+BENCHMARK("SSOStr long (32-96) hash") {
+    run(context, HASH, 32, 96);
+}
+
+/// Copy `num_operations` identifiers drawn from a small vocabulary, like parsing repetitive input.
+static void copy_identifiers(bench::Context* context, bool intern) {
+    ds::String_Pool pool = {};
+    CZ_DEFER(pool.drop(cz::heap_allocator()));
+    cz::Vector<ds::SSOStr> copies = {};
+    CZ_DEFER(drop_strings(&copies));
+    copies.reserve(cz::heap_allocator(), num_operations);
+
+    bench::Random random = {1};
+    context->start();
+    for (uint64_t i = 0; i < num_operations; ++i) {
+        char buffer[64];
+        int len = snprintf(buffer, sizeof(buffer), "some_namespace::identifier_%d",
+                           (int)random.below(1000));
+        cz::Str str = {buffer, (size_t)len};
+        if (intern)
+            copies.push(pool.intern(cz::heap_allocator(), str));
+        else
+            copies.push(ds::SSOStr::as_duplicate(cz::heap_allocator(), str));
+    }
+    context->stop(num_operations);
+
+    // Pooled strings are freed by the pool.
+    if (intern)
+        copies.len = 0;
+}
+
+BENCHMARK("SSOStr as_duplicate repeated identifiers") {
+    copy_identifiers(context, false);
+}
+BENCHMARK("String_Pool intern repeated identifiers") {
+    copy_identifiers(context, true);
+}
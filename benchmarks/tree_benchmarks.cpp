@@ -0,0 +1,210 @@
+#include "benchmark.hpp"
+
+#include <cz/defer.hpp>
+#include "avl_tree.hpp"
+#include "compact_splay_tree.hpp"
+#include "rb_tree.hpp"
+#include "splay_linked_tree.hpp"
+#include "splay_tree.hpp"
+
+static const uint64_t tree_size = 1 << 18;
+
+/// Insert `tree_size` random keys, timing each insertion.
+template <class Tree>
+static void insert_random(bench::Context* context) {
+    Tree tree = {};
+    CZ_DEFER(tree.drop(bench::allocator()));
+
+    bench::Random random = {1};
+    for (uint64_t i = 0; i < tree_size; ++i) {
+        uint64_t key = random.next();
+        context->sample([&]() { tree.insert(bench::allocator(), key); });
+    }
+}
+
+/// Fill with `tree_size` random keys then time looking each one up in a different order.
+template <class Tree>
+static void find_random(bench::Context* context) {
+    Tree tree = {};
+    CZ_DEFER(tree.drop(bench::allocator()));
+
+    bench::Random random = {1};
+    for (uint64_t i = 0; i < tree_size; ++i) {
+        tree.insert(bench::allocator(), random.next());
+    }
+
+    // Restart the sequence and skip around it.
+    random = {1};
+    uint64_t found = 0;
+    for (uint64_t i = 0; i < tree_size; ++i) {
+        uint64_t key = random.next();
+        context->sample([&]() { found += tree.contains(key); });
+    }
+    bench::keep(found);
+}
+
+/// Fill with keys in increasing order then time the lookups.
+template <class Tree>
+static void find_sequential(bench::Context* context) {
+    Tree tree = {};
+    CZ_DEFER(tree.drop(bench::allocator()));
+
+    for (uint64_t i = 0; i < tree_size; ++i) {
+        tree.insert(bench::allocator(), i);
+    }
+
+    uint64_t found = 0;
+    for (uint64_t i = 0; i < tree_size; ++i) {
+        context->sample([&]() { found += tree.contains(i); });
+    }
+    bench::keep(found);
+}
+
+BENCHMARK("splay::Tree insert random") {
+    insert_random<ds::splay::Tree<uint64_t> >(context);
+}
+BENCHMARK("splay::Compact_Tree insert random") {
+    insert_random<ds::splay::Compact_Tree<uint64_t> >(context);
+}
+BENCHMARK("rb::Tree insert random") {
+    insert_random<ds::rb::Tree<uint64_t> >(context);
+}
+BENCHMARK("avl::Tree insert random") {
+    insert_random<ds::avl::Tree<uint64_t> >(context);
+}
+
+BENCHMARK("splay::Tree find random") {
+    find_random<ds::splay::Tree<uint64_t> >(context);
+}
+BENCHMARK("splay::Compact_Tree find random") {
+    find_random<ds::splay::Compact_Tree<uint64_t> >(context);
+}
+BENCHMARK("rb::Tree find random") {
+    find_random<ds::rb::Tree<uint64_t> >(context);
+}
+BENCHMARK("avl::Tree find random") {
+    find_random<ds::avl::Tree<uint64_t> >(context);
+}
+
+BENCHMARK("splay::Tree find sequential") {
+    find_sequential<ds::splay::Tree<uint64_t> >(context);
+}
+BENCHMARK("rb::Tree find sequential") {
+    find_sequential<ds::rb::Tree<uint64_t> >(context);
+}
+BENCHMARK("avl::Tree find sequential") {
+    find_sequential<ds::avl::Tree<uint64_t> >(context);
+}
+
+BENCHMARK("splay::Tree build_from_sorted then find random") {
+    cz::Vector<uint64_t> keys = {};
+    CZ_DEFER(keys.drop(bench::allocator()));
+    keys.reserve_exact(bench::allocator(), tree_size);
+    for (uint64_t i = 0; i < tree_size; ++i) {
+        keys.push(i);
+    }
+
+    ds::splay::Tree<uint64_t> tree = {};
+    CZ_DEFER(tree.drop(bench::allocator()));
+    tree.build_from_sorted(bench::allocator(), {keys.elems, keys.len});
+
+    bench::Random random = {1};
+    uint64_t found = 0;
+    for (uint64_t i = 0; i < tree_size; ++i) {
+        uint64_t key = random.below(tree_size);
+        context->sample([&]() { found += tree.contains(key); });
+    }
+    bench::keep(found);
+}
+
+/// Fill with random keys then time iterating through the whole tree.
+template <class Tree>
+static void scan(bench::Context* context) {
+    Tree tree = {};
+    CZ_DEFER(tree.drop(bench::allocator()));
+
+    bench::Random random = {1};
+    for (uint64_t i = 0; i < tree_size; ++i) {
+        tree.insert(bench::allocator(), random.next());
+    }
+
+    uint64_t sum = 0;
+    context->start();
+    for (auto it = tree.start(); it != tree.end(); ++it) {
+        sum += *it;
+    }
+    context->stop(tree.count());
+    bench::keep(sum);
+}
+
+BENCHMARK("splay::Tree scan") {
+    scan<ds::splay::Tree<uint64_t> >(context);
+}
+BENCHMARK("splay::Linked_Tree scan") {
+    scan<ds::splay::Linked_Tree<uint64_t> >(context);
+}
+
+/// Walk a tree of random keys with `cursors` interleaved paginating cursors using `find_greater`.
+static void cursor_walk(bench::Context* context,
+                        size_t cursors,
+                        bool from_finger,
+                        size_t splay_depth) {
+    ds::splay::Tree<uint64_t> tree = {};
+    CZ_DEFER(tree.drop(bench::allocator()));
+    tree.splay_depth = splay_depth;
+
+    bench::Random random = {1};
+    for (uint64_t i = 0; i < tree_size; ++i) {
+        tree.insert(bench::allocator(), random.next());
+    }
+
+    // Start each cursor at an evenly spaced key.
+    ds::gen::Iterator<uint64_t> fingers[4];
+    uint64_t ends[4];
+    CZ_ASSERT(cursors <= 4);
+    for (size_t c = 0; c < cursors; ++c) {
+        fingers[c] = tree.find_greater_equal(UINT64_MAX / cursors * c);
+        ends[c] = c + 1 == cursors ? UINT64_MAX : UINT64_MAX / cursors * (c + 1);
+    }
+
+    uint64_t sum = 0;
+    uint64_t steps = 0;
+    context->start();
+    for (size_t done = 0; done < cursors;) {
+        done = 0;
+        for (size_t c = 0; c < cursors; ++c) {
+            if (fingers[c] == tree.end() || *fingers[c] >= ends[c]) {
+                ++done;
+                continue;
+            }
+            uint64_t key = *fingers[c];
+            sum += key;
+            ++steps;
+            if (from_finger)
+                fingers[c] = tree.find_greater_from(fingers[c], key);
+            else
+                fingers[c] = tree.find_greater(key);
+        }
+    }
+    context->stop(steps);
+    bench::keep(sum);
+}
+
+BENCHMARK("splay::Tree 1 cursor find_greater") {
+    cursor_walk(context, 1, false, 0);
+}
+BENCHMARK("splay::Tree 1 cursor find_greater_from") {
+    cursor_walk(context, 1, true, 0);
+}
+BENCHMARK("splay::Tree 4 cursors find_greater") {
+    cursor_walk(context, 4, false, 0);
+}
+BENCHMARK("splay::Tree 4 cursors find_greater_from") {
+    cursor_walk(context, 4, true, 0);
+}
+BENCHMARK("splay::Tree 4 cursors find_greater splay_depth 8") {
+    cursor_walk(context, 4, false, 8);
+}
+BENCHMARK("splay::Tree 4 cursors find_greater_from splay_depth 8") {
+    cursor_walk(context, 4, true, 8);
+}
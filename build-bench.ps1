@@ -0,0 +1,11 @@
+Push-Location $(Split-Path -Parent -Path $MyInvocation.MyCommand.Definition)
+
+try {
+    ./run-build.ps1 build/bench Release -DDATA_STRUCTURES_BUILD_BENCHMARKS=1
+    if (!$?) { exit 1 }
+
+    ./build/bench/*-bench.exe $args
+    if (!$?) { exit 1 }
+} finally {
+    Pop-Location
+}
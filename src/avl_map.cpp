@@ -0,0 +1,62 @@
+#ifndef DS_AVL_MAP_CPP
+#define DS_AVL_MAP_CPP
+
+#include "avl_map.hpp"
+
+namespace ds {
+namespace avl {
+
+template <class Key, class Value>
+Iterator<Pair<Key, Value> > Map<Key, Value>::find_equal(const Key& key) {
+    return detail::find_equal_comparator(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<Pair<Key, Value> > Map<Key, Value>::find_less(const Key& key) {
+    return detail::find_less_comparator(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<Pair<Key, Value> > Map<Key, Value>::find_greater(const Key& key) {
+    return detail::find_greater_comparator(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<Pair<Key, Value> > Map<Key, Value>::find_less_equal(const Key& key) {
+    return detail::find_less_equal_comparator(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<Pair<Key, Value> > Map<Key, Value>::find_greater_equal(const Key& key) {
+    return detail::find_greater_equal_comparator(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<const Pair<Key, Value> > Map<Key, Value>::find_equal(const Key& key) const {
+    return detail::find_equal_comparator(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<const Pair<Key, Value> > Map<Key, Value>::find_less(const Key& key) const {
+    return detail::find_less_comparator(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<const Pair<Key, Value> > Map<Key, Value>::find_greater(const Key& key) const {
+    return detail::find_greater_comparator(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<const Pair<Key, Value> > Map<Key, Value>::find_less_equal(const Key& key) const {
+    return detail::find_less_equal_comparator(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<const Pair<Key, Value> > Map<Key, Value>::find_greater_equal(const Key& key) const {
+    return detail::find_greater_equal_comparator(&tree, gen::key_comparator(key));
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,291 @@
+#ifndef DS_AVL_TREE_CPP
+#define DS_AVL_TREE_CPP
+
+#include "avl_tree.hpp"
+#include "profile.hpp"
+
+#include <Tracy.hpp>
+#include <cz/compare.hpp>
+
+namespace ds {
+namespace avl {
+
+template <class T>
+void Tree<T>::drop(cz::Allocator allocator) {
+    gen::recursive_dealloc(allocator, root, profile::avl_nodes);
+}
+
+namespace detail {
+
+template <class T>
+uint8_t height(gen::Node_Base* node) {
+    return node ? ((Node<T>*)node)->height : 0;
+}
+
+template <class T>
+void update_height(gen::Node_Base* node) {
+    uint8_t left = height<T>(node->left);
+    uint8_t right = height<T>(node->right);
+    ((Node<T>*)node)->height = (left > right ? left : right) + 1;
+}
+
+/// Rebalance the subtree at `node` assuming its children are balanced
+/// and differ in height by at most two.  Returns the new subtree root.
+template <class T>
+gen::Node_Base* rebalance(gen::Node_Base* node) {
+    int left = height<T>(node->left);
+    int right = height<T>(node->right);
+
+    if (right > left + 1) {
+        gen::Node_Base* child = node->right;
+        if (height<T>(child->left) > height<T>(child->right)) {
+            // Right-left case.
+            gen::rotate_right(child);
+            update_height<T>(child);
+            update_height<T>(child->parent);
+        }
+        gen::rotate_left(node);
+    } else if (left > right + 1) {
+        gen::Node_Base* child = node->left;
+        if (height<T>(child->right) > height<T>(child->left)) {
+            // Left-right case.
+            gen::rotate_left(child);
+            update_height<T>(child);
+            update_height<T>(child->parent);
+        }
+        gen::rotate_right(node);
+    } else {
+        update_height<T>(node);
+        return node;
+    }
+
+    update_height<T>(node);
+    update_height<T>(node->parent);
+    return node->parent;
+}
+
+/// Rebalance every node from `node` up to the root.  Stops early once
+/// a subtree's height is unchanged since its ancestors are then unaffected.
+template <class T>
+void rebalance_up(Tree<T>* tree, gen::Node_Base* node) {
+    while (node) {
+        uint8_t old_height = height<T>(node);
+        node = rebalance<T>(node);
+        if (!node->parent)
+            tree->root = (Node<T>*)node;
+        if (height<T>(node) == old_height)
+            break;
+        node = node->parent;
+    }
+}
+
+/// Replace the subtree at `node` with the subtree at `replacement`.
+template <class T>
+void transplant(Tree<T>* tree, gen::Node_Base* node, gen::Node_Base* replacement) {
+    if (!node->parent) {
+        tree->root = (Node<T>*)replacement;
+    } else if (node->parent->left == node) {
+        node->parent->left = replacement;
+    } else {
+        node->parent->right = replacement;
+    }
+    if (replacement)
+        replacement->parent = node->parent;
+}
+
+template <class T, class Comparator>
+bool insert_comparator(Tree<T>* tree,
+                       cz::Allocator allocator,
+                       const T& element,
+                       Comparator&& comparator) {
+    ZoneScoped;
+
+    int64_t last_comparison;
+    Node<T>* parent = (Node<T>*)gen::find_comparator<T>(tree->root, &last_comparison, comparator);
+
+    // Already present.
+    if (parent && last_comparison == 0) {
+        return false;
+    }
+
+    Node<T>* node = allocator.alloc<Node<T> >();
+    CZ_ASSERT(node);
+    TracyAllocN(node, sizeof(Node<T>), profile::avl_nodes);
+    node->parent = parent;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->element = element;
+    node->height = 1;
+
+    if (!parent) {
+        tree->root = node;
+    } else if (last_comparison < 0) {
+        parent->left = node;
+    } else {
+        parent->right = node;
+    }
+
+    rebalance_up(tree, parent);
+    ++tree->num_elements;
+    TracyPlot(profile::avl_count, (int64_t)tree->num_elements);
+    TracyPlot(profile::avl_height, (int64_t)((Node<T>*)tree->root)->height);
+    return true;
+}
+
+}
+
+template <class T>
+bool Tree<T>::insert(cz::Allocator allocator, const T& element) {
+    return detail::insert_comparator(this, allocator, element, gen::element_comparator(element));
+}
+
+template <class T>
+void Tree<T>::remove(cz::Allocator allocator, Iterator<const T> iterator) {
+    ZoneScoped;
+    if (iterator == end())
+        return;
+
+    Node<T>* node = (Node<T>*)iterator.node;
+
+    // The lowest node whose subtree changed height.
+    gen::Node_Base* changed;
+
+    if (!node->left) {
+        changed = node->parent;
+        detail::transplant(this, node, node->right);
+    } else if (!node->right) {
+        changed = node->parent;
+        detail::transplant(this, node, node->left);
+    } else {
+        // Replace the node with its successor.
+        gen::Node_Base* successor = gen::leftmost(node->right);
+
+        if (successor->parent == node) {
+            changed = successor;
+        } else {
+            changed = successor->parent;
+            detail::transplant(this, successor, successor->right);
+            successor->right = node->right;
+            successor->right->parent = successor;
+        }
+
+        detail::transplant(this, node, successor);
+        successor->left = node->left;
+        successor->left->parent = successor;
+        ((Node<T>*)successor)->height = node->height;
+    }
+
+    detail::rebalance_up(this, changed);
+
+    TracyFreeN(node, profile::avl_nodes);
+    allocator.dealloc(node);
+    --num_elements;
+    TracyPlot(profile::avl_count, (int64_t)num_elements);
+    TracyPlot(profile::avl_height, root ? (int64_t)((Node<T>*)root)->height : 0);
+}
+
+template <class T>
+Iterator<T> Tree<T>::start() {
+    return Iterator<T>{(gen::Node<T>*)gen::leftmost(root)};
+}
+template <class T>
+Iterator<const T> Tree<T>::start() const {
+    return Iterator<T>{(gen::Node<T>*)gen::leftmost(root)};
+}
+
+template <class T>
+Iterator<T> Tree<T>::end() {
+    return Iterator<T>{nullptr};
+}
+template <class T>
+Iterator<const T> Tree<T>::end() const {
+    return Iterator<const T>{nullptr};
+}
+
+template <class T>
+Iterator<T> Tree<T>::find_equal(const T& element) {
+    return detail::find_equal_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<T> Tree<T>::find_less(const T& element) {
+    return detail::find_less_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<T> Tree<T>::find_greater(const T& element) {
+    return detail::find_greater_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<T> Tree<T>::find_less_equal(const T& element) {
+    return detail::find_less_equal_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<T> Tree<T>::find_greater_equal(const T& element) {
+    return detail::find_greater_equal_comparator(this, gen::element_comparator(element));
+}
+
+template <class T>
+Iterator<const T> Tree<T>::find_equal(const T& element) const {
+    return detail::find_equal_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<const T> Tree<T>::find_less(const T& element) const {
+    return detail::find_less_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<const T> Tree<T>::find_greater(const T& element) const {
+    return detail::find_greater_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<const T> Tree<T>::find_less_equal(const T& element) const {
+    return detail::find_less_equal_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<const T> Tree<T>::find_greater_equal(const T& element) const {
+    return detail::find_greater_equal_comparator(this, gen::element_comparator(element));
+}
+
+namespace detail {
+
+template <class T, class Comparator>
+static Iterator<T> find_gen(const Tree<T>* tree, int64_t* last_comparison, Comparator&& comparator) {
+    gen::Node<T>* node = gen::find_comparator<T>(tree->root, last_comparison, comparator);
+    return Iterator<T>{node};
+}
+
+template <class T, class Comparator>
+Iterator<T> find_equal_comparator(const Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_equal(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<T> find_less_comparator(const Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_less(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<T> find_greater_comparator(const Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_greater(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<T> find_less_equal_comparator(const Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_less_equal(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<T> find_greater_equal_comparator(const Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_greater_equal(iterator, last_comparison, comparator);
+}
+
+}
+
+}
+}
+
+#endif
@@ -2,7 +2,9 @@
 #define DS_BTREE_BTREE_CPP
 
 #include "btree.hpp"
+#include "profile.hpp"
 
+#include <Tracy.hpp>
 #include <cz/compare.hpp>
 
 namespace ds {
@@ -20,6 +22,7 @@ void drop_node(cz::Allocator allocator, Node<T, Maximum_Elements>* node) {
     }
     drop_node(allocator, node->children[node->num_elements]);
 
+    TracyFreeN(node, profile::btree_nodes);
     allocator.dealloc(node);
 }
 
@@ -47,6 +50,16 @@ bool binary_search(cz::Slice<const T> slice,
     return start < slice.len && comparator(element, slice[start]) == 0;
 }
 
+/// Compares two elements.  Unlike passing `cz::compare<T>` this
+/// isn't a function pointer so the comparisons can be inlined.
+template <class T>
+struct Compare_Elements {
+    int64_t operator()(const T& left, const T& right) const {
+        using cz::compare;
+        return compare(left, right);
+    }
+};
+
 template <class T, class Comparator>
 bool binary_search(cz::Slice<const T> slice, Comparator&& comparator, size_t* index) {
     size_t start = 0;
@@ -65,13 +78,47 @@ bool binary_search(cz::Slice<const T> slice, Comparator&& comparator, size_t* in
     }
 
     *index = start;
-    return comparator(slice[start]) == 0;
+    return start < slice.len && comparator(slice[start]) == 0;
+}
+
+}
+
+namespace detail {
+template <class T, size_t Maximum_Elements>
+void measure_node(const Node<T, Maximum_Elements>* node, size_t level, Stats* stats) {
+    ++stats->nodes;
+    stats->elements += node->num_elements;
+    if (level + 1 > stats->height)
+        stats->height = level + 1;
+    ++stats->nodes_per_level[level < Stats::LEVELS ? level : Stats::LEVELS - 1];
+
+    size_t bucket = node->num_elements * Stats::FILL_BUCKETS / Maximum_Elements;
+    ++stats->fill_histogram[bucket < Stats::FILL_BUCKETS ? bucket : Stats::FILL_BUCKETS - 1];
+
+    if (!node->children[0]) {
+        ++stats->leaves;
+        return;
+    }
+    for (size_t i = 0; i < node->num_elements + 1; ++i) {
+        measure_node(node->children[i], level + 1, stats);
+    }
+}
 }
 
+template <class T, size_t Maximum_Elements>
+Stats Tree_Base<T, Maximum_Elements>::stats() const {
+    Stats stats = {};
+    stats.maximum_elements = Maximum_Elements;
+    if (root)
+        detail::measure_node(root, 0, &stats);
+    stats.bytes_allocated = stats.nodes * sizeof(Node);
+    stats.bytes_payload = stats.elements * sizeof(T);
+    return stats;
 }
 
 template <class T, size_t Maximum_Elements>
 void Tree_Base<T, Maximum_Elements>::drop(cz::Allocator allocator) {
+    ZoneScoped;
     detail::drop_node(allocator, root);
 }
 
@@ -104,7 +151,10 @@ void split_node_insert(Node<T, Maximum_Elements>* left,
                        const T& element,
                        Node<T, Maximum_Elements>* element_child,
                        size_t element_index,
-                       const T** middle) {
+                       const T** middle,
+                       Node<T, Maximum_Elements>** element_node,
+                       size_t* element_position) {
+    ZoneScoped;
     CZ_DEBUG_ASSERT(left->num_elements == Maximum_Elements);
 
     size_t split = Maximum_Elements / 2 + 1;
@@ -118,6 +168,8 @@ void split_node_insert(Node<T, Maximum_Elements>* left,
 
         right->elements[i - split] = element;
         right->children[i - split + 1] = element_child;
+        *element_node = right;
+        *element_position = i - split;
 
         for (; i < Maximum_Elements; ++i) {
             right->elements[i - split + 1] = left->elements[i];
@@ -137,10 +189,16 @@ void split_node_insert(Node<T, Maximum_Elements>* left,
         left->num_elements = split;
         insert_inplace(left, element, element_child, element_index);
         right->num_elements = Maximum_Elements - split;
+        *element_node = left;
+        *element_position = element_index;
     }
 
     --left->num_elements;
     *middle = &left->elements[left->num_elements];
+    if (*element_node == left && *element_position == left->num_elements) {
+        // The element is the middle so it is moving up a level.
+        *element_node = nullptr;
+    }
     right->children[0] = left->children[left->num_elements + 1];
     CZ_DEBUG_ASSERT(left->num_elements + right->num_elements == Maximum_Elements);
 
@@ -155,25 +213,54 @@ void split_node_insert(Node<T, Maximum_Elements>* left,
 }
 
 namespace detail {
+/// Recalculate `subtree_count` from the node's children.
+template <class T, size_t Maximum_Elements>
+void recount(Node<T, Maximum_Elements>* node) {
+    node->subtree_count = node->num_elements;
+    if (!node->children[0])
+        return;
+    for (size_t i = 0; i < node->num_elements + 1; ++i) {
+        node->subtree_count += node->children[i]->subtree_count;
+    }
+}
+
+/// The number of levels in the tree.  Used for profiling.
+template <class T, size_t Maximum_Elements>
+size_t height(const Tree_Base<T, Maximum_Elements>* tree) {
+    size_t levels = 0;
+    for (Node<T, Maximum_Elements>* node = tree->root; node; node = node->children[0])
+        ++levels;
+    return levels;
+}
+
+/// Insert the element.  If `duplicates` is true then it is inserted after any
+/// equal elements.  Otherwise equal elements cause the insert to fail.
 template <class T, size_t Maximum_Elements, class Comparator>
-bool insert(Tree_Base<T, Maximum_Elements>* tree,
-            cz::Allocator allocator,
-            const T& element,
-            Comparator&& comparator) {
+Insert_Result<T, Maximum_Elements> insert(Tree_Base<T, Maximum_Elements>* tree,
+                                          cz::Allocator allocator,
+                                          const T& element,
+                                          Comparator&& comparator,
+                                          bool duplicates) {
+    ZoneScoped;
+
     using Node = Node<T, Maximum_Elements>;
 
     if (!tree->root) {
         Node* node = allocator.alloc<Node>();
         CZ_ASSERT(node);
+        TracyAllocN(node, sizeof(Node), profile::btree_nodes);
         node->parent = nullptr;
         node->parent_index = 0;
         node->num_elements = 1;
+        node->subtree_count = 1;
         node->children[0] = nullptr;
         node->children[1] = nullptr;
         node->elements[0] = element;
         tree->root = node;
         ++tree->count;
-        return true;
+        TracyPlot(profile::btree_count, (int64_t)tree->count);
+        TracyPlot(profile::btree_height, (int64_t)1);
+        return {{node, 0}, true};
     }
 
     Node* node = tree->root;
@@ -183,7 +270,10 @@ bool insert(Tree_Base<T, Maximum_Elements>* tree,
     while (1) {
         if (detail::binary_search({node->elements, node->num_elements}, element, &index,
                                   comparator)) {
-            return false;
+            if (!duplicates)
+                return {{node, index}, false};
+            // `index` is the last equal element so go after it.
+            ++index;
         }
 
         if (!node->children[index]) {
@@ -193,25 +283,43 @@ bool insert(Tree_Base<T, Maximum_Elements>* tree,
         node = node->children[index];
     }
 
-    // Split then insert, stepping up one level each time.
+    // Every node on the path gains an element no matter how the nodes are split.
+    for (Node* parent = node; parent; parent = parent->parent) {
+        ++parent->subtree_count;
+    }
+
+    // Split then insert, stepping up one level each time.  `result.iterator.node`
+    // is null while the element is the one being inserted at the current level.
+    Insert_Result<T, Maximum_Elements> result = {{}, true};
     const T* pelement = &element;
     Node* child = nullptr;
     while (1) {
         // Simply insert into this node.
         if (node->num_elements < Maximum_Elements) {
             detail::insert_inplace(node, *pelement, child, index);
+            if (!result.iterator.node)
+                result.iterator = {node, index};
             ++tree->count;
-            return true;
+            TracyPlot(profile::btree_count, (int64_t)tree->count);
+            return result;
         }
 
         // Split node into two.  `node` becomes the left side.
         Node* right = allocator.alloc<Node>();
         CZ_ASSERT(right);
+        TracyAllocN(right, sizeof(Node), profile::btree_nodes);
         right->parent = nullptr;
         right->parent_index = 0;
         right->num_elements = 0;
 
-        detail::split_node_insert(node, right, *pelement, child, index, &pelement);
+        Node* element_node;
+        size_t element_position;
+        detail::split_node_insert(node, right, *pelement, child, index, &pelement, &element_node,
+                                  &element_position);
+        if (!result.iterator.node && element_node)
+            result.iterator = {element_node, element_position};
+        detail::recount(node);
+        detail::recount(right);
 
         child = right;
 
@@ -219,20 +327,26 @@ bool insert(Tree_Base<T, Maximum_Elements>* tree,
             // Make new root node.
             Node* new_root = allocator.alloc<Node>();
             CZ_ASSERT(new_root);
+            TracyAllocN(new_root, sizeof(Node), profile::btree_nodes);
             new_root->parent = nullptr;
             new_root->parent_index = 0;
             new_root->num_elements = 1;
+            new_root->subtree_count = node->subtree_count + right->subtree_count + 1;
             new_root->children[0] = node;
             new_root->children[1] = right;
             new_root->elements[0] = *pelement;
             tree->root = new_root;
+            if (!result.iterator.node)
+                result.iterator = {new_root, 0};
 
             node->parent = new_root;
             node->parent_index = 0;
             right->parent = new_root;
             right->parent_index = 1;
             ++tree->count;
-            return true;
+            TracyPlot(profile::btree_count, (int64_t)tree->count);
+            TracyPlot(profile::btree_height, (int64_t)detail::height(tree));
+            return result;
         }
 
         // Recurse into parent.
@@ -246,7 +360,22 @@ bool insert(Tree_Base<T, Maximum_Elements>* tree,
 
 template <class T, size_t Maximum_Elements>
 bool Tree<T, Maximum_Elements>::insert(cz::Allocator allocator, const T& element) {
-    return detail::insert(this, allocator, element, cz::compare<T>);
+    return detail::insert(this, allocator, element, detail::Compare_Elements<T>{},
+                          /*duplicates=*/false)
+        .inserted;
+}
+
+template <class T, size_t Maximum_Elements>
+Insert_Result<T, Maximum_Elements> Tree<T, Maximum_Elements>::try_insert(
+    cz::Allocator allocator,
+    const T& element) {
+    return detail::insert(this, allocator, element, detail::Compare_Elements<T>{},
+                          /*duplicates=*/false);
+}
+
+template <class T, size_t Maximum_Elements>
+void Multi_Tree<T, Maximum_Elements>::insert(cz::Allocator allocator, const T& element) {
+    detail::insert(this, allocator, element, detail::Compare_Elements<T>{}, /*duplicates=*/true);
 }
 
 template <class T, size_t Maximum_Elements>
@@ -254,7 +383,16 @@ template <class Comparator>
 bool Tree_Comparator<T, Maximum_Elements>::insert(cz::Allocator allocator,
                                                   const T& element,
                                                   Comparator&& comparator) {
-    return detail::insert(this, allocator, element, comparator);
+    return detail::insert(this, allocator, element, comparator, /*duplicates=*/false).inserted;
+}
+
+template <class T, size_t Maximum_Elements>
+template <class Comparator>
+Insert_Result<T, Maximum_Elements> Tree_Comparator<T, Maximum_Elements>::try_insert(
+    cz::Allocator allocator,
+    const T& element,
+    Comparator&& comparator) {
+    return detail::insert(this, allocator, element, comparator, /*duplicates=*/false);
 }
 
 namespace detail {
@@ -301,6 +439,8 @@ template <class T, size_t Maximum_Elements, class Comparator>
 Iterator<T, Maximum_Elements> gen_find(const Tree_Base<T, Maximum_Elements>* tree,
                                        Comparator&& comparator,
                                        int64_t* last_comparison) {
+    ZoneScoped;
+
     Node<T, Maximum_Elements>* node = tree->root;
     if (!node) {
         *last_comparison = 0;
@@ -517,6 +657,551 @@ Iterator<const T, Maximum_Elements> Tree_Comparator<T, Maximum_Elements>::find_g
     return detail::find_ge(this, comparator);
 }
 
+
+namespace detail {
+/// Find the first element not before the comparator's target or
+/// the first element after it if `after_equal` is true.
+template <class T, size_t Maximum_Elements, class Comparator>
+Iterator<T, Maximum_Elements> bound(const Tree_Base<T, Maximum_Elements>* tree,
+                                    Comparator&& comparator,
+                                    bool after_equal) {
+    ZoneScoped;
+
+    Node<T, Maximum_Elements>* node = tree->root;
+    if (!node)
+        return detail::end(tree);
+
+    // Unlike `gen_find` this can't stop at an equal element because
+    // there may be more equal elements on either side of it.
+    size_t index;
+    while (1) {
+        size_t start = 0;
+        size_t end = node->num_elements;
+        while (start < end) {
+            size_t mid = (start + end) / 2;
+            int64_t comparison = comparator(node->elements[mid]);
+            if (comparison > 0 || (after_equal && comparison == 0)) {
+                start = mid + 1;
+            } else {
+                end = mid;
+            }
+        }
+        index = start;
+
+        if (!node->children[index]) {
+            break;
+        }
+
+        node = node->children[index];
+    }
+
+    // Past the end of a node the next element is in an ancestor.
+    while (index == node->num_elements && node->parent) {
+        index = node->parent_index;
+        node = node->parent;
+    }
+    return {node, index};
+}
+
+/// Count the elements in the half slots `[start, end)` of a node.  Child `i` is
+/// half slot `2 * i` and element `i` is half slot `2 * i + 1`.
+template <class T, size_t Maximum_Elements>
+uint64_t count_half_slots(const Node<T, Maximum_Elements>* node, size_t start, size_t end) {
+    // The number of odd numbers in the range.
+    uint64_t count = end / 2 - start / 2;
+    if (node->children[0]) {
+        for (size_t child = (start + 1) / 2; child * 2 < end; ++child) {
+            count += node->children[child]->subtree_count;
+        }
+    }
+    return count;
+}
+
+/// A step on the path from the root to an iterator.  See `count_half_slots`.
+template <class T, size_t Maximum_Elements>
+struct Path_Step {
+    Node<T, Maximum_Elements>* node;
+    size_t half_slot;
+};
+
+/// Enough for any tree that fits in memory.
+const size_t MAXIMUM_HEIGHT = 64;
+
+/// Record the path from the root to the iterator.  Returns the number of steps.
+template <class T, size_t Maximum_Elements>
+size_t record_path(Iterator<T, Maximum_Elements> iterator,
+                   Path_Step<T, Maximum_Elements> path[MAXIMUM_HEIGHT]) {
+    size_t depth = 0;
+    Node<T, Maximum_Elements>* node = iterator.node;
+    size_t half_slot = iterator.index * 2 + 1;
+    for (; node; half_slot = node->parent_index * 2, node = node->parent) {
+        CZ_DEBUG_ASSERT(depth < MAXIMUM_HEIGHT);
+        path[depth++] = {node, half_slot};
+    }
+    for (size_t i = 0; i < depth / 2; ++i) {
+        Path_Step<T, Maximum_Elements> temp = path[i];
+        path[i] = path[depth - 1 - i];
+        path[depth - 1 - i] = temp;
+    }
+    return depth;
+}
+
+/// The level of the deepest node on both paths.
+template <class T, size_t Maximum_Elements>
+size_t common_level(const Path_Step<T, Maximum_Elements>* first_path,
+                    size_t first_depth,
+                    const Path_Step<T, Maximum_Elements>* last_path,
+                    size_t last_depth) {
+    size_t common = 0;
+    while (common + 1 < first_depth && common + 1 < last_depth &&
+           first_path[common + 1].node == last_path[common + 1].node) {
+        ++common;
+    }
+    return common;
+}
+
+/// Count the elements in `[first, last)`.  `first` must not be after `last`.  Only
+/// the nodes between the paths to `first` and `last` are counted so short ranges
+/// are cheap and long ranges use `subtree_count` instead of visiting every element.
+template <class T, size_t Maximum_Elements>
+uint64_t count_range(Iterator<T, Maximum_Elements> first, Iterator<T, Maximum_Elements> last) {
+    using Node = Node<T, Maximum_Elements>;
+
+    if (first == last)
+        return 0;
+
+    Path_Step<T, Maximum_Elements> first_path[MAXIMUM_HEIGHT];
+    Path_Step<T, Maximum_Elements> last_path[MAXIMUM_HEIGHT];
+    size_t depths[2] = {record_path(first, first_path), record_path(last, last_path)};
+    size_t common = common_level(first_path, depths[0], last_path, depths[1]);
+
+    // Child half slots on the paths are counted by the levels below.
+    size_t start = first_path[common].half_slot;
+    if (start % 2 == 0)
+        ++start;
+    uint64_t count = count_half_slots(first_path[common].node, start,
+                                      last_path[common].half_slot);
+
+    for (size_t level = common + 1; level < depths[0]; ++level) {
+        const Node* node = first_path[level].node;
+        start = first_path[level].half_slot;
+        if (start % 2 == 0)
+            ++start;
+        count += count_half_slots(node, start, node->num_elements * 2 + 1);
+    }
+    for (size_t level = common + 1; level < depths[1]; ++level) {
+        count += count_half_slots(last_path[level].node, 0, last_path[level].half_slot);
+    }
+    return count;
+}
+
+template <class T, size_t Maximum_Elements, class Comparator>
+Iterator<T, Maximum_Elements> multi_find_eq(const Tree_Base<T, Maximum_Elements>* tree,
+                                            Comparator&& comparator) {
+    Iterator<T, Maximum_Elements> iterator = bound(tree, comparator, /*after_equal=*/false);
+    if (iterator != detail::end(tree) && comparator(*iterator) == 0) {
+        return iterator;
+    } else {
+        return detail::end(tree);
+    }
+}
+template <class T, size_t Maximum_Elements, class Comparator>
+Iterator<T, Maximum_Elements> multi_find_before(const Tree_Base<T, Maximum_Elements>* tree,
+                                                Comparator&& comparator,
+                                                bool after_equal) {
+    Iterator<T, Maximum_Elements> iterator = bound(tree, comparator, after_equal);
+    if (iterator == detail::start(tree)) {
+        return detail::end(tree);
+    } else {
+        --iterator;
+        return iterator;
+    }
+}
+template <class T, size_t Maximum_Elements, class Comparator>
+Range<T, Maximum_Elements> equal_range(const Tree_Base<T, Maximum_Elements>* tree,
+                                       Comparator&& comparator) {
+    return {bound(tree, comparator, /*after_equal=*/false),
+            bound(tree, comparator, /*after_equal=*/true)};
+}
+}
+
+template <class T, size_t Maximum_Elements>
+Range<T, Maximum_Elements> Multi_Tree<T, Maximum_Elements>::equal_range(const T& element) {
+    return detail::equal_range(this, detail::Compare_Against<T>{&element});
+}
+template <class T, size_t Maximum_Elements>
+Range<const T, Maximum_Elements> Multi_Tree<T, Maximum_Elements>::equal_range(
+    const T& element) const {
+    return detail::equal_range(this, detail::Compare_Against<T>{&element});
+}
+
+template <class T, size_t Maximum_Elements>
+uint64_t Multi_Tree<T, Maximum_Elements>::count_eq(const T& element) const {
+    Range range = detail::equal_range(this, detail::Compare_Against<T>{&element});
+    return detail::count_range(range.start, range.end);
+}
+
+template <class T, size_t Maximum_Elements>
+Iterator<T, Maximum_Elements> Multi_Tree<T, Maximum_Elements>::find_eq(const T& element) {
+    return detail::multi_find_eq(this, detail::Compare_Against<T>{&element});
+}
+template <class T, size_t Maximum_Elements>
+Iterator<T, Maximum_Elements> Multi_Tree<T, Maximum_Elements>::find_lt(const T& element) {
+    return detail::multi_find_before(this, detail::Compare_Against<T>{&element}, false);
+}
+template <class T, size_t Maximum_Elements>
+Iterator<T, Maximum_Elements> Multi_Tree<T, Maximum_Elements>::find_gt(const T& element) {
+    return detail::bound(this, detail::Compare_Against<T>{&element}, true);
+}
+template <class T, size_t Maximum_Elements>
+Iterator<T, Maximum_Elements> Multi_Tree<T, Maximum_Elements>::find_le(const T& element) {
+    return detail::multi_find_before(this, detail::Compare_Against<T>{&element}, true);
+}
+template <class T, size_t Maximum_Elements>
+Iterator<T, Maximum_Elements> Multi_Tree<T, Maximum_Elements>::find_ge(const T& element) {
+    return detail::bound(this, detail::Compare_Against<T>{&element}, false);
+}
+
+template <class T, size_t Maximum_Elements>
+Iterator<const T, Maximum_Elements> Multi_Tree<T, Maximum_Elements>::find_eq(
+    const T& element) const {
+    return detail::multi_find_eq(this, detail::Compare_Against<T>{&element});
+}
+template <class T, size_t Maximum_Elements>
+Iterator<const T, Maximum_Elements> Multi_Tree<T, Maximum_Elements>::find_lt(
+    const T& element) const {
+    return detail::multi_find_before(this, detail::Compare_Against<T>{&element}, false);
+}
+template <class T, size_t Maximum_Elements>
+Iterator<const T, Maximum_Elements> Multi_Tree<T, Maximum_Elements>::find_gt(
+    const T& element) const {
+    return detail::bound(this, detail::Compare_Against<T>{&element}, true);
+}
+template <class T, size_t Maximum_Elements>
+Iterator<const T, Maximum_Elements> Multi_Tree<T, Maximum_Elements>::find_le(
+    const T& element) const {
+    return detail::multi_find_before(this, detail::Compare_Against<T>{&element}, true);
+}
+template <class T, size_t Maximum_Elements>
+Iterator<const T, Maximum_Elements> Multi_Tree<T, Maximum_Elements>::find_ge(
+    const T& element) const {
+    return detail::bound(this, detail::Compare_Against<T>{&element}, false);
+}
+
+
+namespace detail {
+/// Nodes other than the root never have fewer elements than this.  Splits make nodes
+/// with at least this many so only removing elements has to restore it.  Two nodes
+/// that are too small always fit in one node along with the element between them.
+inline constexpr size_t minimum_elements(size_t maximum_elements) {
+    return (maximum_elements - 1) / 2;
+}
+
+template <class T, size_t Maximum_Elements>
+void free_node(cz::Allocator allocator, Node<T, Maximum_Elements>* node) {
+    TracyFreeN(node, profile::btree_nodes);
+    allocator.dealloc(node);
+}
+
+/// Point the children starting at `start` back at the node.
+template <class T, size_t Maximum_Elements>
+void adopt_children(Node<T, Maximum_Elements>* node, size_t start) {
+    if (!node->children[0])
+        return;
+    for (size_t i = start; i < node->num_elements + 1; ++i) {
+        node->children[i]->parent = node;
+        node->children[i]->parent_index = i;
+    }
+}
+
+/// Drop the children in `[start, end)` and all of their descendants.
+template <class T, size_t Maximum_Elements>
+void drop_children(cz::Allocator allocator,
+                   Node<T, Maximum_Elements>* node,
+                   size_t start,
+                   size_t end) {
+    if (!node->children[0])
+        return;
+    for (size_t i = start; i < end; ++i) {
+        drop_node(allocator, node->children[i]);
+    }
+}
+
+/// Merge child `index` of `parent` and the element after it into child `index + 1`.
+/// The left child is freed.  If it is `*watch` then `*watch` is set to the right child.
+template <class T, size_t Maximum_Elements>
+void merge_children(cz::Allocator allocator,
+                    Node<T, Maximum_Elements>* parent,
+                    size_t index,
+                    Node<T, Maximum_Elements>** watch) {
+    Node<T, Maximum_Elements>* left = parent->children[index];
+    Node<T, Maximum_Elements>* right = parent->children[index + 1];
+    size_t shift = left->num_elements + 1;
+    CZ_DEBUG_ASSERT(right->num_elements + shift <= Maximum_Elements);
+
+    for (size_t i = right->num_elements; i-- > 0;) {
+        right->elements[i + shift] = right->elements[i];
+    }
+    for (size_t i = right->num_elements + 1; i-- > 0;) {
+        right->children[i + shift] = right->children[i];
+    }
+    for (size_t i = 0; i < left->num_elements; ++i) {
+        right->elements[i] = left->elements[i];
+    }
+    right->elements[left->num_elements] = parent->elements[index];
+    for (size_t i = 0; i < left->num_elements + 1; ++i) {
+        right->children[i] = left->children[i];
+    }
+    right->num_elements += shift;
+    right->subtree_count += left->subtree_count + 1;
+    adopt_children(right, 0);
+
+    for (size_t i = index; i + 1 < parent->num_elements; ++i) {
+        parent->elements[i] = parent->elements[i + 1];
+    }
+    for (size_t i = index; i < parent->num_elements; ++i) {
+        parent->children[i] = parent->children[i + 1];
+    }
+    --parent->num_elements;
+    adopt_children(parent, index);
+
+    if (*watch == left)
+        *watch = right;
+    free_node(allocator, left);
+}
+
+/// Split the elements of child `index` and `index + 1` of `parent`
+/// and the element between them evenly between the two children.
+template <class T, size_t Maximum_Elements>
+void redistribute_children(Node<T, Maximum_Elements>* parent, size_t index) {
+    Node<T, Maximum_Elements>* left = parent->children[index];
+    Node<T, Maximum_Elements>* right = parent->children[index + 1];
+
+    T elements[Maximum_Elements * 2 + 1];
+    Node<T, Maximum_Elements>* children[Maximum_Elements * 2 + 2];
+    size_t total = 0;
+    for (size_t i = 0; i < left->num_elements; ++i) {
+        elements[total] = left->elements[i];
+        children[total++] = left->children[i];
+    }
+    elements[total] = parent->elements[index];
+    children[total++] = left->children[left->num_elements];
+    for (size_t i = 0; i < right->num_elements; ++i) {
+        elements[total] = right->elements[i];
+        children[total++] = right->children[i];
+    }
+    children[total] = right->children[right->num_elements];
+
+    size_t middle = total / 2;
+    for (size_t i = 0; i < middle; ++i) {
+        left->elements[i] = elements[i];
+        left->children[i] = children[i];
+    }
+    left->children[middle] = children[middle];
+    left->num_elements = middle;
+
+    parent->elements[index] = elements[middle];
+
+    for (size_t i = middle + 1; i < total; ++i) {
+        right->elements[i - middle - 1] = elements[i];
+        right->children[i - middle - 1] = children[i];
+    }
+    right->children[total - middle - 1] = children[total];
+    right->num_elements = total - middle - 1;
+
+    adopt_children(left, 0);
+    adopt_children(right, 0);
+    recount(left);
+    recount(right);
+}
+
+/// Give a node that may have too few elements enough by merging it with its siblings
+/// or moving elements over from them.  It can be short by any amount.  Parents that
+/// lose elements are left for the caller and so are roots without elements.  Returns
+/// the node now holding the elements of `node`.  Nodes are only freed by merging
+/// them into a sibling or by removing an empty root above `node`.  If `*watch` is
+/// freed then it is set to the node that took its place.
+template <class T, size_t Maximum_Elements>
+Node<T, Maximum_Elements>* fix_underfull(Tree_Base<T, Maximum_Elements>* tree,
+                                         cz::Allocator allocator,
+                                         Node<T, Maximum_Elements>* node,
+                                         Node<T, Maximum_Elements>** watch) {
+    using Node = Node<T, Maximum_Elements>;
+
+    while (1) {
+        Node* parent = node->parent;
+        if (!parent || node->num_elements >= minimum_elements(Maximum_Elements))
+            return node;
+
+        if (parent->num_elements == 0) {
+            // The node has no siblings until its parent is fixed.
+            if (parent->parent) {
+                fix_underfull(tree, allocator, parent, watch);
+            } else {
+                node->parent = nullptr;
+                node->parent_index = 0;
+                tree->root = node;
+                if (*watch == parent)
+                    *watch = node;
+                free_node(allocator, parent);
+            }
+            continue;
+        }
+
+        // Prefer the left sibling.
+        size_t index = node->parent_index > 0 ? node->parent_index - 1 : 0;
+        Node* left = parent->children[index];
+        Node* right = parent->children[index + 1];
+        if (left->num_elements + right->num_elements + 1 <= Maximum_Elements) {
+            merge_children(allocator, parent, index, watch);
+            node = right;
+        } else {
+            redistribute_children(parent, index);
+            return node;
+        }
+    }
+}
+
+/// Remove the elements in `[first, last)`.
+///
+/// Below the deepest node both paths go through (the common node) everything after
+/// `first` and before `last` is cut off, freeing whole subtrees without looking
+/// at their elements.  The common node loses everything between the paths.  If
+/// `last` is below the common node then the two sides of the range need an element
+/// between them, so `*last` is moved up into the common node.  Then only the nodes
+/// on the two paths can have too few elements and they are fixed bottom up.
+template <class T, size_t Maximum_Elements>
+void erase(Tree_Base<T, Maximum_Elements>* tree,
+           cz::Allocator allocator,
+           Iterator<T, Maximum_Elements> first,
+           Iterator<T, Maximum_Elements> last) {
+    ZoneScoped;
+    static_assert(Maximum_Elements >= 3, "Removing needs room to merge nodes");
+
+    using Node = Node<T, Maximum_Elements>;
+
+    uint64_t removed = count_range(first, last);
+    if (removed == 0)
+        return;
+
+    if (removed == tree->count) {
+        drop_node(allocator, tree->root);
+        tree->root = nullptr;
+        tree->count = 0;
+        TracyPlot(profile::btree_count, (int64_t)0);
+        TracyPlot(profile::btree_height, (int64_t)0);
+        return;
+    }
+
+    Path_Step<T, Maximum_Elements> first_path[MAXIMUM_HEIGHT];
+    Path_Step<T, Maximum_Elements> last_path[MAXIMUM_HEIGHT];
+    size_t first_depth = record_path(first, first_path);
+    size_t last_depth = record_path(last, last_path);
+    size_t common = common_level(first_path, first_depth, last_path, last_depth);
+
+    // Cut off everything from `first` onwards below the common node.
+    for (size_t level = first_depth; level-- > common + 1;) {
+        Node* node = first_path[level].node;
+        size_t keep = first_path[level].half_slot / 2;
+        drop_children(allocator, node, keep + 1, node->num_elements + 1);
+        node->num_elements = keep;
+        recount(node);
+    }
+
+    // Cut off everything before `last` below the common node and take out `*last`.
+    T separator = {};
+    for (size_t level = last_depth; level-- > common + 1;) {
+        Node* node = last_path[level].node;
+        size_t half_slot = last_path[level].half_slot;
+        size_t cut = (half_slot + 1) / 2;
+        if (level + 1 == last_depth)
+            separator = node->elements[half_slot / 2];
+        drop_children(allocator, node, 0, cut);
+        for (size_t i = cut; i < node->num_elements; ++i) {
+            node->elements[i - cut] = node->elements[i];
+        }
+        for (size_t i = cut; i < node->num_elements + 1; ++i) {
+            node->children[i - cut] = node->children[i];
+        }
+        node->num_elements -= cut;
+        adopt_children(node, 0);
+        recount(node);
+    }
+
+    // Remove the half slots strictly between the paths from the common node.
+    Node* node = first_path[common].node;
+    size_t first_slot = first_path[common].half_slot;
+    size_t last_slot = last_path[common].half_slot;
+    bool separate = last_slot % 2 == 0;
+    drop_children(allocator, node, first_slot / 2 + 1, (last_slot + 1) / 2);
+    size_t num_elements = first_slot / 2;
+    if (separate)
+        node->elements[num_elements++] = separator;
+    for (size_t i = last_slot / 2; i < node->num_elements; ++i) {
+        node->elements[num_elements++] = node->elements[i];
+    }
+    size_t num_children = first_slot / 2 + 1;
+    for (size_t i = (last_slot + 1) / 2; i < node->num_elements + 1; ++i) {
+        node->children[num_children++] = node->children[i];
+    }
+    node->num_elements = num_elements;
+    adopt_children(node, first_slot / 2 + 1);
+    recount(node);
+
+    for (size_t level = 0; level < common; ++level) {
+        first_path[level].node->subtree_count -= removed;
+    }
+    tree->count -= removed;
+
+    // Fix the left path first.  It can merge nodes on the right path
+    // into their left siblings, so keep track of where they went.
+    Node* right_bottom = separate ? last_path[last_depth - 1].node : nullptr;
+    for (Node* left = first_path[first_depth - 1].node; left; left = left->parent) {
+        left = fix_underfull(tree, allocator, left, &right_bottom);
+    }
+    Node* none = nullptr;
+    for (Node* right = right_bottom; right; right = right->parent) {
+        right = fix_underfull(tree, allocator, right, &none);
+    }
+
+    // Merges can leave the root without elements.
+    while (tree->root->num_elements == 0) {
+        Node* root = tree->root;
+        tree->root = root->children[0];
+        tree->root->parent = nullptr;
+        tree->root->parent_index = 0;
+        free_node(allocator, root);
+    }
+
+    TracyPlot(profile::btree_count, (int64_t)tree->count);
+    TracyPlot(profile::btree_height, (int64_t)detail::height(tree));
+}
+}
+
+template <class T, size_t Maximum_Elements>
+void Tree_Base<T, Maximum_Elements>::remove(cz::Allocator allocator, Const_Iterator iterator) {
+    if (iterator == end())
+        return;
+    Const_Iterator next = iterator;
+    ++next;
+    erase(allocator, iterator, next);
+}
+
+template <class T, size_t Maximum_Elements>
+void Tree_Base<T, Maximum_Elements>::erase(cz::Allocator allocator,
+                                           Const_Iterator first,
+                                           Const_Iterator last) {
+    detail::erase(this, allocator, Iterator{(Node*)first.node, first.index},
+                  Iterator{(Node*)last.node, last.index});
+}
+
+template <class T, size_t Maximum_Elements>
+void Tree<T, Maximum_Elements>::erase_range(cz::Allocator allocator, const T& lo, const T& hi) {
+    using cz::compare;
+    if (compare(lo, hi) >= 0)
+        return;
+    this->erase(allocator, find_ge(lo), find_ge(hi));
+}
 }
 }
 
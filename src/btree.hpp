@@ -8,7 +8,7 @@ namespace btree {
 
 template <class T>
 struct Default_Maximum_Elements {
-    static const size_t items_per_page = (4096 - 4 * sizeof(void*)) / (sizeof(T) + sizeof(void*));
+    static const size_t items_per_page = (4096 - 5 * sizeof(void*)) / (sizeof(T) + sizeof(void*));
     static const size_t value = items_per_page > 4 ? items_per_page : 4;
 };
 
@@ -17,6 +17,8 @@ struct Node {
     Node* parent;
     size_t parent_index;
     size_t num_elements;
+    /// The number of elements in this node and its descendants.
+    uint64_t subtree_count;
     Node* children[Maximum_Elements + 1];
     T elements[Maximum_Elements];
 };
@@ -79,10 +81,60 @@ struct Iterator {
     bool operator!=(const Iterator& other) const { return !(*this == other); }
 };
 
+/// A half open range of elements.  See `Multi_Tree::equal_range`.
+template <class T, size_t Maximum_Elements = Default_Maximum_Elements<T>::value>
+struct Range {
+    Iterator<T, Maximum_Elements> start;
+    Iterator<T, Maximum_Elements> end;
+
+    operator Range<const T, Maximum_Elements>() const { return {start, end}; }
+};
+
+/// The result of `Tree::try_insert`.
+template <class T, size_t Maximum_Elements = Default_Maximum_Elements<T>::value>
+struct Insert_Result {
+    /// The inserted element or the equal element that prevented the insert.
+    Iterator<T, Maximum_Elements> iterator;
+    bool inserted;
+};
+
+/// The shape and memory use of a B-tree.  See `Tree_Base::stats`.
+struct Stats {
+    static const size_t LEVELS = 32;
+    static const size_t FILL_BUCKETS = 10;
+
+    size_t elements;
+    size_t nodes;
+    size_t leaves;
+    size_t maximum_elements;
+
+    /// The number of levels.  An empty tree has height 0.
+    size_t height;
+
+    /// The number of nodes at each level, starting at the root.
+    size_t nodes_per_level[LEVELS];
+
+    /// Bucket `i` counts the nodes holding at least `i / FILL_BUCKETS` of
+    /// `maximum_elements`.  Full nodes are counted in the last bucket.
+    size_t fill_histogram[FILL_BUCKETS];
+
+    /// Bytes of nodes allocated versus bytes of elements stored in them.
+    size_t bytes_allocated;
+    size_t bytes_payload;
+
+    double average_elements_per_node() const { return nodes ? (double)elements / nodes : 0; }
+    double fill_factor() const {
+        return nodes ? (double)elements / (nodes * maximum_elements) : 1;
+    }
+    double efficiency() const {
+        return bytes_allocated ? (double)bytes_payload / bytes_allocated : 1;
+    }
+};
+
 template <class T, size_t Maximum_Elements>
 struct Tree_Base {
     static_assert(Maximum_Elements >= 1, "0 elements doesn't allow insertion");
-    using Node = Node<T, Maximum_Elements>;
+    using Node = ds::btree::Node<T, Maximum_Elements>;
     using Iterator = ds::btree::Iterator<T, Maximum_Elements>;
     using Const_Iterator = ds::btree::Iterator<const T, Maximum_Elements>;
     constexpr static const size_t M = Maximum_Elements;
@@ -94,16 +146,74 @@ struct Tree_Base {
     Const_Iterator start() const;
     Const_Iterator end() const;
 
+    /// Remove the element at the iterator.
+    /// If the iterator is `end` then nothing is done.
     void remove(cz::Allocator allocator, Const_Iterator iterator);
 
+    /// Remove the elements in `[first, last)`.  Subtrees inside the range are freed
+    /// without visiting their elements and the tree is only rebalanced along the
+    /// edges of the range, so this takes O(log n + k / Maximum_Elements) time.
+    /// Requires `Maximum_Elements >= 3`.  Invalidates every iterator.
+    void erase(cz::Allocator allocator, Const_Iterator first, Const_Iterator last);
+
+    /// Measure the shape and memory use of the tree.  This walks every node.
+    Stats stats() const;
+
     Node* root;
     uint64_t count;
 };
 
 template <class T, size_t Maximum_Elements = Default_Maximum_Elements<T>::value>
 struct Tree : Tree_Base<T, Maximum_Elements> {
+    using Iterator = ds::btree::Iterator<T, Maximum_Elements>;
+    using Const_Iterator = ds::btree::Iterator<const T, Maximum_Elements>;
+
     bool insert(cz::Allocator allocator, const T& element);
 
+    /// Insert the element and get an iterator to it.  If an equal element is
+    /// present then nothing is inserted and the iterator points to it.
+    Insert_Result<T, Maximum_Elements> try_insert(cz::Allocator allocator, const T& element);
+
+    /// Remove the elements in `[lo, hi)`.  See `Tree_Base::erase`.
+    void erase_range(cz::Allocator allocator, const T& lo, const T& hi);
+
+    Iterator find(const T& element) { return find_eq(element); }
+    Iterator find_eq(const T& element);
+    Iterator find_lt(const T& element);
+    Iterator find_gt(const T& element);
+    Iterator find_le(const T& element);
+    Iterator find_ge(const T& element);
+
+    Const_Iterator find(const T& element) const { return find_eq(element); }
+    Const_Iterator find_eq(const T& element) const;
+    Const_Iterator find_lt(const T& element) const;
+    Const_Iterator find_gt(const T& element) const;
+    Const_Iterator find_le(const T& element) const;
+    Const_Iterator find_ge(const T& element) const;
+};
+
+/// A B-tree that allows duplicate elements (a multiset).  Equal elements
+/// are kept in the order they were inserted.
+template <class T, size_t Maximum_Elements = Default_Maximum_Elements<T>::value>
+struct Multi_Tree : Tree_Base<T, Maximum_Elements> {
+    using Iterator = ds::btree::Iterator<T, Maximum_Elements>;
+    using Const_Iterator = ds::btree::Iterator<const T, Maximum_Elements>;
+    using Range = ds::btree::Range<T, Maximum_Elements>;
+    using Const_Range = ds::btree::Range<const T, Maximum_Elements>;
+
+    /// Insert the element after any elements equal to it.
+    void insert(cz::Allocator allocator, const T& element);
+
+    /// Get the elements equal to `element`.
+    Range equal_range(const T& element);
+    Const_Range equal_range(const T& element) const;
+
+    /// Count the elements equal to `element`.  Nodes store the size of their
+    /// subtree so this walks the two ends of the range instead of every match.
+    uint64_t count_eq(const T& element) const;
+
+    /// `find_eq` finds the first equal element.  `find_lt` and `find_gt`
+    /// skip every equal element.
     Iterator find(const T& element) { return find_eq(element); }
     Iterator find_eq(const T& element);
     Iterator find_lt(const T& element);
@@ -121,12 +231,21 @@ struct Tree : Tree_Base<T, Maximum_Elements> {
 
 template <class T, size_t Maximum_Elements = Default_Maximum_Elements<T>::value>
 struct Tree_Comparator : Tree_Base<T, Maximum_Elements> {
+    using Iterator = ds::btree::Iterator<T, Maximum_Elements>;
+    using Const_Iterator = ds::btree::Iterator<const T, Maximum_Elements>;
+
     template <class Comparator>
     bool insert(cz::Allocator allocator, const T& element, Comparator&& comparator);
 
+    /// See `Tree::try_insert`.
+    template <class Comparator>
+    Insert_Result<T, Maximum_Elements> try_insert(cz::Allocator allocator,
+                                                  const T& element,
+                                                  Comparator&& comparator);
+
     template <class Comparator>
-    Iterator find(const T& element, Comparator&& comparator) {
-        return find_eq(element, comparator);
+    Iterator find(Comparator&& comparator) {
+        return find_eq(comparator);
     }
     template <class Comparator>
     Iterator find_eq(Comparator&& comparator);
@@ -140,8 +259,8 @@ struct Tree_Comparator : Tree_Base<T, Maximum_Elements> {
     Iterator find_ge(Comparator&& comparator);
 
     template <class Comparator>
-    Const_Iterator find(const T& element, Comparator&& comparator) const {
-        return find_eq(element, comparator);
+    Const_Iterator find(Comparator&& comparator) const {
+        return find_eq(comparator);
     }
     template <class Comparator>
     Const_Iterator find_eq(Comparator&& comparator) const;
@@ -6,80 +6,152 @@
 namespace ds {
 namespace btree {
 
-template <class Key>
-struct Key_Comparator {
-    const Key* key;
-
-    template <class Value>
-    int64_t operator()(const Pair<Key, Value>& pair) const {
-        using cz::compare;
-        return compare(*key, pair.key);
+template <class Key, class Value, size_t Maximum_Elements>
+void Map<Key, Value, Maximum_Elements>::drop_with_keys(cz::Allocator allocator,
+                                                       cz::Allocator key_allocator) {
+    for (Iterator it = start(), last = end(); it != last; ++it) {
+        it->key.drop(key_allocator);
     }
-};
-
-template <class Key>
-Key_Comparator<Key> key_comparator(const Key& key) {
-    return {&key};
+    drop(allocator);
 }
 
 template <class Key, class Value, size_t Maximum_Elements>
 Iterator<Pair<Key, Value>, Maximum_Elements> Map<Key, Value, Maximum_Elements>::find_eq(
     const Key& key) {
-    return tree.find_eq(key_comparator(key));
+    return tree.find_eq(gen::key_comparator(key));
 }
 
 template <class Key, class Value, size_t Maximum_Elements>
 Iterator<Pair<Key, Value>, Maximum_Elements> Map<Key, Value, Maximum_Elements>::find_lt(
     const Key& key) {
-    return tree.find_lt(key_comparator(key));
+    return tree.find_lt(gen::key_comparator(key));
 }
 
 template <class Key, class Value, size_t Maximum_Elements>
 Iterator<Pair<Key, Value>, Maximum_Elements> Map<Key, Value, Maximum_Elements>::find_gt(
     const Key& key) {
-    return tree.find_gt(key_comparator(key));
+    return tree.find_gt(gen::key_comparator(key));
 }
 
 template <class Key, class Value, size_t Maximum_Elements>
 Iterator<Pair<Key, Value>, Maximum_Elements> Map<Key, Value, Maximum_Elements>::find_le(
     const Key& key) {
-    return tree.find_le(key_comparator(key));
+    return tree.find_le(gen::key_comparator(key));
 }
 
 template <class Key, class Value, size_t Maximum_Elements>
 Iterator<Pair<Key, Value>, Maximum_Elements> Map<Key, Value, Maximum_Elements>::find_ge(
     const Key& key) {
-    return tree.find_ge(key_comparator(key));
+    return tree.find_ge(gen::key_comparator(key));
 }
 
 template <class Key, class Value, size_t Maximum_Elements>
 Iterator<const Pair<Key, Value>, Maximum_Elements> Map<Key, Value, Maximum_Elements>::find_eq(
     const Key& key) const {
-    return tree.find_eq(key_comparator(key));
+    return tree.find_eq(gen::key_comparator(key));
 }
 
 template <class Key, class Value, size_t Maximum_Elements>
 Iterator<const Pair<Key, Value>, Maximum_Elements> Map<Key, Value, Maximum_Elements>::find_lt(
     const Key& key) const {
-    return tree.find_lt(key_comparator(key));
+    return tree.find_lt(gen::key_comparator(key));
 }
 
 template <class Key, class Value, size_t Maximum_Elements>
 Iterator<const Pair<Key, Value>, Maximum_Elements> Map<Key, Value, Maximum_Elements>::find_gt(
     const Key& key) const {
-    return tree.find_gt(key_comparator(key));
+    return tree.find_gt(gen::key_comparator(key));
 }
 
 template <class Key, class Value, size_t Maximum_Elements>
 Iterator<const Pair<Key, Value>, Maximum_Elements> Map<Key, Value, Maximum_Elements>::find_le(
     const Key& key) const {
-    return tree.find_le(key_comparator(key));
+    return tree.find_le(gen::key_comparator(key));
 }
 
 template <class Key, class Value, size_t Maximum_Elements>
 Iterator<const Pair<Key, Value>, Maximum_Elements> Map<Key, Value, Maximum_Elements>::find_ge(
     const Key& key) const {
-    return tree.find_ge(key_comparator(key));
+    return tree.find_ge(gen::key_comparator(key));
+}
+
+
+template <class Key, class Value, size_t Maximum_Elements>
+Range<Pair<Key, Value>, Maximum_Elements> Multi_Map<Key, Value, Maximum_Elements>::equal_range(
+    const Key& key) {
+    return detail::equal_range(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value, size_t Maximum_Elements>
+Range<const Pair<Key, Value>, Maximum_Elements>
+Multi_Map<Key, Value, Maximum_Elements>::equal_range(const Key& key) const {
+    return detail::equal_range(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value, size_t Maximum_Elements>
+uint64_t Multi_Map<Key, Value, Maximum_Elements>::count_eq(const Key& key) const {
+    Range range = detail::equal_range(&tree, gen::key_comparator(key));
+    return detail::count_range(range.start, range.end);
+}
+
+template <class Key, class Value, size_t Maximum_Elements>
+Iterator<Pair<Key, Value>, Maximum_Elements> Multi_Map<Key, Value, Maximum_Elements>::find_eq(
+    const Key& key) {
+    return detail::multi_find_eq(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value, size_t Maximum_Elements>
+Iterator<Pair<Key, Value>, Maximum_Elements> Multi_Map<Key, Value, Maximum_Elements>::find_lt(
+    const Key& key) {
+    return detail::multi_find_before(&tree, gen::key_comparator(key), false);
+}
+
+template <class Key, class Value, size_t Maximum_Elements>
+Iterator<Pair<Key, Value>, Maximum_Elements> Multi_Map<Key, Value, Maximum_Elements>::find_gt(
+    const Key& key) {
+    return detail::bound(&tree, gen::key_comparator(key), true);
+}
+
+template <class Key, class Value, size_t Maximum_Elements>
+Iterator<Pair<Key, Value>, Maximum_Elements> Multi_Map<Key, Value, Maximum_Elements>::find_le(
+    const Key& key) {
+    return detail::multi_find_before(&tree, gen::key_comparator(key), true);
+}
+
+template <class Key, class Value, size_t Maximum_Elements>
+Iterator<Pair<Key, Value>, Maximum_Elements> Multi_Map<Key, Value, Maximum_Elements>::find_ge(
+    const Key& key) {
+    return detail::bound(&tree, gen::key_comparator(key), false);
+}
+
+template <class Key, class Value, size_t Maximum_Elements>
+Iterator<const Pair<Key, Value>, Maximum_Elements>
+Multi_Map<Key, Value, Maximum_Elements>::find_eq(const Key& key) const {
+    return detail::multi_find_eq(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value, size_t Maximum_Elements>
+Iterator<const Pair<Key, Value>, Maximum_Elements>
+Multi_Map<Key, Value, Maximum_Elements>::find_lt(const Key& key) const {
+    return detail::multi_find_before(&tree, gen::key_comparator(key), false);
+}
+
+template <class Key, class Value, size_t Maximum_Elements>
+Iterator<const Pair<Key, Value>, Maximum_Elements>
+Multi_Map<Key, Value, Maximum_Elements>::find_gt(const Key& key) const {
+    return detail::bound(&tree, gen::key_comparator(key), true);
+}
+
+template <class Key, class Value, size_t Maximum_Elements>
+Iterator<const Pair<Key, Value>, Maximum_Elements>
+Multi_Map<Key, Value, Maximum_Elements>::find_le(const Key& key) const {
+    return detail::multi_find_before(&tree, gen::key_comparator(key), true);
+}
+
+template <class Key, class Value, size_t Maximum_Elements>
+Iterator<const Pair<Key, Value>, Maximum_Elements>
+Multi_Map<Key, Value, Maximum_Elements>::find_ge(const Key& key) const {
+    return detail::bound(&tree, gen::key_comparator(key), false);
 }
 
 }
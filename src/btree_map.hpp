@@ -18,23 +18,66 @@ struct Map {
     using Pair = gen::Map_Pair<Key, Value>;
     using Iterator = ds::btree::Iterator<Pair, Maximum_Elements>;
     using Const_Iterator = ds::btree::Iterator<const Pair, Maximum_Elements>;
+    using Insert_Result = ds::btree::Insert_Result<Pair, Maximum_Elements>;
     constexpr static const size_t M = Maximum_Elements;
 
     void drop(cz::Allocator allocator) { return tree.drop(allocator); }
 
+    /// Drop every key with `key_allocator` and then drop the map.
+    ///
+    /// Keys that live in a `String_Arena` (see `SSOStr::in_arena`) or a `String_Pool`
+    /// must not be dropped individually.  Use `drop` and reset the arena instead,
+    /// which skips walking the map entirely.
+    void drop_with_keys(cz::Allocator allocator, cz::Allocator key_allocator);
+
+    /// Measure the shape and memory use of the map.  This walks every node.
+    Stats stats() const { return tree.stats(); }
+
     /// Insert the element into the tree.  If the element already
     /// is present then does nothing and returns `false`.
     bool insert(cz::Allocator allocator, const Key& key, const Value& value) {
         return insert(allocator, {key, value});
     }
     bool insert(cz::Allocator allocator, const Pair& pair) {
-        return tree.insert(allocator, pair, cz::compare<Pair>);
+        return tree.insert(allocator, pair, detail::Compare_Elements<Pair>{});
+    }
+
+    /// Insert the pair and get an iterator to it.  If the key already is present then
+    /// nothing is inserted and the iterator points to the existing pair.  This is one
+    /// descent of the tree instead of a `find` followed by an `insert`.
+    Insert_Result try_insert(cz::Allocator allocator, const Key& key, const Value& value) {
+        return try_insert(allocator, {key, value});
+    }
+    Insert_Result try_insert(cz::Allocator allocator, const Pair& pair) {
+        return tree.try_insert(allocator, pair, detail::Compare_Elements<Pair>{});
+    }
+
+    /// Insert the pair or assign the value if the key already is present.
+    Insert_Result insert_or_assign(cz::Allocator allocator, const Key& key, const Value& value) {
+        Insert_Result result = try_insert(allocator, key, value);
+        if (!result.inserted)
+            result.iterator->value = value;
+        return result;
+    }
+
+    /// Get the pair with the key, inserting it with a value
+    /// initialized `Value` if it isn't present.
+    Iterator get_or_insert_default(cz::Allocator allocator, const Key& key) {
+        return try_insert(allocator, key, Value()).iterator;
     }
 
     /// Remove the element at the iterator.
     /// If the iterator is `end` then nothing is done.
     void remove(cz::Allocator allocator, Const_Iterator iterator) {
-        return tree.remove(allocator, iterator, cz::compare<Pair>);
+        return tree.remove(allocator, iterator);
+    }
+
+    /// Remove the pairs with keys in `[lo, hi)`.  See `Tree_Base::erase`.
+    void erase_range(cz::Allocator allocator, const Key& lo, const Key& hi) {
+        using cz::compare;
+        if (compare(lo, hi) >= 0)
+            return;
+        tree.erase(allocator, find_ge(lo), find_ge(hi));
     }
 
     /// Get iterators allowing you to iterate through the entire tree.
@@ -76,6 +119,64 @@ struct Map {
     Tree_Comparator<Pair, Maximum_Elements> tree;
 };
 
+/// A B-tree map that allows duplicate keys (a multimap).  Pairs with
+/// equal keys are kept in the order they were inserted.
+template <class Key,
+          class Value,
+          size_t Maximum_Elements = Default_Maximum_Elements<Pair<Key, Value> >::value>
+struct Multi_Map {
+    using Pair = gen::Map_Pair<Key, Value>;
+    using Iterator = ds::btree::Iterator<Pair, Maximum_Elements>;
+    using Const_Iterator = ds::btree::Iterator<const Pair, Maximum_Elements>;
+    using Range = ds::btree::Range<Pair, Maximum_Elements>;
+    using Const_Range = ds::btree::Range<const Pair, Maximum_Elements>;
+    constexpr static const size_t M = Maximum_Elements;
+
+    void drop(cz::Allocator allocator) { return tree.drop(allocator); }
+
+    /// Measure the shape and memory use of the map.  This walks every node.
+    Stats stats() const { return tree.stats(); }
+
+    /// Insert the pair after any pairs with an equal key.
+    void insert(cz::Allocator allocator, const Key& key, const Value& value) {
+        insert(allocator, {key, value});
+    }
+    void insert(cz::Allocator allocator, const Pair& pair) {
+        detail::insert(&tree, allocator, pair, detail::Compare_Elements<Pair>{},
+                       /*duplicates=*/true);
+    }
+
+    /// Get iterators allowing you to iterate through the entire tree.
+    Iterator start() { return tree.start(); }
+    Iterator end() { return tree.end(); }
+    Const_Iterator start() const { return tree.start(); }
+    Const_Iterator end() const { return tree.end(); }
+
+    /// Get the pairs with the key.
+    Range equal_range(const Key& key);
+    Const_Range equal_range(const Key& key) const;
+
+    /// Count the pairs with the key.  See `Multi_Tree::count_eq`.
+    uint64_t count_eq(const Key& key) const;
+
+    /// Get iterators based on the position of the key.  `find_eq` finds the first
+    /// pair with the key.  If there are no matches then `end` is returned.
+    Iterator find(const Key& key) { return find_eq(key); }
+    Iterator find_eq(const Key& key);
+    Iterator find_lt(const Key& key);
+    Iterator find_gt(const Key& key);
+    Iterator find_le(const Key& key);
+    Iterator find_ge(const Key& key);
+    Const_Iterator find(const Key& key) const { return find_eq(key); }
+    Const_Iterator find_eq(const Key& key) const;
+    Const_Iterator find_lt(const Key& key) const;
+    Const_Iterator find_gt(const Key& key) const;
+    Const_Iterator find_le(const Key& key) const;
+    Const_Iterator find_ge(const Key& key) const;
+
+    Tree_Base<Pair, Maximum_Elements> tree;
+};
+
 }
 }
 
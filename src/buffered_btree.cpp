@@ -0,0 +1,664 @@
+#ifndef DS_BTREE_BUFFERED_BTREE_CPP
+#define DS_BTREE_BUFFERED_BTREE_CPP
+
+#include "buffered_btree.hpp"
+#include "profile.hpp"
+
+#include <Tracy.hpp>
+#include <cz/compare.hpp>
+
+namespace ds {
+namespace btree {
+
+namespace detail {
+
+/// The index of the first element after `element` if `after_equal`
+/// and the index of the first element not before it otherwise.
+template <class T>
+size_t position(const T* elements, size_t len, const T& element, bool after_equal) {
+    if (len == 0)
+        return 0;
+    size_t index;
+    if (binary_search<T>({elements, len}, Compare_Against<T>{&element}, &index) && after_equal)
+        ++index;
+    return index;
+}
+
+template <class T>
+int64_t compare_elements(const T& left, const T& right) {
+    using cz::compare;
+    return compare(left, right);
+}
+
+template <class T, size_t Fanout, size_t Buffer_Size>
+size_t child_index(const Buffered_Internal<T, Fanout, Buffer_Size>* node, const T& element) {
+    return position(node->pivots, node->num_children - 1, element, true);
+}
+
+template <class T, size_t Fanout, size_t Buffer_Size>
+void insert_child(Buffered_Internal<T, Fanout, Buffer_Size>* node,
+                  size_t index,
+                  const T& pivot,
+                  void* child) {
+    CZ_DEBUG_ASSERT(index > 0);
+    CZ_DEBUG_ASSERT(node->num_children <= Fanout);
+    for (size_t i = node->num_children; i-- > index;) {
+        node->children[i + 1] = node->children[i];
+    }
+    for (size_t i = node->num_children - 1; i-- > index - 1;) {
+        node->pivots[i + 1] = node->pivots[i];
+    }
+    node->children[index] = child;
+    node->pivots[index - 1] = pivot;
+    ++node->num_children;
+}
+
+/// Remove child `index`.  Its range is merged into a neighbor.
+template <class T, size_t Fanout, size_t Buffer_Size>
+void remove_child(Buffered_Internal<T, Fanout, Buffer_Size>* node, size_t index) {
+    CZ_DEBUG_ASSERT(node->num_children > 1);
+    for (size_t i = index; i + 1 < node->num_children; ++i) {
+        node->children[i] = node->children[i + 1];
+    }
+    for (size_t i = index > 0 ? index - 1 : 0; i + 2 < node->num_children; ++i) {
+        node->pivots[i] = node->pivots[i + 1];
+    }
+    --node->num_children;
+}
+
+template <class T, size_t Fanout, size_t Buffer_Size>
+void remove_messages(Buffered_Internal<T, Fanout, Buffer_Size>* node, size_t start, size_t len) {
+    for (size_t i = start; i + len < node->num_messages; ++i) {
+        node->messages[i] = node->messages[i + len];
+        node->removes[i] = node->removes[i + len];
+    }
+    node->num_messages -= len;
+}
+
+/// Merge messages from the parent into `node`'s buffer.  The parent's messages
+/// are newer so they replace messages for the same element.
+template <class T, size_t Fanout, size_t Buffer_Size>
+void merge_messages(Buffered_Internal<T, Fanout, Buffer_Size>* node,
+                    const T* messages,
+                    const bool* removes,
+                    size_t len,
+                    uint64_t* pending) {
+    T merged[Buffer_Size];
+    bool merged_removes[Buffer_Size];
+    size_t total = 0;
+    size_t i = 0, j = 0;
+    while (i < node->num_messages || j < len) {
+        int64_t comparison;
+        if (i == node->num_messages) {
+            comparison = 1;
+        } else if (j == len) {
+            comparison = -1;
+        } else {
+            comparison = compare_elements(node->messages[i], messages[j]);
+        }
+
+        CZ_DEBUG_ASSERT(total < Buffer_Size);
+        if (comparison < 0) {
+            merged[total] = node->messages[i];
+            merged_removes[total] = node->removes[i];
+            ++i;
+        } else {
+            if (comparison == 0) {
+                ++i;
+                --*pending;
+            }
+            merged[total] = messages[j];
+            merged_removes[total] = removes[j];
+            ++j;
+        }
+        ++total;
+    }
+
+    for (size_t k = 0; k < total; ++k) {
+        node->messages[k] = merged[k];
+        node->removes[k] = merged_removes[k];
+    }
+    node->num_messages = total;
+}
+
+/// Apply messages to a leaf.  If the leaf overflows then the upper half
+/// is moved into a new leaf, which is returned.  At most `Maximum_Elements`
+/// messages can be applied at once so one split is always enough.
+template <class T, size_t Maximum_Elements>
+Buffered_Leaf<T, Maximum_Elements>* apply_messages(cz::Allocator allocator,
+                                                   Buffered_Leaf<T, Maximum_Elements>* leaf,
+                                                   const T* messages,
+                                                   const bool* removes,
+                                                   size_t len,
+                                                   uint64_t* count) {
+    using Leaf = Buffered_Leaf<T, Maximum_Elements>;
+    CZ_DEBUG_ASSERT(len <= Maximum_Elements);
+
+    T merged[2 * Maximum_Elements];
+    size_t total = 0;
+    size_t i = 0, j = 0;
+    while (i < leaf->num_elements || j < len) {
+        int64_t comparison;
+        if (i == leaf->num_elements) {
+            comparison = 1;
+        } else if (j == len) {
+            comparison = -1;
+        } else {
+            comparison = compare_elements(leaf->elements[i], messages[j]);
+        }
+
+        if (comparison < 0) {
+            merged[total++] = leaf->elements[i++];
+            continue;
+        }
+
+        if (comparison == 0) {
+            ++i;
+            if (removes[j])
+                --*count;
+        } else if (!removes[j]) {
+            ++*count;
+        }
+        if (!removes[j])
+            merged[total++] = messages[j];
+        ++j;
+    }
+
+    Leaf* right = nullptr;
+    size_t split = total;
+    if (total > Maximum_Elements) {
+        right = allocator.alloc<Leaf>();
+        CZ_ASSERT(right);
+        TracyAllocN(right, sizeof(Leaf), profile::buffered_btree_nodes);
+        split = (total + 1) / 2;
+        right->num_elements = total - split;
+        for (size_t k = split; k < total; ++k) {
+            right->elements[k - split] = merged[k];
+        }
+    }
+
+    for (size_t k = 0; k < split; ++k) {
+        leaf->elements[k] = merged[k];
+    }
+    leaf->num_elements = split;
+    return right;
+}
+
+/// Split an internal node with too many children in half.  Returns the
+/// new right half and sets `pivot` to the pivot that separates them.
+template <class T, size_t Fanout, size_t Buffer_Size>
+Buffered_Internal<T, Fanout, Buffer_Size>* split_internal(
+    cz::Allocator allocator,
+    Buffered_Internal<T, Fanout, Buffer_Size>* left,
+    T* pivot) {
+    using Internal = Buffered_Internal<T, Fanout, Buffer_Size>;
+
+    Internal* right = allocator.alloc<Internal>();
+    CZ_ASSERT(right);
+    TracyAllocN(right, sizeof(Internal), profile::buffered_btree_nodes);
+
+    size_t split = left->num_children / 2;
+    *pivot = left->pivots[split - 1];
+
+    right->num_children = left->num_children - split;
+    for (size_t i = split; i < left->num_children; ++i) {
+        right->children[i - split] = left->children[i];
+    }
+    for (size_t i = split; i + 1 < left->num_children; ++i) {
+        right->pivots[i - split] = left->pivots[i];
+    }
+    left->num_children = split;
+
+    size_t first = position(left->messages, left->num_messages, *pivot, false);
+    right->num_messages = left->num_messages - first;
+    for (size_t i = first; i < left->num_messages; ++i) {
+        right->messages[i - first] = left->messages[i];
+        right->removes[i - first] = left->removes[i];
+    }
+    left->num_messages = first;
+    return right;
+}
+
+template <class T, size_t Fanout, size_t Buffer_Size>
+void split_child(cz::Allocator allocator,
+                 Buffered_Internal<T, Fanout, Buffer_Size>* node,
+                 size_t index) {
+    T pivot;
+    auto left = (Buffered_Internal<T, Fanout, Buffer_Size>*)node->children[index];
+    auto right = split_internal(allocator, left, &pivot);
+    insert_child(node, index + 1, pivot, right);
+}
+
+/// Move the messages bound for the child with the most messages down a level.
+/// Children are split when they overflow, which may leave `node` with one child
+/// too many.  If a child runs out of room before the messages can be moved then
+/// only the child's messages are moved instead.
+template <class T, size_t Maximum_Elements, size_t Fanout, size_t Buffer_Size>
+void flush_once(Buffered_Tree<T, Maximum_Elements, Fanout, Buffer_Size>* tree,
+                cz::Allocator allocator,
+                Buffered_Internal<T, Fanout, Buffer_Size>* node,
+                size_t level) {
+    ZoneScoped;
+
+    using Leaf = Buffered_Leaf<T, Maximum_Elements>;
+    using Internal = Buffered_Internal<T, Fanout, Buffer_Size>;
+    CZ_DEBUG_ASSERT(node->num_messages > 0);
+
+    size_t index = 0, start = 0, end = 0;
+    for (size_t child = 0, child_start = 0; child < node->num_children; ++child) {
+        size_t child_end = child + 1 < node->num_children
+                               ? position(node->messages, node->num_messages,
+                                          node->pivots[child], false)
+                               : node->num_messages;
+        if (child_end - child_start > end - start) {
+            index = child;
+            start = child_start;
+            end = child_end;
+        }
+        child_start = child_end;
+    }
+
+    if (level == 1) {
+        Leaf* leaf = (Leaf*)node->children[index];
+        size_t len = end - start;
+        if (len > Maximum_Elements)
+            len = Maximum_Elements;
+
+        Leaf* right = apply_messages(allocator, leaf, node->messages + start,
+                                     node->removes + start, len, &tree->count);
+        remove_messages(node, start, len);
+        tree->pending -= len;
+
+        if (right) {
+            insert_child(node, index + 1, right->elements[0], right);
+        } else if (leaf->num_elements == 0 && node->num_children > 1) {
+            remove_child(node, index);
+            TracyFreeN(leaf, profile::buffered_btree_nodes);
+            allocator.dealloc(leaf);
+        }
+        return;
+    }
+
+    Internal* child = (Internal*)node->children[index];
+    while (child->num_messages + (end - start) > Buffer_Size) {
+        flush_once(tree, allocator, child, level - 1);
+        if (child->num_children > Fanout) {
+            split_child(allocator, node, index);
+            return;
+        }
+    }
+
+    merge_messages(child, node->messages + start, node->removes + start, end - start,
+                   &tree->pending);
+    remove_messages(node, start, end - start);
+}
+
+/// Flush every message in the subtree.  Stops early if `node` gets too many children.
+template <class T, size_t Maximum_Elements, size_t Fanout, size_t Buffer_Size>
+void flush_all(Buffered_Tree<T, Maximum_Elements, Fanout, Buffer_Size>* tree,
+               cz::Allocator allocator,
+               Buffered_Internal<T, Fanout, Buffer_Size>* node,
+               size_t level) {
+    using Internal = Buffered_Internal<T, Fanout, Buffer_Size>;
+
+    while (node->num_messages > 0) {
+        flush_once(tree, allocator, node, level);
+        if (node->num_children > Fanout)
+            return;
+    }
+
+    if (level == 1)
+        return;
+
+    for (size_t index = 0; index < node->num_children;) {
+        Internal* child = (Internal*)node->children[index];
+        flush_all(tree, allocator, child, level - 1);
+        if (child->num_children > Fanout) {
+            // Revisit the left half since it may still have messages.
+            split_child(allocator, node, index);
+            if (node->num_children > Fanout)
+                return;
+            continue;
+        }
+        ++index;
+    }
+}
+
+/// If the root has too many children then split it and add a level.
+template <class T, size_t Maximum_Elements, size_t Fanout, size_t Buffer_Size>
+void grow_root(Buffered_Tree<T, Maximum_Elements, Fanout, Buffer_Size>* tree,
+               cz::Allocator allocator,
+               void* right,
+               const T& pivot) {
+    using Internal = Buffered_Internal<T, Fanout, Buffer_Size>;
+
+    Internal* root = allocator.alloc<Internal>();
+    CZ_ASSERT(root);
+    TracyAllocN(root, sizeof(Internal), profile::buffered_btree_nodes);
+    root->num_children = 2;
+    root->num_messages = 0;
+    root->children[0] = tree->root;
+    root->children[1] = right;
+    root->pivots[0] = pivot;
+    tree->root = root;
+    ++tree->height;
+}
+
+template <class T, size_t Maximum_Elements, size_t Fanout, size_t Buffer_Size>
+void drop_buffered_node(cz::Allocator allocator, void* node, size_t level) {
+    using Leaf = Buffered_Leaf<T, Maximum_Elements>;
+    using Internal = Buffered_Internal<T, Fanout, Buffer_Size>;
+
+    TracyFreeN(node, profile::buffered_btree_nodes);
+
+    if (level == 0) {
+        allocator.dealloc((Leaf*)node);
+        return;
+    }
+
+    Internal* internal = (Internal*)node;
+    for (size_t i = 0; i < internal->num_children; ++i) {
+        drop_buffered_node<T, Maximum_Elements, Fanout, Buffer_Size>(
+            allocator, internal->children[i], level - 1);
+    }
+    allocator.dealloc(internal);
+}
+
+}
+
+template <class T, size_t Maximum_Elements, size_t Fanout, size_t Buffer_Size>
+void Buffered_Tree<T, Maximum_Elements, Fanout, Buffer_Size>::drop(cz::Allocator allocator) {
+    ZoneScoped;
+    if (root) {
+        detail::drop_buffered_node<T, Maximum_Elements, Fanout, Buffer_Size>(allocator, root,
+                                                                             height - 1);
+    }
+}
+
+template <class T, size_t Maximum_Elements, size_t Fanout, size_t Buffer_Size>
+void Buffered_Tree<T, Maximum_Elements, Fanout, Buffer_Size>::write(cz::Allocator allocator,
+                                                                     const T& element,
+                                                                     bool remove) {
+    ZoneScoped;
+
+    if (!root) {
+        if (remove)
+            return;
+        Leaf* leaf = allocator.alloc<Leaf>();
+        CZ_ASSERT(leaf);
+        TracyAllocN(leaf, sizeof(Leaf), profile::buffered_btree_nodes);
+        leaf->num_elements = 0;
+        root = leaf;
+        height = 1;
+    }
+
+    // Small trees are just a leaf and don't buffer.
+    if (height == 1) {
+        Leaf* right =
+            detail::apply_messages(allocator, (Leaf*)root, &element, &remove, 1, &count);
+        if (right)
+            detail::grow_root(this, allocator, right, right->elements[0]);
+        TracyPlot(profile::buffered_btree_count, (int64_t)count);
+        return;
+    }
+
+    Internal* node = (Internal*)root;
+    while (node->num_messages == Buffer_Size) {
+        detail::flush_once(this, allocator, node, height - 1);
+        if (node->num_children > Fanout) {
+            T pivot;
+            Internal* right = detail::split_internal(allocator, node, &pivot);
+            detail::grow_root(this, allocator, right, pivot);
+            node = (Internal*)root;
+        }
+    }
+
+    size_t index = detail::position(node->messages, node->num_messages, element, false);
+    if (index < node->num_messages &&
+        detail::compare_elements(node->messages[index], element) == 0) {
+        node->messages[index] = element;
+        node->removes[index] = remove;
+    } else {
+        for (size_t i = node->num_messages; i > index; --i) {
+            node->messages[i] = node->messages[i - 1];
+            node->removes[i] = node->removes[i - 1];
+        }
+        node->messages[index] = element;
+        node->removes[index] = remove;
+        ++node->num_messages;
+        ++pending;
+    }
+
+    TracyPlot(profile::buffered_btree_count, (int64_t)count);
+    TracyPlot(profile::buffered_btree_pending, (int64_t)pending);
+}
+
+template <class T, size_t Maximum_Elements, size_t Fanout, size_t Buffer_Size>
+void Buffered_Tree<T, Maximum_Elements, Fanout, Buffer_Size>::flush(cz::Allocator allocator) {
+    ZoneScoped;
+
+    if (height <= 1)
+        return;
+
+    while (1) {
+        Internal* node = (Internal*)root;
+        detail::flush_all(this, allocator, node, height - 1);
+        if (node->num_children <= Fanout)
+            break;
+
+        T pivot;
+        Internal* right = detail::split_internal(allocator, node, &pivot);
+        detail::grow_root(this, allocator, right, pivot);
+    }
+
+    TracyPlot(profile::buffered_btree_count, (int64_t)count);
+    TracyPlot(profile::buffered_btree_pending, (int64_t)pending);
+}
+
+namespace detail {
+
+/// A sorted run of elements or messages that are candidates for a range query.
+template <class T>
+struct Candidate_Run {
+    const T* elements;
+    /// `nullptr` for the elements of a leaf.
+    const bool* removes;
+    size_t start;
+    size_t end;
+};
+
+/// Find the first live element in a leaf on the requested side of `element`.  The messages
+/// in the buffers on the path to the leaf are merged with its elements.  Messages in
+/// higher buffers are newer and override lower ones and the leaf.
+template <class T, size_t Maximum_Elements, size_t Fanout, size_t Buffer_Size>
+const T* find_live_in_leaf(const Buffered_Leaf<T, Maximum_Elements>* leaf,
+                           const T* low,
+                           const T* high,
+                           const Buffered_Internal<T, Fanout, Buffer_Size>* const* path,
+                           size_t depth,
+                           const T& element,
+                           bool forward,
+                           bool inclusive) {
+    Candidate_Run<T> runs[Buffered_Tree<T, Maximum_Elements, Fanout, Buffer_Size>::MAXIMUM_HEIGHT];
+    for (size_t i = 0; i < depth; ++i) {
+        const Buffered_Internal<T, Fanout, Buffer_Size>* node = path[i];
+        Candidate_Run<T>& run = runs[i];
+        run.elements = node->messages;
+        run.removes = node->removes;
+        run.start = low ? position(node->messages, node->num_messages, *low, false) : 0;
+        run.end = high ? position(node->messages, node->num_messages, *high, false)
+                       : node->num_messages;
+    }
+    runs[depth] = {leaf->elements, nullptr, 0, leaf->num_elements};
+
+    for (size_t i = 0; i < depth + 1; ++i) {
+        Candidate_Run<T>& run = runs[i];
+        size_t bound = position(run.elements + run.start, run.end - run.start, element,
+                                forward ? !inclusive : inclusive) +
+                       run.start;
+        if (forward) {
+            run.start = bound;
+        } else {
+            run.end = bound;
+        }
+    }
+
+    while (1) {
+        const T* next = nullptr;
+        for (size_t i = 0; i < depth + 1; ++i) {
+            const Candidate_Run<T>& run = runs[i];
+            if (run.start == run.end)
+                continue;
+            const T* head = forward ? &run.elements[run.start] : &run.elements[run.end - 1];
+            if (!next) {
+                next = head;
+                continue;
+            }
+            int64_t comparison = compare_elements(*head, *next);
+            if (forward ? comparison < 0 : comparison > 0)
+                next = head;
+        }
+
+        if (!next)
+            return nullptr;
+
+        // The first run that has `next` is the newest so it decides if `next` is live.
+        const T* live = nullptr;
+        bool decided = false;
+        for (size_t i = 0; i < depth + 1; ++i) {
+            Candidate_Run<T>& run = runs[i];
+            if (run.start == run.end)
+                continue;
+            size_t index = forward ? run.start : run.end - 1;
+            if (compare_elements(run.elements[index], *next) != 0)
+                continue;
+
+            if (!decided) {
+                decided = true;
+                if (!run.removes || !run.removes[index])
+                    live = &run.elements[index];
+            }
+            if (forward) {
+                ++run.start;
+            } else {
+                --run.end;
+            }
+        }
+
+        if (live)
+            return live;
+    }
+}
+
+template <class T, size_t Maximum_Elements, size_t Fanout, size_t Buffer_Size>
+const T* find_live(const void* node,
+                   size_t level,
+                   const T* low,
+                   const T* high,
+                   const Buffered_Internal<T, Fanout, Buffer_Size>** path,
+                   size_t depth,
+                   const T& element,
+                   bool forward,
+                   bool inclusive) {
+    using Leaf = Buffered_Leaf<T, Maximum_Elements>;
+    using Internal = Buffered_Internal<T, Fanout, Buffer_Size>;
+
+    if (level == 0) {
+        return find_live_in_leaf<T, Maximum_Elements, Fanout, Buffer_Size>(
+            (const Leaf*)node, low, high, path, depth, element, forward, inclusive);
+    }
+
+    const Internal* internal = (const Internal*)node;
+    path[depth] = internal;
+
+    // Start in the child that would hold `element` and move outwards
+    // until a child has a live element on the requested side.
+    size_t first = child_index(internal, element);
+    size_t children = forward ? internal->num_children - first : first + 1;
+    for (size_t i = 0; i < children; ++i) {
+        size_t index = forward ? first + i : first - i;
+        const T* child_low = index > 0 ? &internal->pivots[index - 1] : low;
+        const T* child_high = index + 1 < internal->num_children ? &internal->pivots[index] : high;
+        const T* result = find_live<T, Maximum_Elements, Fanout, Buffer_Size>(
+            internal->children[index], level - 1, child_low, child_high, path, depth + 1,
+            element, forward, inclusive);
+        if (result)
+            return result;
+    }
+    return nullptr;
+}
+
+template <class T, size_t Maximum_Elements, size_t Fanout, size_t Buffer_Size>
+const T* find_live(const Buffered_Tree<T, Maximum_Elements, Fanout, Buffer_Size>* tree,
+                   const T& element,
+                   bool forward,
+                   bool inclusive) {
+    ZoneScoped;
+
+    if (!tree->root)
+        return nullptr;
+
+    const Buffered_Internal<T, Fanout, Buffer_Size>*
+        path[Buffered_Tree<T, Maximum_Elements, Fanout, Buffer_Size>::MAXIMUM_HEIGHT];
+    return find_live<T, Maximum_Elements, Fanout, Buffer_Size>(
+        tree->root, tree->height - 1, nullptr, nullptr, path, 0, element, forward, inclusive);
+}
+
+}
+
+template <class T, size_t Maximum_Elements, size_t Fanout, size_t Buffer_Size>
+const T* Buffered_Tree<T, Maximum_Elements, Fanout, Buffer_Size>::find_eq(
+    const T& element) const {
+    ZoneScoped;
+
+    if (!root)
+        return nullptr;
+
+    // The first message for the element on the way down is the newest.
+    const void* node = root;
+    for (size_t level = height - 1; level > 0; --level) {
+        const Internal* internal = (const Internal*)node;
+        size_t index;
+        if (internal->num_messages > 0 &&
+            detail::binary_search<T>({internal->messages, internal->num_messages},
+                                     detail::Compare_Against<T>{&element}, &index)) {
+            return internal->removes[index] ? nullptr : &internal->messages[index];
+        }
+        node = internal->children[detail::child_index(internal, element)];
+    }
+
+    const Leaf* leaf = (const Leaf*)node;
+    size_t index;
+    if (leaf->num_elements > 0 &&
+        detail::binary_search<T>({leaf->elements, leaf->num_elements},
+                                 detail::Compare_Against<T>{&element}, &index)) {
+        return &leaf->elements[index];
+    }
+    return nullptr;
+}
+
+template <class T, size_t Maximum_Elements, size_t Fanout, size_t Buffer_Size>
+const T* Buffered_Tree<T, Maximum_Elements, Fanout, Buffer_Size>::find_lt(
+    const T& element) const {
+    return detail::find_live(this, element, /*forward=*/false, /*inclusive=*/false);
+}
+template <class T, size_t Maximum_Elements, size_t Fanout, size_t Buffer_Size>
+const T* Buffered_Tree<T, Maximum_Elements, Fanout, Buffer_Size>::find_gt(
+    const T& element) const {
+    return detail::find_live(this, element, /*forward=*/true, /*inclusive=*/false);
+}
+template <class T, size_t Maximum_Elements, size_t Fanout, size_t Buffer_Size>
+const T* Buffered_Tree<T, Maximum_Elements, Fanout, Buffer_Size>::find_le(
+    const T& element) const {
+    return detail::find_live(this, element, /*forward=*/false, /*inclusive=*/true);
+}
+template <class T, size_t Maximum_Elements, size_t Fanout, size_t Buffer_Size>
+const T* Buffered_Tree<T, Maximum_Elements, Fanout, Buffer_Size>::find_ge(
+    const T& element) const {
+    return detail::find_live(this, element, /*forward=*/true, /*inclusive=*/true);
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cz/allocator.hpp>
+#include "btree.hpp"
+
+namespace ds {
+namespace btree {
+
+/// Fill about a page with messages.  Each message is an element plus a flag.
+template <class T>
+struct Default_Buffer_Size {
+    static const size_t value = (4096 - 2 * sizeof(size_t)) / (sizeof(T) + 1);
+};
+
+/// Leaves of a `Buffered_Tree` only store elements.
+template <class T, size_t Maximum_Elements>
+struct Buffered_Leaf {
+    size_t num_elements;
+    T elements[Maximum_Elements];
+};
+
+/// Internal nodes of a `Buffered_Tree` store pivots and a buffer of messages.
+///
+/// Child `i` holds the elements in `[pivots[i - 1], pivots[i])`.  The children are
+/// `Buffered_Internal`s or `Buffered_Leaf`s depending on the level of the node.
+/// There is room for one more child than `Fanout` so a child can be split before
+/// this node is.
+///
+/// The messages are sorted and there is at most one per element.  They are
+/// newer than every message in this node's descendants.
+template <class T, size_t Fanout, size_t Buffer_Size>
+struct Buffered_Internal {
+    size_t num_children;
+    size_t num_messages;
+    void* children[Fanout + 1];
+    T pivots[Fanout];
+    T messages[Buffer_Size];
+    /// `true` if the message removes its element and `false` if it inserts it.
+    bool removes[Buffer_Size];
+};
+
+/// A write optimized B-tree (a B^epsilon tree).  Internal nodes have a small
+/// fanout and a buffer of pending inserts and removes.  Writes go into the root's
+/// buffer.  When a buffer fills up the messages bound for its busiest child are moved
+/// down a level all at once.  This way a write touches the root and
+/// is then moved down in bulk with other writes, instead of missing the cache at
+/// every level by itself.  This makes random inserts into large trees much faster
+/// than `Tree::insert`.
+///
+/// Lookups check the buffers on the way down to the leaf, so they cost about
+/// the same as `Tree`'s.  Range queries (`find_lt` and friends) have to merge
+/// the buffers with the leaves and skip pending removes, which makes them slower.
+///
+/// Writes are blind: `insert` and `remove` don't check if the element is present.
+/// Because of this, `count` only includes elements that have reached the leaves.
+/// Call `flush` to apply every pending message.
+///
+/// Pivots are copies of elements and don't carry values.  Underfull leaves aren't
+/// merged, but empty leaves are freed.
+///
+/// Elements can't be iterated directly because they may be in any buffer.
+/// Walk the tree with `find_ge` and `find_gt` instead:
+/// ```
+/// for (const T* it = tree.find_ge(first); it; it = tree.find_gt(*it)) {
+/// }
+/// ```
+///
+/// Initialize via `Buffered_Tree<T> tree = {};`.
+template <class T,
+          size_t Maximum_Elements = Default_Maximum_Elements<T>::value,
+          size_t Fanout = 16,
+          size_t Buffer_Size = Default_Buffer_Size<T>::value>
+struct Buffered_Tree {
+    static_assert(Maximum_Elements >= 1, "0 elements doesn't allow insertion");
+    static_assert(Fanout >= 2, "Internal nodes need at least two children");
+    static_assert(Buffer_Size >= 1, "Internal nodes need room for messages");
+    using Leaf = Buffered_Leaf<T, Maximum_Elements>;
+    using Internal = Buffered_Internal<T, Fanout, Buffer_Size>;
+    constexpr static const size_t M = Maximum_Elements;
+
+    /// Enough for any tree that fits in memory.
+    static const size_t MAXIMUM_HEIGHT = 64;
+
+    void drop(cz::Allocator allocator);
+
+    /// Insert the element.  If an equal element is present then it is replaced.
+    void insert(cz::Allocator allocator, const T& element) { write(allocator, element, false); }
+
+    /// Remove the element if it is present.
+    void remove(cz::Allocator allocator, const T& element) { write(allocator, element, true); }
+
+    /// Apply every pending message to the leaves.  Afterwards `count` is exact.
+    void flush(cz::Allocator allocator);
+
+    /// Get the element matching the query or `nullptr` if there is none.
+    /// The result may point into a buffer so it is invalidated by any write.
+    const T* find(const T& element) const { return find_eq(element); }
+    const T* find_eq(const T& element) const;
+    const T* find_lt(const T& element) const;
+    const T* find_gt(const T& element) const;
+    const T* find_le(const T& element) const;
+    const T* find_ge(const T& element) const;
+
+    void write(cz::Allocator allocator, const T& element, bool remove);
+
+    /// A `Leaf` if `height` is 1 and an `Internal` otherwise.
+    void* root;
+    size_t height;
+
+    /// The number of elements in the leaves.
+    uint64_t count;
+    /// The number of messages in buffers.
+    uint64_t pending;
+};
+
+}
+}
+
+#include "buffered_btree.cpp"
@@ -0,0 +1,415 @@
+#ifndef DS_COMPACT_SPLAY_TREE_CPP
+#define DS_COMPACT_SPLAY_TREE_CPP
+
+#include "compact_splay_tree.hpp"
+#include "profile.hpp"
+
+#include <string.h>
+#include <Tracy.hpp>
+#include <cz/compare.hpp>
+#include "gen_tree.hpp"
+
+namespace ds {
+namespace splay {
+
+namespace detail {
+
+/// Top down splay using indices.  See `splay_comparator`.
+/// Returns the new root.  Requires `root != null`.
+template <class T, class Comparator>
+uint32_t compact_splay(Compact_Node<T>* nodes,
+                       uint32_t root,
+                       int64_t* last_comparison,
+                       Comparator&& comparator) {
+    ZoneScoped;
+
+    // `nodes[0]` is the header.  Its right is the root of the left
+    // tree and its left is the root of the right tree.
+    Compact_Node<T>* header = &nodes[0];
+    header->left = 0;
+    header->right = 0;
+    uint32_t left = 0;
+    uint32_t right = 0;
+
+    uint32_t node = root;
+    int64_t comparison = comparator(nodes[node].element);
+    while (1) {
+        if (comparison < 0) {
+            uint32_t child = nodes[node].left;
+            if (!child)
+                break;
+
+            int64_t child_comparison = comparator(nodes[child].element);
+            if (child_comparison < 0) {
+                // Zig-Zig: rotate right.
+                nodes[node].left = nodes[child].right;
+                nodes[child].right = node;
+
+                node = child;
+                comparison = child_comparison;
+                child = nodes[node].left;
+                if (!child)
+                    break;
+                child_comparison = comparator(nodes[child].element);
+            }
+
+            // Link right.
+            nodes[right].left = node;
+            right = node;
+            node = child;
+            comparison = child_comparison;
+        } else if (comparison > 0) {
+            uint32_t child = nodes[node].right;
+            if (!child)
+                break;
+
+            int64_t child_comparison = comparator(nodes[child].element);
+            if (child_comparison > 0) {
+                // Zag-Zag: rotate left.
+                nodes[node].right = nodes[child].left;
+                nodes[child].left = node;
+
+                node = child;
+                comparison = child_comparison;
+                child = nodes[node].right;
+                if (!child)
+                    break;
+                child_comparison = comparator(nodes[child].element);
+            }
+
+            // Link left.
+            nodes[left].right = node;
+            left = node;
+            node = child;
+            comparison = child_comparison;
+        } else {
+            break;
+        }
+    }
+
+    // Assemble.
+    nodes[left].right = nodes[node].left;
+    nodes[right].left = nodes[node].right;
+    nodes[node].left = header->right;
+    nodes[node].right = header->left;
+
+    *last_comparison = comparison;
+    return node;
+}
+
+template <class T>
+struct Compact_Rightmost_Comparator {
+    int64_t operator()(const T&) const { return 1; }
+};
+
+template <class T>
+uint32_t compact_leftmost(Compact_Node<T>* nodes, uint32_t node) {
+    while (nodes[node].left)
+        node = nodes[node].left;
+    return node;
+}
+
+template <class T>
+uint32_t compact_rightmost(Compact_Node<T>* nodes, uint32_t node) {
+    while (nodes[node].right)
+        node = nodes[node].right;
+    return node;
+}
+
+/// The ancestors whose left subtrees are being walked during an in order walk.
+/// Shallow paths fit in `inline_entries`.  Splay trees can be arbitrarily deep so
+/// longer paths move into `allocator`, doubling in size each time.
+struct Compact_Path {
+    struct Entry {
+        uint32_t node;
+        uint32_t depth;
+    };
+
+    Entry inline_entries[64];
+    Entry* entries;
+    size_t len;
+    size_t cap;
+
+    void init() {
+        entries = inline_entries;
+        len = 0;
+        cap = sizeof(inline_entries) / sizeof(inline_entries[0]);
+    }
+
+    void drop(cz::Allocator allocator) {
+        if (entries != inline_entries)
+            allocator.dealloc(entries, cap);
+    }
+
+    void push(cz::Allocator allocator, uint32_t node, uint32_t depth) {
+        if (len == cap) {
+            Entry* new_entries;
+            if (entries == inline_entries) {
+                new_entries = allocator.alloc<Entry>(cap * 2);
+                CZ_ASSERT(new_entries);
+                memcpy(new_entries, entries, len * sizeof(Entry));
+            } else {
+                new_entries = allocator.realloc(entries, cap, cap * 2);
+                CZ_ASSERT(new_entries);
+            }
+            entries = new_entries;
+            cap *= 2;
+        }
+        entries[len++] = {node, depth};
+    }
+};
+
+/// Walk the tree in order calling `visit(node, depth)` where the root is at depth 1.
+/// There are no parent links so the path is kept in a `Compact_Path`.
+template <class T, class Visit>
+void compact_walk(cz::Allocator allocator,
+                  const Compact_Node<T>* nodes,
+                  uint32_t root,
+                  Visit&& visit) {
+    Compact_Path path;
+    path.init();
+
+    uint32_t node = root;
+    uint32_t depth = 1;
+    while (1) {
+        for (; node; node = nodes[node].left, ++depth) {
+            path.push(allocator, node, depth);
+        }
+
+        if (path.len == 0)
+            break;
+
+        Compact_Path::Entry entry = path.entries[--path.len];
+        visit(entry.node, (size_t)entry.depth);
+        node = nodes[entry.node].right;
+        depth = entry.depth + 1;
+    }
+
+    path.drop(allocator);
+}
+
+struct Compact_Stats_Visitor {
+    gen::Tree_Stats* stats;
+    void operator()(uint32_t, size_t depth) const { stats->add_node(depth); }
+};
+
+template <class T, class Callback>
+struct Compact_Element_Visitor {
+    const Compact_Node<T>* nodes;
+    Callback& callback;
+    void operator()(uint32_t node, size_t) const { callback(nodes[node].element); }
+};
+
+}
+
+template <class T>
+template <class Callback>
+void Compact_Tree<T>::for_each(cz::Allocator allocator, Callback&& callback) const {
+    detail::Compact_Element_Visitor<T, Callback> visitor = {nodes, callback};
+    detail::compact_walk(allocator, nodes, root, visitor);
+}
+
+template <class T>
+void Compact_Tree<T>::drop(cz::Allocator allocator) {
+    if (nodes) {
+        TracyFreeN(nodes, profile::compact_splay_nodes);
+    }
+    allocator.dealloc(nodes, nodes_cap);
+}
+
+template <class T>
+gen::Tree_Stats Compact_Tree<T>::stats(cz::Allocator allocator) const {
+    gen::Tree_Stats stats = {};
+    detail::compact_walk(allocator, nodes, root, detail::Compact_Stats_Visitor{&stats});
+
+    stats.bytes_allocated = (size_t)nodes_cap * sizeof(Compact_Node<T>);
+    stats.bytes_payload = (size_t)num_elements * sizeof(T);
+    return stats;
+}
+
+template <class T>
+void Compact_Tree<T>::reserve(cz::Allocator allocator, size_t extra) {
+    // Reserve one extra for the null node.
+    size_t needed = (size_t)nodes_len + extra + (nodes_len == 0);
+    if (needed <= nodes_cap)
+        return;
+
+    size_t new_cap = (size_t)nodes_cap * 2;
+    if (new_cap < needed)
+        new_cap = needed;
+    if (new_cap < 16)
+        new_cap = 16;
+    if (new_cap > UINT32_MAX)
+        new_cap = UINT32_MAX;
+    CZ_ASSERT(needed <= new_cap);
+
+    Compact_Node<T>* new_nodes = allocator.realloc(nodes, nodes_cap, new_cap);
+    CZ_ASSERT(new_nodes);
+    if (nodes) {
+        TracyFreeN(nodes, profile::compact_splay_nodes);
+    }
+    TracyAllocN(new_nodes, new_cap * sizeof(Compact_Node<T>), profile::compact_splay_nodes);
+    nodes = new_nodes;
+    nodes_cap = (uint32_t)new_cap;
+}
+
+template <class T>
+bool Compact_Tree<T>::insert(cz::Allocator allocator, const T& element) {
+    ZoneScoped;
+
+    int64_t last_comparison = 0;
+    if (root) {
+        root = detail::compact_splay(nodes, root, &last_comparison,
+                                     gen::element_comparator(element));
+
+        // Already present.
+        if (last_comparison == 0)
+            return false;
+    }
+
+    // Allocate a node.
+    uint32_t node;
+    if (free_list) {
+        node = free_list;
+        free_list = nodes[node].left;
+    } else {
+        reserve(allocator, 1);
+        if (nodes_len == 0)
+            nodes_len = 1;  // Skip the null node.
+        node = nodes_len++;
+    }
+
+    nodes[node].element = element;
+
+    // Split the old root's children around the new node.
+    if (!root) {
+        nodes[node].left = null;
+        nodes[node].right = null;
+    } else if (last_comparison > 0) {
+        nodes[node].left = root;
+        nodes[node].right = nodes[root].right;
+        nodes[root].right = null;
+    } else {
+        nodes[node].left = nodes[root].left;
+        nodes[node].right = root;
+        nodes[root].left = null;
+    }
+
+    root = node;
+    ++num_elements;
+    TracyPlot(profile::compact_splay_count, (int64_t)num_elements);
+    return true;
+}
+
+template <class T>
+bool Compact_Tree<T>::remove(const T& element) {
+    ZoneScoped;
+
+    if (!root)
+        return false;
+
+    int64_t last_comparison;
+    root = detail::compact_splay(nodes, root, &last_comparison, gen::element_comparator(element));
+    if (last_comparison != 0)
+        return false;
+
+    uint32_t node = root;
+    uint32_t left = nodes[node].left;
+    uint32_t right = nodes[node].right;
+    if (left) {
+        // After splaying the maximum to the root it has no right child.
+        root = detail::compact_splay(nodes, left, &last_comparison,
+                                     detail::Compact_Rightmost_Comparator<T>{});
+        nodes[root].right = right;
+    } else {
+        root = right;
+    }
+
+    nodes[node].left = free_list;
+    free_list = node;
+    --num_elements;
+    TracyPlot(profile::compact_splay_count, (int64_t)num_elements);
+    return true;
+}
+
+template <class T>
+T* Compact_Tree<T>::find_equal(const T& query) {
+    if (!root)
+        return nullptr;
+
+    int64_t last_comparison;
+    root = detail::compact_splay(nodes, root, &last_comparison, gen::element_comparator(query));
+    if (last_comparison == 0)
+        return &nodes[root].element;
+    return nullptr;
+}
+
+template <class T>
+T* Compact_Tree<T>::find_less(const T& query) {
+    if (!root)
+        return nullptr;
+
+    int64_t last_comparison;
+    root = detail::compact_splay(nodes, root, &last_comparison, gen::element_comparator(query));
+    if (last_comparison > 0)
+        return &nodes[root].element;
+
+    // The root is the split point so the previous element is the maximum of its left side.
+    uint32_t left = nodes[root].left;
+    if (!left)
+        return nullptr;
+    return &nodes[detail::compact_rightmost(nodes, left)].element;
+}
+
+template <class T>
+T* Compact_Tree<T>::find_greater(const T& query) {
+    if (!root)
+        return nullptr;
+
+    int64_t last_comparison;
+    root = detail::compact_splay(nodes, root, &last_comparison, gen::element_comparator(query));
+    if (last_comparison < 0)
+        return &nodes[root].element;
+
+    uint32_t right = nodes[root].right;
+    if (!right)
+        return nullptr;
+    return &nodes[detail::compact_leftmost(nodes, right)].element;
+}
+
+template <class T>
+T* Compact_Tree<T>::find_less_equal(const T& query) {
+    if (!root)
+        return nullptr;
+
+    int64_t last_comparison;
+    root = detail::compact_splay(nodes, root, &last_comparison, gen::element_comparator(query));
+    if (last_comparison >= 0)
+        return &nodes[root].element;
+
+    uint32_t left = nodes[root].left;
+    if (!left)
+        return nullptr;
+    return &nodes[detail::compact_rightmost(nodes, left)].element;
+}
+
+template <class T>
+T* Compact_Tree<T>::find_greater_equal(const T& query) {
+    if (!root)
+        return nullptr;
+
+    int64_t last_comparison;
+    root = detail::compact_splay(nodes, root, &last_comparison, gen::element_comparator(query));
+    if (last_comparison <= 0)
+        return &nodes[root].element;
+
+    uint32_t right = nodes[root].right;
+    if (!right)
+        return nullptr;
+    return &nodes[detail::compact_leftmost(nodes, right)].element;
+}
+
+}
+}
+
+#endif
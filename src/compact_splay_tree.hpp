@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+#include <cz/allocator.hpp>
+#include "gen_tree.hpp"
+
+namespace ds {
+namespace splay {
+
+/// Links are 32 bit indices into `Compact_Tree::nodes`.  There is no parent
+/// link because top down splaying never walks up the tree.  Index 0 is
+/// reserved to represent null and is used as scratch space while splaying.
+template <class T>
+struct Compact_Node {
+    uint32_t left;
+    uint32_t right;
+    T element;
+};
+
+/// A splay tree whose nodes live in one contiguous array.  Each node has 8
+/// bytes of overhead instead of the 24 bytes of links plus allocator header
+/// of a `gen::Node`, and neighboring nodes share cache lines.
+///
+/// Inserting may reallocate the array so pointers returned by
+/// the `find` methods are invalidated by `insert` and `reserve`.
+template <class T>
+struct Compact_Tree {
+    constexpr static const uint32_t null = 0;
+
+    void drop(cz::Allocator allocator);
+
+    /// Make space for at least `extra` more elements.
+    void reserve(cz::Allocator allocator, size_t extra);
+
+    /// Insert the element into the tree.  If the element already
+    /// is present then does nothing and returns `false`.
+    bool insert(cz::Allocator allocator, const T& element);
+
+    /// Remove the element.  Returns `false` if it was not present.
+    /// The node is put on a free list to be reused by `insert`.
+    bool remove(const T& element);
+
+    /// Get the element based on the position of the query.
+    /// If there are no matches then `nullptr` is returned.
+    /// These methods `splay` so are not const.
+    T* find(const T& query) { return find_equal(query); }
+    T* find_equal(const T& query);
+    T* find_less(const T& query);
+    T* find_greater(const T& query);
+    T* find_less_equal(const T& query);
+    T* find_greater_equal(const T& query);
+
+    bool contains(const T& element) { return find(element) != nullptr; }
+
+    size_t count() const { return num_elements; }
+
+    /// Call `callback` with each element in order.  This does not splay.
+    /// `allocator` holds the path through trees deeper than 64 nodes.
+    template <class Callback>
+    void for_each(cz::Allocator allocator, Callback&& callback) const;
+
+    /// Measure the shape and memory use of the tree.  This walks every node
+    /// in O(n).  `allocator` holds the path through trees deeper than 64 nodes.
+    gen::Tree_Stats stats(cz::Allocator allocator) const;
+
+    Compact_Node<T>* nodes;
+    uint32_t nodes_len;
+    uint32_t nodes_cap;
+    /// Removed nodes chained through `left`.
+    uint32_t free_list;
+    uint32_t root;
+    uint32_t num_elements;
+};
+
+}
+}
+
+#include "compact_splay_tree.cpp"
@@ -0,0 +1,143 @@
+#include "counting_allocator.hpp"
+
+#include <algorithm>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#define DS_RETURN_ADDRESS() _ReturnAddress()
+#else
+#define DS_RETURN_ADDRESS() __builtin_return_address(0)
+#endif
+
+namespace ds {
+
+static_assert((Counting_Allocator::MAX_SITES & (Counting_Allocator::MAX_SITES - 1)) == 0,
+              "MAX_SITES must be a power of two");
+
+static size_t size_bucket(size_t size) {
+    size_t bucket = 0;
+    while (size >>= 1)
+        ++bucket;
+    return bucket;
+}
+
+static void record_site(Counting_Allocator* counter, const void* address, size_t size) {
+    std::lock_guard<std::mutex> lock(counter->sites_mutex);
+
+    // Open addressing with linear probing.  Sites are never removed.
+    size_t mask = Counting_Allocator::MAX_SITES - 1;
+    size_t index = (size_t)(((uintptr_t)address >> 2) * 0x9E3779B97F4A7C15ull) & mask;
+    for (size_t probes = 0; probes < Counting_Allocator::MAX_SITES; ++probes) {
+        Allocation_Site* site = &counter->sites[(index + probes) & mask];
+        if (site->address == address) {
+            ++site->allocations;
+            site->bytes += size;
+            return;
+        }
+        if (!site->address) {
+            site->address = address;
+            site->allocations = 1;
+            site->bytes = size;
+            ++counter->sites_len;
+            return;
+        }
+    }
+
+    ++counter->untracked_sites;
+}
+
+static void add_live(Counting_Allocator* counter, uint64_t size) {
+    uint64_t live = counter->live_bytes.fetch_add(size) + size;
+    uint64_t peak = counter->peak_live_bytes.load();
+    while (live > peak && !counter->peak_live_bytes.compare_exchange_weak(peak, live)) {
+    }
+}
+
+static void* counting_realloc(void* data, cz::MemSlice old_mem, cz::AllocInfo new_info) {
+    Counting_Allocator* counter = (Counting_Allocator*)data;
+    void* result = counter->inner.func(counter->inner.data, old_mem, new_info);
+
+    if (!old_mem.buffer) {
+        if (!result)
+            return result;
+        ++counter->allocations;
+    } else if (new_info.size == 0) {
+        ++counter->deallocations;
+        counter->bytes_deallocated += old_mem.size;
+        counter->live_bytes -= old_mem.size;
+        return result;
+    } else {
+        if (!result)
+            return result;
+        ++counter->reallocations;
+        counter->bytes_deallocated += old_mem.size;
+        counter->live_bytes -= old_mem.size;
+    }
+
+    counter->bytes_allocated += new_info.size;
+    add_live(counter, new_info.size);
+    ++counter->size_histogram[size_bucket(new_info.size)];
+
+    if (counter->track_call_sites)
+        record_site(counter, DS_RETURN_ADDRESS(), new_info.size);
+
+    return result;
+}
+
+cz::Allocator Counting_Allocator::allocator() {
+    return {counting_realloc, this};
+}
+
+Allocation_Counts Counting_Allocator::counts() const {
+    Allocation_Counts counts;
+    counts.allocations = allocations.load();
+    counts.deallocations = deallocations.load();
+    counts.reallocations = reallocations.load();
+    counts.bytes_allocated = bytes_allocated.load();
+    counts.bytes_deallocated = bytes_deallocated.load();
+    counts.live_bytes = live_bytes.load();
+    counts.peak_live_bytes = peak_live_bytes.load();
+    return counts;
+}
+
+void Counting_Allocator::reset() {
+    allocations = 0;
+    deallocations = 0;
+    reallocations = 0;
+    bytes_allocated = 0;
+    bytes_deallocated = 0;
+    live_bytes = 0;
+    peak_live_bytes = 0;
+    for (size_t i = 0; i < SIZE_BUCKETS; ++i) {
+        size_histogram[i] = 0;
+    }
+
+    std::lock_guard<std::mutex> lock(sites_mutex);
+    for (size_t i = 0; i < MAX_SITES; ++i) {
+        sites[i] = {};
+    }
+    sites_len = 0;
+    untracked_sites = 0;
+}
+
+size_t Counting_Allocator::call_sites(Allocation_Site* out, size_t max) {
+    std::lock_guard<std::mutex> lock(sites_mutex);
+
+    size_t len = 0;
+    Allocation_Site found[MAX_SITES];
+    for (size_t i = 0; i < MAX_SITES; ++i) {
+        if (sites[i].address)
+            found[len++] = sites[i];
+    }
+
+    std::sort(found, found + len, [](const Allocation_Site& left, const Allocation_Site& right) {
+        return left.allocations > right.allocations;
+    });
+
+    if (len > max)
+        len = max;
+    std::copy(found, found + len, out);
+    return len;
+}
+
+}
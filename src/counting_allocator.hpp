@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <cz/allocator.hpp>
+
+namespace ds {
+
+/// Totals recorded by a `Counting_Allocator`.  See `Counting_Allocator::counts`.
+struct Allocation_Counts {
+    uint64_t allocations;
+    uint64_t deallocations;
+    /// Calls that resized an existing allocation.
+    uint64_t reallocations;
+
+    uint64_t bytes_allocated;
+    uint64_t bytes_deallocated;
+
+    uint64_t live_bytes;
+    /// The most `live_bytes` has been since the last `reset`.
+    uint64_t peak_live_bytes;
+
+    uint64_t live_allocations() const { return allocations - deallocations; }
+};
+
+/// Allocations made from one place in the code.  See `Counting_Allocator::call_sites`.
+struct Allocation_Site {
+    /// The return address of the call into the allocator.  Resolve it
+    /// with `addr2line` or a debugger.  Only meaningful in optimized builds
+    /// where the `cz::Allocator` helpers are inlined into their callers.
+    const void* address;
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+/// Wraps another allocator and counts the calls and bytes that go through it.
+/// The counters are atomic so one instance can be shared between threads.
+///
+/// ```
+/// Counting_Allocator counter = {};
+/// counter.inner = cz::heap_allocator();
+/// tree.insert(counter.allocator(), 3);
+/// CZ_ASSERT(counter.counts().allocations == 1);
+/// ```
+struct Counting_Allocator {
+    static const size_t SIZE_BUCKETS = 64;
+    static const size_t MAX_SITES = 256;
+
+    /// Get an allocator that counts and then forwards to `inner`.
+    /// The `Counting_Allocator` must outlive it.
+    cz::Allocator allocator();
+
+    Allocation_Counts counts() const;
+
+    /// Zero every counter.  Memory that is still live is forgotten so
+    /// must not be deallocated through this allocator afterwards.
+    void reset();
+
+    /// Copy the call sites with the most allocations into `sites`, most first.
+    /// Returns the number copied.  Requires `track_call_sites`.
+    size_t call_sites(Allocation_Site* sites, size_t max);
+
+    cz::Allocator inner;
+
+    /// If true then allocations are also grouped by where they were made from.  This
+    /// takes a lock on every allocation so is off by default.  Sites past `MAX_SITES`
+    /// are counted in `untracked_sites`.
+    bool track_call_sites;
+
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> deallocations;
+    std::atomic<uint64_t> reallocations;
+    std::atomic<uint64_t> bytes_allocated;
+    std::atomic<uint64_t> bytes_deallocated;
+    std::atomic<uint64_t> live_bytes;
+    std::atomic<uint64_t> peak_live_bytes;
+
+    /// Bucket `i` counts allocations of `[2^i, 2^(i + 1))` bytes.
+    std::atomic<uint64_t> size_histogram[SIZE_BUCKETS];
+
+    std::mutex sites_mutex;
+    Allocation_Site sites[MAX_SITES];
+    size_t sites_len;
+    uint64_t untracked_sites;
+};
+
+}
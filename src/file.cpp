@@ -0,0 +1,137 @@
+#include "file.hpp"
+
+#ifdef _WIN32
+#include <io.h>
+#include <sys/stat.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include <errno.h>
+#include <limits.h>
+
+namespace ds {
+namespace file {
+
+#ifdef _WIN32
+
+bool write_chunks(int fd, cz::Slice<const Chunk> chunks) {
+    for (size_t i = 0; i < chunks.len; ++i) {
+        const char* buffer = (const char*)chunks[i].buffer;
+        size_t len = chunks[i].len;
+        while (len > 0) {
+            unsigned int amount = len > INT_MAX ? INT_MAX : (unsigned int)len;
+            // Writing nothing would loop forever so treat it as a failure.
+            int result = _write(fd, buffer, amount);
+            if (result <= 0)
+                return false;
+            buffer += result;
+            len -= result;
+        }
+    }
+    return true;
+}
+
+bool map(int fd, Mapping* mapping) {
+    struct _stat64 stat;
+    if (_fstat64(fd, &stat) < 0)
+        return false;
+
+    HANDLE file = (HANDLE)_get_osfhandle(fd);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+
+    HANDLE handle = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (!handle)
+        return false;
+
+    void* buffer = MapViewOfFile(handle, FILE_MAP_COPY, 0, 0, (SIZE_T)stat.st_size);
+    CloseHandle(handle);
+    if (!buffer)
+        return false;
+
+    mapping->buffer = buffer;
+    mapping->size = stat.st_size;
+    return true;
+}
+
+void unmap(Mapping mapping) {
+    if (mapping.buffer)
+        UnmapViewOfFile(mapping.buffer);
+}
+
+#else
+
+bool write_chunks(int fd, cz::Slice<const Chunk> chunks) {
+    struct iovec vectors[64];
+    size_t index = 0;
+    size_t offset = 0;
+
+    while (index < chunks.len) {
+        // Batch as many chunks as we can into one call.
+        int count = 0;
+        for (size_t i = index; i < chunks.len && count < 64 && count < IOV_MAX; ++i) {
+            size_t skip = (i == index ? offset : 0);
+            vectors[count].iov_base = (char*)chunks[i].buffer + skip;
+            vectors[count].iov_len = chunks[i].len - skip;
+            ++count;
+        }
+
+        ssize_t result = ::writev(fd, vectors, count);
+        if (result < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        // Advance past the written chunks.  The last one may be partially written.
+        size_t written = result;
+        size_t old_index = index;
+        while (index < chunks.len && written >= chunks[index].len - offset) {
+            written -= chunks[index].len - offset;
+            offset = 0;
+            ++index;
+        }
+        offset += written;
+
+        // Writing nothing (other than empty chunks) would loop forever.
+        if (result == 0 && index == old_index)
+            return false;
+    }
+
+    return true;
+}
+
+bool map(int fd, Mapping* mapping) {
+    struct stat stat;
+    if (::fstat(fd, &stat) < 0)
+        return false;
+
+    if (stat.st_size == 0) {
+        mapping->buffer = nullptr;
+        mapping->size = 0;
+        return true;
+    }
+
+    void* buffer = ::mmap(nullptr, stat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (buffer == MAP_FAILED)
+        return false;
+
+    mapping->buffer = buffer;
+    mapping->size = stat.st_size;
+    return true;
+}
+
+void unmap(Mapping mapping) {
+    if (mapping.buffer)
+        ::munmap(mapping.buffer, mapping.size);
+}
+
+#endif
+
+}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <cz/slice.hpp>
+
+namespace ds {
+namespace file {
+
+struct Chunk {
+    const void* buffer;
+    size_t len;
+};
+
+/// Write all `chunks` in order to `fd`.  Uses vectored writes where
+/// available.  Returns `false` if an error occurred.
+bool write_chunks(int fd, cz::Slice<const Chunk> chunks);
+
+/// A private, copy on write mapping of an entire file.
+struct Mapping {
+    void* buffer;
+    uint64_t size;
+
+    bool contains(const void* pointer) const {
+        return (const char*)pointer >= (const char*)buffer &&
+               (const char*)pointer < (const char*)buffer + size;
+    }
+};
+
+/// Map the entirety of `fd` into memory.  Writes to the mapping
+/// are private and are not written back to the file.
+bool map(int fd, Mapping* mapping);
+void unmap(Mapping mapping);
+
+}
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cz/compare.hpp>
+#include "gen_tree.hpp"
+
+namespace ds {
+namespace gen {
+
+/// An element threaded onto a doubly linked list in sorted order.  Rotations
+/// don't change the order so the links only need to be updated on insert and remove.
+template <class T>
+struct Linked {
+    Node<Linked>* prev;
+    Node<Linked>* next;
+    T element;
+
+    bool operator==(const Linked& other) const { return element == other.element; }
+    bool operator!=(const Linked& other) const { return !(*this == other); }
+    bool operator<(const Linked& other) const { return element < other.element; }
+    bool operator>(const Linked& other) const { return other < *this; }
+    bool operator<=(const Linked& other) const { return !(other < *this); }
+    bool operator>=(const Linked& other) const { return !(*this < other); }
+};
+
+/// Compare only the elements.  This is in `ds::gen` so it is found by argument dependent lookup.
+template <class T>
+int64_t compare(const Linked<T>& left, const Linked<T>& right) {
+    using cz::compare;
+    return compare(left.element, right.element);
+}
+
+/// Compares a query against the element of a `Linked`.
+template <class T>
+struct Linked_Comparator {
+    const T* query;
+    int64_t operator()(const Linked<T>& other) const {
+        using cz::compare;
+        return compare(*query, other.element);
+    }
+};
+
+/// Convenience constructor.
+template <class T>
+Linked_Comparator<T> linked_comparator(const T& query) {
+    return {&query};
+}
+
+/// Iterates through a threaded tree by following the links so both
+/// `++` and `--` are O(1) worst case.  Retreating from the end goes to the
+/// last element so `--end()` works.  Retreating from the start goes to the end.
+template <class T>
+struct Linked_Iterator {
+    bool operator==(Linked_Iterator other) const { return node == other.node; }
+    bool operator!=(Linked_Iterator other) const { return !(*this == other); }
+
+    bool operator<(Linked_Iterator other) const {
+        if (node == nullptr)
+            return false;
+        else if (other.node == nullptr)
+            return true;
+        else
+            return node->element.element < other.node->element.element;
+    }
+    bool operator>(Linked_Iterator other) const { return other < *this; }
+    bool operator<=(Linked_Iterator other) const { return !(other < *this); }
+    bool operator>=(Linked_Iterator other) const { return !(*this < other); }
+
+    Linked_Iterator& operator++() {
+        node = node->element.next;
+        return *this;
+    }
+    Linked_Iterator& operator--() {
+        if (node)
+            node = node->element.prev;
+        else
+            node = *last;
+        return *this;
+    }
+
+    operator Linked_Iterator<const T>() const {
+        return {(Node<Linked<const T> >*)node, (Node<Linked<const T> >* const*)last};
+    }
+
+    T& operator*() const { return node->element.element; }
+    T* operator->() const { return &node->element.element; }
+
+    /// `nullptr` represents the end.
+    Node<Linked<T> >* node;
+
+    /// Points at the container's last node so the end can be retreated from.
+    Node<Linked<T> >* const* last;
+};
+
+}
+}
@@ -19,6 +19,24 @@ struct Map_Pair {
     bool operator>=(const Map_Pair& other) const { return !(*this < other); }
 };
 
+/// Compares a key against the key of a `Map_Pair`.
+template <class Key>
+struct Key_Comparator {
+    const Key* key;
+
+    template <class Value>
+    int64_t operator()(const Map_Pair<Key, Value>& pair) const {
+        using cz::compare;
+        return compare(*key, pair.key);
+    }
+};
+
+/// Convenience constructor.
+template <class Key>
+Key_Comparator<Key> key_comparator(const Key& key) {
+    return {&key};
+}
+
 }
 }
 
@@ -172,12 +172,22 @@ Node_Base* remove(Node_Base* node) {
     return replacement;
 }
 
-size_t count(Node_Base* node) {
+size_t count(Node_Base* root) {
     size_t total = 0;
+    Node_Base* node = leftmost(root);
     while (node) {
-        total += 1;
-        total += count(node->left);
-        node = node->right;
+        ++total;
+
+        if (node->right) {
+            node = leftmost(node->right);
+            continue;
+        }
+
+        // Climb until we come up from a left child.
+        while (node != root && node->parent->right == node) {
+            node = node->parent;
+        }
+        node = (node == root ? nullptr : node->parent);
     }
     return total;
 }
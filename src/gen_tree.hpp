@@ -1,6 +1,8 @@
 #pragma once
 
+#include <Tracy.hpp>
 #include <cz/allocator.hpp>
+#include <cz/slice.hpp>
 
 namespace ds {
 namespace gen {
@@ -32,20 +34,134 @@ Node_Base* node_before(Node_Base*);
 Node_Base* remove(Node_Base*);
 void remove_leaf(Node_Base*);
 
-/// Allow null inputs.
+/// Count the nodes in the subtree.  Uses constant space.  Allow null inputs.
 size_t count(Node_Base*);
 
-template <class T>
-void recursive_dealloc(cz::Allocator allocator, Node<T>* node) {
-    while (1) {
-        if (!node)
-            return;
+/// Nodes that were allocated in blocks instead of individually.  Functions taking
+/// `blocks` only need `contains(node)` and `num_nodes()`.  See `splay::Node_Block`.
+struct No_Blocks {
+    bool contains(const Node_Base*) const { return false; }
+    size_t num_nodes() const { return 0; }
+};
+
+/// Deallocate every node in the subtree except those inside `blocks`.  Left children
+/// are rotated up as they are encountered so this uses constant space even for
+/// degenerate trees.  Each freed node is reported to the Tracy memory pool `pool`.
+/// Allow null inputs.
+template <class Tree_Node, class Blocks>
+void recursive_dealloc(cz::Allocator allocator,
+                       Tree_Node* node,
+                       const Blocks& blocks,
+                       const char* pool) {
+    while (node) {
+        Tree_Node* left = (Tree_Node*)node->left;
+        if (left) {
+            // Rotate right without fixing parents since they are all about to be freed.
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            Tree_Node* right = (Tree_Node*)node->right;
+            if (!blocks.contains(node)) {
+                TracyFreeN(node, pool);
+                allocator.dealloc(node);
+            }
+            node = right;
+        }
+    }
+}
+
+template <class Tree_Node>
+void recursive_dealloc(cz::Allocator allocator, Tree_Node* node, const char* pool) {
+    recursive_dealloc(allocator, node, No_Blocks{}, pool);
+}
+
+/// The shape and memory use of a binary tree.  See `measure`.
+struct Tree_Stats {
+    static const size_t LEVELS = 64;
+
+    size_t nodes;
+
+    /// The number of levels.  An empty tree has height 0.
+    size_t height;
+
+    /// The sum of the depths of every node, where the root is at depth 1.
+    uint64_t total_depth;
+
+    /// The number of nodes at each depth, starting at the root.  Nodes
+    /// deeper than `LEVELS` are all counted in the last entry.
+    size_t nodes_per_level[LEVELS];
+
+    /// Bytes of nodes allocated versus bytes of elements stored in them.
+    size_t bytes_allocated;
+    size_t bytes_payload;
 
-        recursive_dealloc(allocator, (Node<T>*)node->left);
-        Node<T>* right = (Node<T>*)node->right;
-        allocator.dealloc(node);
-        node = right;
+    /// Count a node at `depth`.
+    void add_node(size_t depth) {
+        ++nodes;
+        total_depth += depth;
+        if (depth > height)
+            height = depth;
+        ++nodes_per_level[depth <= LEVELS ? depth - 1 : LEVELS - 1];
     }
+
+    double average_depth() const { return nodes ? (double)total_depth / nodes : 0; }
+    double efficiency() const {
+        return bytes_allocated ? (double)bytes_payload / bytes_allocated : 1;
+    }
+};
+
+/// Measure the tree.  Nodes inside `blocks` are counted as part of the blocks'
+/// allocations rather than individually.  Walks the tree in constant space.
+/// Allow null inputs.
+template <class Tree_Node, class Blocks>
+Tree_Stats measure(Tree_Node* root, const Blocks& blocks) {
+    Tree_Stats stats = {};
+    size_t in_block = 0;
+
+    Node_Base* node = root;
+    size_t depth = 1;
+    while (node) {
+        stats.add_node(depth);
+        if (blocks.contains(node))
+            ++in_block;
+
+        if (node->left) {
+            node = node->left;
+            ++depth;
+            continue;
+        }
+        if (node->right) {
+            node = node->right;
+            ++depth;
+            continue;
+        }
+
+        // Climb until we come up from a left child that has a right sibling.
+        while (1) {
+            if (node == root) {
+                node = nullptr;
+                break;
+            }
+            Node_Base* parent = node->parent;
+            --depth;
+            if (parent->left == node && parent->right) {
+                node = parent->right;
+                ++depth;
+                break;
+            }
+            node = parent;
+        }
+    }
+
+    stats.bytes_allocated = (stats.nodes - in_block + blocks.num_nodes()) * sizeof(Tree_Node);
+    stats.bytes_payload = stats.nodes * sizeof(root->element);
+    return stats;
+}
+
+template <class Tree_Node>
+Tree_Stats measure(Tree_Node* root) {
+    return measure(root, No_Blocks{});
 }
 
 template <class T>
@@ -69,9 +185,9 @@ struct Iterator {
         node = (Node<T>*)node_after(node);
         return *this;
     }
+    /// Retreating from `end` does nothing because the iterator doesn't know the
+    /// tree.  Use `splay::Linked_Tree` if you need `--end()` or O(1) steps.
     Iterator& operator--() {
-        // TODO: deal with retreating from start?
-        // TODO: deal with retreating from end doing nothing!
         node = (Node<T>*)node_before(node);
         return *this;
     }
@@ -84,22 +200,46 @@ struct Iterator {
     Node<T>* node;
 };
 
+/// Validate the subtree's parent pointers and ordering.  Walks the tree
+/// iteratively, checking each parent pointer before following it.
 template <class T>
-void val_node(Node<T>* node, Node<T>* parent) {
-    if (!node)
+void val_node(Node<T>* root, Node<T>* parent) {
+    if (!root)
         return;
 
-    val_node((Node<T>*)node->left, node);
-    val_node((Node<T>*)node->right, node);
-
-    CZ_ASSERT(node->parent == parent);
+    CZ_ASSERT(root->parent == parent);
 
     using cz::compare;
-    if (node->left) {
-        CZ_ASSERT(((Node<T>*)node->left)->element < node->element);
-    }
-    if (node->right) {
-        CZ_ASSERT(((Node<T>*)node->right)->element > node->element);
+    Node_Base* node = root;
+    bool descend = true;
+    while (1) {
+        if (descend) {
+            while (node->left) {
+                CZ_ASSERT(node->left->parent == node);
+                node = node->left;
+            }
+        }
+
+        Node<T>* current = (Node<T>*)node;
+        if (current->left) {
+            CZ_ASSERT(((Node<T>*)current->left)->element < current->element);
+        }
+        if (current->right) {
+            CZ_ASSERT(((Node<T>*)current->right)->element > current->element);
+            CZ_ASSERT(current->right->parent == current);
+            node = current->right;
+            descend = true;
+            continue;
+        }
+
+        // Climb until we come up from a left child.
+        while (node != root && node->parent->right == node) {
+            node = node->parent;
+        }
+        if (node == root)
+            return;
+        node = node->parent;
+        descend = false;
     }
 }
 
@@ -117,12 +257,19 @@ Element_Comparator<T> element_comparator(const T& element) {
     return {&element};
 }
 
+/// Same as `find_comparator` except also stores the depth of the node found
+/// (where the root is at depth 1) in `depth`.
 template <class T, class Comparator>
-Node<T>* find_comparator(Node<T>* root, int64_t* last_comparison, Comparator&& comparator) {
+Node<T>* find_comparator_depth(Node<T>* root,
+                               int64_t* last_comparison,
+                               size_t* depth,
+                               Comparator&& comparator) {
     Node<T>* parent = nullptr;
     Node<T>* node = root;
     int64_t comparison = 0;
+    size_t levels = 0;
     while (node) {
+        ++levels;
         gen::Node_Base* new_node = nullptr;
 
         comparison = comparator(node->element);
@@ -139,14 +286,126 @@ Node<T>* find_comparator(Node<T>* root, int64_t* last_comparison, Comparator&& c
     }
 
     *last_comparison = comparison;
+    *depth = levels;
     return parent;
 }
 
+template <class T, class Comparator>
+Node<T>* find_comparator(Node<T>* root, int64_t* last_comparison, Comparator&& comparator) {
+    size_t depth;
+    return find_comparator_depth(root, last_comparison, &depth, comparator);
+}
+
+/// Same as `find_comparator` except the search starts at `finger` instead of the root.
+/// Climbs only until an ancestor bounds the query on the far side and then
+/// descends, so searching near `finger` is cheap regardless of the tree's size.
+/// Stores the number of nodes visited in `steps`.  Requires non-null `finger`.
+template <class T, class Comparator>
+Node<T>* find_from_comparator(Node<T>* finger,
+                              int64_t* last_comparison,
+                              size_t* steps,
+                              Comparator&& comparator) {
+    int64_t comparison = comparator(finger->element);
+    if (comparison == 0) {
+        *last_comparison = 0;
+        *steps = 1;
+        return finger;
+    }
+
+    size_t visited = 1;
+    Node_Base* node = finger;
+    while (node->parent) {
+        Node_Base* parent = node->parent;
+        // Ancestors on the other side of `finger` from the query can be skipped.
+        if ((parent->left == node) == (comparison > 0)) {
+            ++visited;
+            int64_t parent_comparison = comparator(((Node<T>*)parent)->element);
+            if (parent_comparison == 0) {
+                *last_comparison = 0;
+                *steps = visited;
+                return (Node<T>*)parent;
+            }
+            // `parent` is between `finger` and the query so the query is in `node`'s subtree.
+            if ((parent_comparison > 0) != (comparison > 0))
+                break;
+        }
+        node = parent;
+    }
+
+    size_t depth;
+    Node<T>* result = find_comparator_depth((Node<T>*)node, last_comparison, &depth, comparator);
+    *steps = visited + depth;
+    return result;
+}
+
 template <class T>
 Node<T>* find(Node<T>* root, int64_t* last_comparison, const T& element) {
     return find_comparator(root, last_comparison, element_comparator(element));
 }
 
+/// Given the last node visited by a search and the last comparison
+/// against it, select the node the `find_*` family should return.
+/// Returns an iterator to `nullptr` if there is no match.
+///
+/// No special casing is needed at the start of the tree
+/// because `node_before(leftmost(root)) == nullptr`.
+template <class T, class Comparator>
+Iterator<T> select_equal(Iterator<T> iterator, int64_t last_comparison, Comparator&& comparator) {
+    if (last_comparison == 0) {
+        return iterator;
+    } else {
+        return Iterator<T>{nullptr};
+    }
+}
+template <class T, class Comparator>
+Iterator<T> select_less(Iterator<T> iterator, int64_t last_comparison, Comparator&& comparator) {
+    if (last_comparison > 0) {
+        return iterator;
+    } else {
+        --iterator;
+        CZ_DEBUG_ASSERT(iterator.node == nullptr || comparator(*iterator) > 0);
+        return iterator;
+    }
+}
+template <class T, class Comparator>
+Iterator<T> select_greater(Iterator<T> iterator, int64_t last_comparison, Comparator&& comparator) {
+    if (last_comparison < 0) {
+        return iterator;
+    } else if (iterator.node == nullptr) {
+        return iterator;
+    } else {
+        ++iterator;
+        CZ_DEBUG_ASSERT(iterator.node == nullptr || comparator(*iterator) < 0);
+        return iterator;
+    }
+}
+template <class T, class Comparator>
+Iterator<T> select_less_equal(Iterator<T> iterator,
+                              int64_t last_comparison,
+                              Comparator&& comparator) {
+    if (last_comparison >= 0) {
+        return iterator;
+    } else {
+        --iterator;
+        CZ_DEBUG_ASSERT(iterator.node == nullptr || comparator(*iterator) > 0);
+        return iterator;
+    }
+}
+template <class T, class Comparator>
+Iterator<T> select_greater_equal(Iterator<T> iterator,
+                                 int64_t last_comparison,
+                                 Comparator&& comparator) {
+    if (last_comparison <= 0) {
+        return iterator;
+    } else if (iterator.node == nullptr) {
+        return iterator;
+    } else {
+        ++iterator;
+        CZ_DEBUG_ASSERT(iterator.node == nullptr || comparator(*iterator) < 0);
+        return iterator;
+    }
+}
+
 }
 }
 
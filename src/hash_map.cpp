@@ -0,0 +1,326 @@
+#ifndef DS_HASH_MAP_CPP
+#define DS_HASH_MAP_CPP
+
+#include "hash_map.hpp"
+#include "profile.hpp"
+
+#include <string.h>
+#include <Tracy.hpp>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace ds {
+namespace hash {
+
+namespace detail {
+
+#ifdef DS_HASH_MAP_SSE2
+
+inline Group::Group(const int8_t* pointer) {
+    control = _mm_loadu_si128((const __m128i*)pointer);
+}
+
+inline uint32_t Group::match(int8_t h2) const {
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(h2)));
+}
+
+inline uint32_t Group::match_empty() const {
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(control, _mm_set1_epi8(EMPTY)));
+}
+
+inline uint32_t Group::match_empty_or_deleted() const {
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(SENTINEL), control));
+}
+
+#else
+
+inline Group::Group(const int8_t* pointer) {
+    memcpy(control, pointer, SIZE);
+}
+
+inline uint32_t Group::match(int8_t h2) const {
+    uint32_t bits = 0;
+    for (size_t i = 0; i < SIZE; ++i) {
+        bits |= (uint32_t)(control[i] == h2) << i;
+    }
+    return bits;
+}
+
+inline uint32_t Group::match_empty() const {
+    return match(EMPTY);
+}
+
+inline uint32_t Group::match_empty_or_deleted() const {
+    uint32_t bits = 0;
+    for (size_t i = 0; i < SIZE; ++i) {
+        bits |= (uint32_t)(control[i] < SENTINEL) << i;
+    }
+    return bits;
+}
+
+#endif
+
+/// Index of the lowest set bit.  Requires non-zero input.
+inline size_t lowest_bit(uint32_t bits) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return index;
+#else
+    return __builtin_ctz(bits);
+#endif
+}
+
+/// The number of unset bits below the lowest and above the highest set bit of a group mask.
+inline size_t trailing_unset(uint32_t bits) {
+    return bits ? lowest_bit(bits) : Group::SIZE;
+}
+inline size_t leading_unset(uint32_t bits) {
+    size_t count = 0;
+    for (uint32_t bit = 1u << (Group::SIZE - 1); bit && !(bits & bit); bit >>= 1) {
+        ++count;
+    }
+    return count;
+}
+
+/// The most pairs a table can hold before it must grow.  Keeping an
+/// eighth of the slots empty guarantees every probe sequence terminates.
+inline size_t max_load(size_t capacity) {
+    return capacity - capacity / 8;
+}
+
+/// The bytes of control bytes before the slots.
+template <class Pair>
+size_t control_bytes(size_t capacity) {
+    size_t bytes = capacity + Group::SIZE;
+    return (bytes + alignof(Pair) - 1) / alignof(Pair) * alignof(Pair);
+}
+
+template <class Pair>
+size_t table_bytes(size_t capacity) {
+    return control_bytes<Pair>(capacity) + capacity * sizeof(Pair);
+}
+
+/// Walk the groups a key with this hash may be in.  Groups are visited
+/// with a triangular stride, which reaches every group exactly once
+/// because the number of slots is a power of two.
+struct Probe {
+    size_t mask;
+    size_t offset;
+    size_t stride;
+
+    Probe(uint64_t hash, size_t mask) : mask(mask), offset((size_t)(hash >> 7) & mask), stride(0) {}
+
+    size_t index(size_t bit) const { return (offset + bit) & mask; }
+    void next() {
+        stride += Group::SIZE;
+        offset = (offset + stride) & mask;
+    }
+};
+
+inline int8_t h2(uint64_t hash) {
+    return (int8_t)(hash & 0x7f);
+}
+
+/// Set the control byte of a slot and of its mirror after the sentinel.
+inline void set_control(int8_t* control, size_t capacity, size_t index, int8_t value) {
+    control[index] = value;
+    if (index < Group::SIZE - 1)
+        control[capacity + 1 + index] = value;
+}
+
+/// Find the first empty or deleted slot a key with this hash can go in.
+inline size_t find_free(const int8_t* control, size_t capacity, uint64_t hash) {
+    Probe probe(hash, capacity);
+    while (1) {
+        uint32_t free = Group(control + probe.offset).match_empty_or_deleted();
+        if (free)
+            return probe.index(lowest_bit(free));
+        probe.next();
+    }
+}
+
+/// Find the index of the slot holding `key` or `capacity` if there is no match.
+template <class Key, class Value>
+size_t find_index(const Map<Key, Value>* map, const Key& key, uint64_t hash) {
+    if (map->num_elements == 0)
+        return map->capacity;
+
+    Probe probe(hash, map->capacity);
+    while (1) {
+        Group group(map->control + probe.offset);
+        for (uint32_t bits = group.match(h2(hash)); bits; bits &= bits - 1) {
+            size_t index = probe.index(lowest_bit(bits));
+            if (map->slots[index].key == key)
+                return index;
+        }
+
+        // Inserts fill the first free slot so the key would be before any empty slot.
+        if (group.match_empty())
+            return map->capacity;
+        probe.next();
+    }
+}
+
+/// Move every pair into a new table with `new_capacity` slots.  This also clears deleted slots.
+template <class Key, class Value>
+void rehash(Map<Key, Value>* map, cz::Allocator allocator, size_t new_capacity) {
+    ZoneScoped;
+
+    using Pair = gen::Map_Pair<Key, Value>;
+
+    size_t bytes = table_bytes<Pair>(new_capacity);
+    int8_t* control = (int8_t*)allocator.alloc({bytes, alignof(Pair)});
+    CZ_ASSERT(control);
+    TracyAllocN(control, bytes, profile::hash_map_tables);
+    Pair* slots = (Pair*)(control + control_bytes<Pair>(new_capacity));
+
+    memset(control, EMPTY, new_capacity + Group::SIZE);
+    control[new_capacity] = SENTINEL;
+
+    for (size_t i = 0; i < map->capacity; ++i) {
+        if (map->control[i] < 0)
+            continue;
+
+        uint64_t hash = hash_key(map->slots[i].key);
+        size_t index = find_free(control, new_capacity, hash);
+        set_control(control, new_capacity, index, h2(hash));
+        slots[index] = map->slots[i];
+    }
+
+    if (map->control) {
+        TracyFreeN(map->control, profile::hash_map_tables);
+        allocator.dealloc({map->control, table_bytes<Pair>(map->capacity)});
+    }
+
+    map->control = control;
+    map->slots = slots;
+    map->capacity = new_capacity;
+    map->growth_left = max_load(new_capacity) - map->num_elements;
+}
+
+}
+
+template <class Key, class Value>
+void Map<Key, Value>::drop(cz::Allocator allocator) {
+    if (control) {
+        TracyFreeN(control, profile::hash_map_tables);
+        allocator.dealloc({control, detail::table_bytes<Pair>(capacity)});
+    }
+}
+
+template <class Key, class Value>
+void Map<Key, Value>::reserve(cz::Allocator allocator, size_t extra) {
+    size_t needed = num_elements + extra;
+    if (needed <= num_elements + growth_left)
+        return;
+
+    size_t new_capacity = capacity ? capacity : detail::Group::SIZE - 1;
+    while (detail::max_load(new_capacity) < needed) {
+        new_capacity = new_capacity * 2 + 1;
+    }
+    detail::rehash(this, allocator, new_capacity);
+}
+
+template <class Key, class Value>
+bool Map<Key, Value>::insert(cz::Allocator allocator, const Pair& pair) {
+    uint64_t hash = hash_key(pair.key);
+    if (detail::find_index(this, pair.key, hash) != capacity)
+        return false;
+
+    size_t index = capacity ? detail::find_free(control, capacity, hash) : 0;
+    if (growth_left == 0 && (capacity == 0 || control[index] != detail::DELETED)) {
+        // Clear out deleted slots if they make up a large part of the table.
+        size_t new_capacity;
+        if (capacity == 0) {
+            new_capacity = detail::Group::SIZE - 1;
+        } else if (num_elements <= capacity / 2) {
+            new_capacity = capacity;
+        } else {
+            new_capacity = capacity * 2 + 1;
+        }
+        detail::rehash(this, allocator, new_capacity);
+        index = detail::find_free(control, capacity, hash);
+    }
+
+    if (control[index] == detail::EMPTY)
+        --growth_left;
+    detail::set_control(control, capacity, index, detail::h2(hash));
+    slots[index] = pair;
+    ++num_elements;
+    TracyPlot(profile::hash_map_count, (int64_t)num_elements);
+    return true;
+}
+
+namespace detail {
+template <class Key, class Value>
+void remove_index(Map<Key, Value>* map, size_t index) {
+    // If the slot is inside a run of fewer than `Group::SIZE` full or deleted
+    // slots then no probe for another key can have passed over it, so it
+    // can become empty instead of deleted and be reused by any insert.
+    size_t before = (index - Group::SIZE) & map->capacity;
+    uint32_t empty_before = Group(map->control + before).match_empty();
+    uint32_t empty_after = Group(map->control + index).match_empty();
+    bool was_never_full = empty_before && empty_after &&
+                          leading_unset(empty_before) + trailing_unset(empty_after) < Group::SIZE;
+
+    set_control(map->control, map->capacity, index, was_never_full ? EMPTY : DELETED);
+    if (was_never_full)
+        ++map->growth_left;
+    --map->num_elements;
+    TracyPlot(profile::hash_map_count, (int64_t)map->num_elements);
+}
+}
+
+template <class Key, class Value>
+void Map<Key, Value>::remove(cz::Allocator allocator, Iterator<const Pair> iterator) {
+    if (iterator == end())
+        return;
+    detail::remove_index(this, iterator.slot - slots);
+}
+
+template <class Key, class Value>
+bool Map<Key, Value>::remove(cz::Allocator allocator, const Key& key) {
+    size_t index = detail::find_index(this, key, hash_key(key));
+    if (index == capacity)
+        return false;
+    detail::remove_index(this, index);
+    return true;
+}
+
+template <class Key, class Value>
+Iterator<gen::Map_Pair<Key, Value> > Map<Key, Value>::start() {
+    size_t index = 0;
+    while (index < capacity && control[index] < detail::SENTINEL) {
+        ++index;
+    }
+    return {control + index, slots + index};
+}
+
+template <class Key, class Value>
+Iterator<const gen::Map_Pair<Key, Value> > Map<Key, Value>::start() const {
+    size_t index = 0;
+    while (index < capacity && control[index] < detail::SENTINEL) {
+        ++index;
+    }
+    return {control + index, slots + index};
+}
+
+template <class Key, class Value>
+Iterator<gen::Map_Pair<Key, Value> > Map<Key, Value>::find(const Key& key) {
+    size_t index = detail::find_index(this, key, hash_key(key));
+    return {control + index, slots + index};
+}
+
+template <class Key, class Value>
+Iterator<const gen::Map_Pair<Key, Value> > Map<Key, Value>::find(const Key& key) const {
+    size_t index = detail::find_index(this, key, hash_key(key));
+    return {control + index, slots + index};
+}
+
+}
+}
+
+#endif
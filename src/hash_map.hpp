@@ -0,0 +1,153 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+#include <cz/allocator.hpp>
+#include "gen_map.hpp"
+#include "ssostr.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DS_HASH_MAP_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace ds {
+namespace hash {
+
+/// Hash a key for `Map`.  Overload `hash_key` in the key's namespace to
+/// support other key types.  The low 7 bits are stored in the control bytes
+/// and the rest select the group so every bit must be well mixed.
+template <class Integer>
+typename std::enable_if<std::is_integral<Integer>::value, uint64_t>::type hash_key(Integer key) {
+    // Murmur3's finalizer.
+    uint64_t hash = (uint64_t)key;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+inline uint64_t hash_key(const SSOStr& key) {
+    return key.hash();
+}
+
+namespace detail {
+
+/// Control bytes.  Full slots store the low 7 bits of their hash.
+enum : int8_t {
+    EMPTY = -128,
+    DELETED = -2,
+    /// Marks the end of the table for iteration.
+    SENTINEL = -1,
+};
+
+/// The control bytes of `SIZE` consecutive slots, matched all at once.
+/// Each `match` returns a bit mask where bit `i` is set if slot `i` matches.
+struct Group {
+    static const size_t SIZE = 16;
+
+    explicit Group(const int8_t* control);
+
+    uint32_t match(int8_t h2) const;
+    uint32_t match_empty() const;
+    uint32_t match_empty_or_deleted() const;
+
+#ifdef DS_HASH_MAP_SSE2
+    __m128i control;
+#else
+    int8_t control[SIZE];
+#endif
+};
+
+}
+
+/// Iterates over the full slots in table order, which is unrelated to key order.
+template <class Pair>
+struct Iterator {
+    const int8_t* control;
+    Pair* slot;
+
+    Pair& operator*() const { return *slot; }
+    Pair* operator->() const { return slot; }
+    operator Iterator<const Pair>() const { return {control, slot}; }
+
+    Iterator& operator++() {
+        do {
+            ++control;
+            ++slot;
+        } while (*control < detail::SENTINEL);
+        return *this;
+    }
+
+    bool operator==(const Iterator& other) const { return slot == other.slot; }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+};
+
+/// An open addressing hash map in the style of Abseil's Swiss tables.  Each slot
+/// has a control byte holding 7 bits of its key's hash.  Lookups compare a group
+/// of 16 control bytes with one SSE2 instruction and only compare keys whose
+/// control byte matches, so a `find` usually touches one cache line of control
+/// bytes and one slot.
+///
+/// Keys are hashed with `hash_key` and compared with `==`.  Inserting may move
+/// every pair so iterators and pointers are invalidated by `insert` and `reserve`.
+///
+/// Initialize via `Map<Key, Value> map = {};`.
+template <class Key, class Value>
+struct Map {
+    using Pair = gen::Map_Pair<Key, Value>;
+
+    void drop(cz::Allocator allocator);
+
+    /// Make room for `extra` more pairs without rehashing.
+    void reserve(cz::Allocator allocator, size_t extra);
+
+    /// Insert the pair into the map.  If the key already
+    /// is present then does nothing and returns `false`.
+    bool insert(cz::Allocator allocator, const Key& key, const Value& value) {
+        return insert(allocator, {key, value});
+    }
+    bool insert(cz::Allocator allocator, const Pair& pair);
+
+    /// Remove the pair at the iterator.
+    /// If the iterator is `end` then nothing is done.
+    /// Removing never shrinks the table so the allocator is unused.
+    void remove(cz::Allocator allocator, Iterator<const Pair> iterator);
+
+    /// Remove the pair with the key.  Returns `false` if there is no match.
+    bool remove(cz::Allocator allocator, const Key& key);
+
+    /// Get iterators allowing you to iterate through the entire map.
+    Iterator<Pair> start();
+    Iterator<Pair> end() { return {control + capacity, slots + capacity}; }
+    Iterator<const Pair> start() const;
+    Iterator<const Pair> end() const { return {control + capacity, slots + capacity}; }
+
+    /// Find the pair with the key.  If there is no match then `end` is returned.
+    Iterator<Pair> find(const Key& key);
+    Iterator<const Pair> find(const Key& key) const;
+
+    bool contains(const Key& key) const { return find(key) != end(); }
+
+    size_t count() const { return num_elements; }
+
+    /// `capacity` + 1 + `Group::SIZE - 1` bytes.  `control[capacity]` is `SENTINEL`
+    /// and the bytes after it mirror the first bytes so groups never wrap around.
+    int8_t* control;
+    Pair* slots;
+
+    /// Zero or one less than a power of two so it doubles as the probe mask.
+    size_t capacity;
+    size_t num_elements;
+
+    /// Empty slots that can still be filled before the table must be
+    /// rehashed.  Deleted slots are not counted so they trigger rehashes too.
+    size_t growth_left;
+};
+
+}
+}
+
+#include "hash_map.cpp"
@@ -2,6 +2,11 @@
 #define DS_PAGE_TABLE_CPP
 
 #include "page_table.hpp"
+#include "profile.hpp"
+
+#include <string.h>
+#include <Tracy.hpp>
+#include <type_traits>
 
 namespace ds {
 namespace pt {
@@ -52,75 +57,144 @@ struct Node_Branch {
 
 namespace detail {
 template <class T>
-void drop(void* node, uint8_t depth, cz::Allocator allocator) {
+void drop(void* node, uint8_t depth, cz::Allocator allocator, const file::Mapping& snapshot) {
     if (depth <= 1) {
-        allocator.dealloc((T*)node, Leaf_Elements<T>::value);
+        // Leaves loaded from a snapshot are owned by the mapping.
+        if (!snapshot.contains(node)) {
+            TracyFreeN(node, profile::page_table_nodes);
+            allocator.dealloc((T*)node, Leaf_Elements<T>::value);
+        }
     } else {
         Node_Branch* branch = (Node_Branch*)node;
         for (size_t i = 512; i-- > 0;) {
-            drop<T>(branch->children[i], depth - 1, allocator);
+            if (branch->children[i])
+                drop<T>(branch->children[i], depth - 1, allocator, snapshot);
         }
+        TracyFreeN(branch, profile::page_table_nodes);
         allocator.dealloc(branch);
     }
 }
 
 template <class T>
-uint64_t add(Page_Table<T>* page_table, cz::Allocator allocator, const T& element) {
-    uint64_t id = page_table->next_id++;
-
-    uint8_t depth = page_table->depth;
-
-    const uint8_t each = detail::comptime_log2(sizeof(Node_Branch) / sizeof(void*));
-    const uint8_t base = detail::comptime_log2(Leaf_Elements<T>::value);
-    const uint64_t each_mask = (1 << each) - 1;
-    const uint64_t base_mask = (1 << base) - 1;
+struct Layout {
+    static constexpr const uint8_t each = comptime_log2(sizeof(Node_Branch) / sizeof(void*));
+    static constexpr const uint8_t base = comptime_log2(Leaf_Elements<T>::value);
+    static constexpr const uint64_t each_mask = (1 << each) - 1;
+    static constexpr const uint64_t base_mask = (1 << base) - 1;
     static_assert(sizeof(Node_Branch) == sizeof(void*) * (1 << each),
                   "each must be log2(DIM(Node_Branch::children))");
 
-    if (depth == 0) {
-        T* leaf = allocator.alloc<T>(Leaf_Elements<T>::value);
-        CZ_ASSERT(leaf);
-        page_table->root = leaf;
+    /// The deepest a table can get before ids overflow 64 bits.
+    static constexpr const uint8_t max_depth = 1 + (64 - base + each - 1) / each;
+};
+
+/// Get the slot the leaf containing `id` is stored in, adding levels on
+/// top and allocating branches as necessary.  The leaf itself may be null.
+template <class T>
+void** leaf_slot(Page_Table<T>* page_table, cz::Allocator allocator, uint64_t id) {
+    const uint8_t each = Layout<T>::each;
+    const uint8_t base = Layout<T>::base;
+    const uint64_t each_mask = Layout<T>::each_mask;
+
+    if (page_table->depth == 0) {
         page_table->depth = 1;
-        leaf[0] = element;
-        return id;
+        TracyPlot(profile::page_table_depth, (int64_t)page_table->depth);
+        return &page_table->root;
     }
 
-    // Add a new level on top.
-    uint64_t total_shift = (depth - 1) * each + base;
-    if (id == ((uint64_t)1 << total_shift)) {
+    // Add new levels on top.
+    while (1) {
+        uint64_t total_shift = (page_table->depth - 1) * each + base;
+        if (total_shift >= 64 || (id >> total_shift) == 0)
+            break;
+
         Node_Branch* branch = allocator.alloc_zeroed<Node_Branch>();
+        CZ_ASSERT(branch);
+        TracyAllocN(branch, sizeof(Node_Branch), profile::page_table_nodes);
         branch->children[0] = page_table->root;
         page_table->root = branch;
         ++page_table->depth;
-        ++depth;
+        TracyPlot(profile::page_table_depth, (int64_t)page_table->depth);
     }
 
     void** node = &page_table->root;
 
-    for (uint8_t i = depth; i-- > 1;) {
+    for (uint8_t i = page_table->depth; i-- > 1;) {
         uint8_t shift = (i - 1) * each + base;
         uint64_t index = (id >> shift) & each_mask;
 
         Node_Branch* branch = (Node_Branch*)*node;
         node = &branch->children[index];
-        if (!*node) {
-            if (i > 1) {
-                *node = allocator.alloc_zeroed<Node_Branch>();
-            } else {
-                *node = allocator.alloc<T>(Leaf_Elements<T>::value);
-            }
+        if (!*node && i > 1) {
+            *node = allocator.alloc_zeroed<Node_Branch>();
             CZ_ASSERT(*node);
+            TracyAllocN(*node, sizeof(Node_Branch), profile::page_table_nodes);
         }
     }
 
+    return node;
+}
+
+template <class T>
+uint64_t add(Page_Table<T>* page_table, cz::Allocator allocator, const T& element) {
+    ZoneScoped;
+
+    uint64_t id = page_table->next_id++;
+
+    void** node = leaf_slot(page_table, allocator, id);
+    if (!*node) {
+        *node = allocator.alloc<T>(Leaf_Elements<T>::value);
+        CZ_ASSERT(*node);
+        TracyAllocN(*node, Leaf_Elements<T>::value * sizeof(T), profile::page_table_nodes);
+    }
+
     T* leaf = (T*)*node;
-    uint64_t index = id & base_mask;
+    uint64_t index = id & Layout<T>::base_mask;
     leaf[index] = element;
 
+    TracyPlot(profile::page_table_count, (int64_t)page_table->next_id);
     return id;
 }
 
+/// Walk from a node at height `Depth` down to its leaf.  The
+/// recursion is resolved at compile time so the loop is unrolled.
+template <class T, uint8_t Depth>
+struct Walk {
+    static void* leaf(void* node, uint64_t id) {
+        const uint8_t shift = (Depth - 2) * Layout<T>::each + Layout<T>::base;
+        uint64_t index = (id >> shift) & Layout<T>::each_mask;
+
+        Node_Branch* branch = (Node_Branch*)node;
+        node = branch->children[index];
+        CZ_DEBUG_ASSERT(node);
+
+        return Walk<T, Depth - 1>::leaf(node, id);
+    }
+};
+
+template <class T>
+struct Walk<T, 1> {
+    static void* leaf(void* node, uint64_t id) { return node; }
+};
+
+/// Select the `Walk` specialization for the table's current depth.
+template <class T, uint8_t Depth, bool Valid = (Depth <= Layout<T>::max_depth)>
+struct Walk_Dispatch {
+    static void* leaf(void* root, uint8_t depth, uint64_t id) {
+        if (depth == Depth)
+            return Walk<T, Depth>::leaf(root, id);
+        return Walk_Dispatch<T, Depth + 1>::leaf(root, depth, id);
+    }
+};
+
+template <class T, uint8_t Depth>
+struct Walk_Dispatch<T, Depth, false> {
+    static void* leaf(void* root, uint8_t depth, uint64_t id) {
+        CZ_DEBUG_ASSERT(false && "Page_Table depth out of range");
+        return nullptr;
+    }
+};
+
 template <class T>
 const T* lookup(const Page_Table<T>* page_table, uint64_t id) {
     if (id >= page_table->next_id)
@@ -130,37 +204,214 @@ const T* lookup(const Page_Table<T>* page_table, uint64_t id) {
     if (depth == 0)
         return nullptr;
 
-    const uint8_t each = detail::comptime_log2(sizeof(Node_Branch) / sizeof(void*));
-    const uint8_t base = detail::comptime_log2(Leaf_Elements<T>::value);
-    const uint64_t each_mask = (1 << each) - 1;
-    const uint64_t base_mask = (1 << base) - 1;
-    static_assert(sizeof(Node_Branch) == sizeof(void*) * (1 << each),
-                  "each must be log2(DIM(Node_Branch::children))");
+    T* leaf = (T*)Walk_Dispatch<T, 1>::leaf(page_table->root, depth, id);
+    uint64_t index = id & Layout<T>::base_mask;
+    T* element = &leaf[index];
+    return element;
+}
 
-    void* node = page_table->root;
+template <class T>
+const T* lookup(const Page_Table<T>* page_table, Lookup_Cursor<T>* cursor, uint64_t id) {
+    if (id >= page_table->next_id)
+        return nullptr;
 
-    for (uint8_t i = depth; i-- > 1;) {
-        uint8_t shift = (i - 1) * each + base;
-        uint64_t index = (id >> shift) & each_mask;
+    uint64_t leaf_index = id >> Layout<T>::base;
+    if (!cursor->leaf || cursor->leaf_index != leaf_index) {
+        uint8_t depth = page_table->depth;
+        if (depth == 0)
+            return nullptr;
 
-        Node_Branch* branch = (Node_Branch*)node;
-        node = branch->children[index];
-        CZ_DEBUG_ASSERT(node);
+        cursor->leaf = (T*)Walk_Dispatch<T, 1>::leaf(page_table->root, depth, id);
+        cursor->leaf_index = leaf_index;
     }
 
-    T* leaf = (T*)node;
-    uint64_t index = id & base_mask;
-    T* element = &leaf[index];
-    return element;
+    uint64_t index = id & Layout<T>::base_mask;
+    return &cursor->leaf[index];
+}
+
+/// The header at the start of a snapshot file.  It is padded
+/// to `size` bytes so that the leaves after it stay aligned.
+struct Snapshot_Header {
+    constexpr static const uint64_t size = 4096;
+    constexpr static const uint64_t MAGIC = 0x4c42415447415044;  // "DPAGTABL"
+    constexpr static const uint32_t VERSION = 1;
+
+    uint64_t magic;
+    uint32_t version;
+    uint32_t element_size;
+    uint64_t leaf_elements;
+    uint64_t next_id;
+};
+
+/// Batches chunks into as few vectored writes as possible.
+struct Snapshot_Writer {
+    int fd;
+    bool ok;
+    size_t len;
+    file::Chunk chunks[64];
+
+    void push(const void* buffer, size_t size) {
+        if (len == sizeof(chunks) / sizeof(chunks[0]))
+            flush();
+        chunks[len++] = {buffer, size};
+    }
+
+    void flush() {
+        if (ok && !file::write_chunks(fd, {chunks, len}))
+            ok = false;
+        len = 0;
+    }
+};
+
+/// `remaining` is the number of elements not yet written.  Leaves are allocated
+/// uninitialized so the unused end of the last leaf is written as zeros instead.
+template <class T>
+void save_leaves(Snapshot_Writer* writer, const void* node, uint8_t depth, uint64_t* remaining) {
+    if (depth <= 1) {
+        const uint64_t per_leaf = Leaf_Elements<T>::value;
+        uint64_t used = *remaining < per_leaf ? *remaining : per_leaf;
+        *remaining -= used;
+        writer->push(node, used * sizeof(T));
+        if (used < per_leaf) {
+            // Partial leaves only exist when multiple elements fit in a page.
+            static const char zeros[4096] = {};
+            static_assert(Leaf_Elements<T>::value == 1 ||
+                              Leaf_Elements<T>::value * sizeof(T) <= sizeof(zeros),
+                          "Leaves with multiple elements fit in a page");
+            writer->push(zeros, (per_leaf - used) * sizeof(T));
+        }
+    } else {
+        // Children are always allocated in order so stop at the first null.
+        const Node_Branch* branch = (const Node_Branch*)node;
+        for (size_t i = 0; i < 512 && branch->children[i]; ++i) {
+            save_leaves<T>(writer, branch->children[i], depth - 1, remaining);
+        }
+    }
 }
+
+template <class T>
+bool save(const Page_Table<T>* page_table, int fd) {
+    ZoneScoped;
+
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Page_Table snapshots require trivially copyable elements");
+
+    char header_page[Snapshot_Header::size] = {};
+    Snapshot_Header header;
+    header.magic = Snapshot_Header::MAGIC;
+    header.version = Snapshot_Header::VERSION;
+    header.element_size = sizeof(T);
+    header.leaf_elements = Leaf_Elements<T>::value;
+    header.next_id = page_table->next_id;
+    memcpy(header_page, &header, sizeof(header));
+
+    Snapshot_Writer writer;
+    writer.fd = fd;
+    writer.ok = true;
+    writer.len = 0;
+
+    writer.push(header_page, sizeof(header_page));
+    if (page_table->root) {
+        uint64_t remaining = page_table->next_id;
+        save_leaves<T>(&writer, page_table->root, page_table->depth, &remaining);
+    }
+    writer.flush();
+    return writer.ok;
+}
+
+template <class T>
+bool load(Page_Table<T>* page_table, cz::Allocator allocator, int fd) {
+    ZoneScoped;
+
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Page_Table snapshots require trivially copyable elements");
+    CZ_ASSERT(page_table->depth == 0);
+
+    file::Mapping mapping;
+    if (!file::map(fd, &mapping))
+        return false;
+
+    const uint64_t per_leaf = Leaf_Elements<T>::value;
+    const uint64_t leaf_size = per_leaf * sizeof(T);
+
+    Snapshot_Header header;
+    if (mapping.size < Snapshot_Header::size) {
+        file::unmap(mapping);
+        return false;
+    }
+    memcpy(&header, mapping.buffer, sizeof(header));
+
+    // Count the leaves from the file size rather than `next_id`
+    // so a corrupt `next_id` can't overflow the calculation.
+    uint64_t leaves_size = mapping.size - Snapshot_Header::size;
+    uint64_t num_leaves = leaves_size / leaf_size;
+    uint64_t max_id = num_leaves * per_leaf;
+    uint64_t min_id = num_leaves > 0 ? max_id - per_leaf + 1 : 0;
+    if (header.magic != Snapshot_Header::MAGIC || header.version != Snapshot_Header::VERSION ||
+        header.element_size != sizeof(T) || header.leaf_elements != per_leaf ||
+        leaves_size % leaf_size != 0 || header.next_id < min_id || header.next_id > max_id) {
+        file::unmap(mapping);
+        return false;
+    }
+
+    // Only the branches are rebuilt.  The leaves point directly into the mapping.
+    char* leaves = (char*)mapping.buffer + Snapshot_Header::size;
+    for (uint64_t i = 0; i < num_leaves; ++i) {
+        void** node = leaf_slot(page_table, allocator, i * per_leaf);
+        *node = leaves + i * leaf_size;
+    }
+
+    page_table->next_id = header.next_id;
+    page_table->snapshot = mapping;
+    TracyPlot(profile::page_table_count, (int64_t)page_table->next_id);
+    return true;
+}
+}
+
+namespace detail {
+template <class T>
+void measure(const void* node, uint8_t depth, const file::Mapping& snapshot, Stats* stats) {
+    if (depth <= 1) {
+        if (snapshot.contains(node)) {
+            ++stats->mapped_leaves;
+        } else {
+            ++stats->leaves;
+        }
+    } else {
+        ++stats->branches;
+        const Node_Branch* branch = (const Node_Branch*)node;
+        for (size_t i = 0; i < 512; ++i) {
+            if (branch->children[i])
+                measure<T>(branch->children[i], depth - 1, snapshot, stats);
+        }
+    }
+}
+}
+
+template <class T>
+Stats Page_Table<T>::stats() const {
+    Stats stats = {};
+    stats.elements = next_id;
+    stats.depth = depth;
+    if (root)
+        detail::measure<T>(root, depth, snapshot, &stats);
+    stats.bytes_allocated = stats.branches * sizeof(Node_Branch) +
+                            stats.leaves * Leaf_Elements<T>::value * sizeof(T);
+    uint64_t mapped_elements = stats.mapped_leaves * Leaf_Elements<T>::value;
+    if (mapped_elements > next_id)
+        mapped_elements = next_id;
+    stats.bytes_payload = (next_id - mapped_elements) * sizeof(T);
+    return stats;
 }
 
 template <class T>
 void Page_Table<T>::drop(cz::Allocator allocator) {
-    if (!root)
-        return;
+    ZoneScoped;
+
+    if (root)
+        detail::drop<T>(root, depth, allocator, snapshot);
 
-    detail::drop<T>(root, depth, allocator);
+    file::unmap(snapshot);
 }
 
 template <class T>
@@ -168,6 +419,16 @@ uint64_t Page_Table<T>::add(cz::Allocator allocator, const T& element) {
     return detail::add(this, allocator, element);
 }
 
+template <class T>
+bool Page_Table<T>::save(int fd) const {
+    return detail::save(this, fd);
+}
+
+template <class T>
+bool Page_Table<T>::load(cz::Allocator allocator, int fd) {
+    return detail::load(this, allocator, fd);
+}
+
 template <class T>
 T* Page_Table<T>::lookup(uint64_t id) {
     return (T*)detail::lookup(this, id);
@@ -178,6 +439,16 @@ const T* Page_Table<T>::lookup(uint64_t id) const {
     return detail::lookup(this, id);
 }
 
+template <class T>
+T* Page_Table<T>::lookup(Lookup_Cursor<T>* cursor, uint64_t id) {
+    return (T*)detail::lookup(this, cursor, id);
+}
+
+template <class T>
+const T* Page_Table<T>::lookup(Lookup_Cursor<T>* cursor, uint64_t id) const {
+    return detail::lookup(this, cursor, id);
+}
+
 }
 }
 
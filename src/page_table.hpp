@@ -2,16 +2,50 @@
 
 #include <stdint.h>
 #include <cz/allocator.hpp>
+#include "file.hpp"
 
 namespace ds {
 namespace pt {
 
+/// Remembers the last leaf visited by `Page_Table::lookup` so that looking
+/// up ids in the same leaf doesn't walk the branches again.  Leaves are
+/// never moved so a cursor stays valid until the `Page_Table` is dropped.
+///
+/// Initialize via `Lookup_Cursor<T> cursor = {};`.
+template <class T>
+struct Lookup_Cursor {
+    T* leaf;
+    uint64_t leaf_index;
+};
+
+/// The shape and memory use of a `Page_Table`.  See `Page_Table::stats`.
+struct Stats {
+    uint64_t elements;
+    uint8_t depth;
+    size_t branches;
+    size_t leaves;
+
+    /// Leaves loaded by `load` that live in the snapshot instead of being allocated.
+    size_t mapped_leaves;
+
+    /// Bytes of branches and leaves allocated versus bytes of elements stored in them.
+    size_t bytes_allocated;
+    size_t bytes_payload;
+
+    double efficiency() const {
+        return bytes_allocated ? (double)bytes_payload / bytes_allocated : 1;
+    }
+};
+
 template <class T>
 struct Page_Table {
     void* root;
     uint8_t depth;
     uint64_t next_id;
 
+    /// Leaves loaded by `load` live in this mapping instead of being allocated.
+    file::Mapping snapshot;
+
     void drop(cz::Allocator allocator);
 
     /// Add an element and return its id.
@@ -20,6 +54,24 @@ struct Page_Table {
     /// Lookup an element by its id.  Returns `nullptr` if no match.
     T* lookup(uint64_t id);
     const T* lookup(uint64_t id) const;
+
+    /// Lookup an element by its id, reusing the leaf cached in `cursor` if `id` is in it.
+    T* lookup(Lookup_Cursor<T>* cursor, uint64_t id);
+    const T* lookup(Lookup_Cursor<T>* cursor, uint64_t id) const;
+
+    /// Write every leaf in id order to `fd` at its current position.
+    /// `T` must be trivially copyable.  Returns `false` on error.
+    ///
+    /// Snapshots store elements verbatim so can only be loaded by the same build.
+    bool save(int fd) const;
+
+    /// Load a snapshot written by `save`.  The snapshot must be the whole
+    /// file.  Leaves are mapped instead of copied; only the branches are
+    /// allocated.  The `Page_Table` must be empty.  Returns `false` on error.
+    bool load(cz::Allocator allocator, int fd);
+
+    /// Measure the shape and memory use of the table.  This walks every branch.
+    Stats stats() const;
 };
 
 }
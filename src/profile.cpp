@@ -0,0 +1,36 @@
+#include "profile.hpp"
+
+namespace ds {
+namespace profile {
+
+const char btree_nodes[] = "btree nodes";
+const char btree_count[] = "btree count";
+const char btree_height[] = "btree height";
+
+const char splay_nodes[] = "splay nodes";
+const char splay_count[] = "splay count";
+const char splay_depth[] = "splay depth";
+
+const char compact_splay_nodes[] = "compact splay nodes";
+const char compact_splay_count[] = "compact splay count";
+
+const char rb_nodes[] = "rb nodes";
+const char rb_count[] = "rb count";
+
+const char avl_nodes[] = "avl nodes";
+const char avl_count[] = "avl count";
+const char avl_height[] = "avl height";
+
+const char page_table_nodes[] = "page table nodes";
+const char page_table_count[] = "page table count";
+const char page_table_depth[] = "page table depth";
+
+const char buffered_btree_nodes[] = "buffered btree nodes";
+const char buffered_btree_count[] = "buffered btree count";
+const char buffered_btree_pending[] = "buffered btree pending";
+
+const char hash_map_tables[] = "hash map tables";
+const char hash_map_count[] = "hash map count";
+
+}
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+namespace ds {
+namespace profile {
+
+/// Names of the Tracy memory pools and plots the containers report to.  Tracy
+/// identifies both by the address of the name, so they are defined once here
+/// instead of as literals inside every template instantiation.
+///
+/// Node allocations go to named pools so they don't collide with events the
+/// underlying allocator may report itself.
+extern const char btree_nodes[];
+extern const char btree_count[];
+extern const char btree_height[];
+
+extern const char splay_nodes[];
+extern const char splay_count[];
+extern const char splay_depth[];
+
+extern const char compact_splay_nodes[];
+extern const char compact_splay_count[];
+
+extern const char rb_nodes[];
+extern const char rb_count[];
+
+extern const char avl_nodes[];
+extern const char avl_count[];
+extern const char avl_height[];
+
+extern const char page_table_nodes[];
+extern const char page_table_count[];
+extern const char page_table_depth[];
+
+extern const char buffered_btree_nodes[];
+extern const char buffered_btree_count[];
+extern const char buffered_btree_pending[];
+
+extern const char hash_map_tables[];
+extern const char hash_map_count[];
+
+}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cz/allocator.hpp>
+#include "gen_map.hpp"
+#include "rb_tree.hpp"
+
+namespace ds {
+namespace rb {
+
+template <class Key, class Value>
+using Pair = gen::Map_Pair<Key, Value>;
+template <class Key, class Value>
+using Map_Iterator = Iterator<Pair<Key, Value> >;
+
+template <class Key, class Value>
+struct Map {
+    using Pair = gen::Map_Pair<Key, Value>;
+
+    void drop(cz::Allocator allocator) { return tree.drop(allocator); }
+
+    /// Insert the element into the tree.  If the element already
+    /// is present then does nothing and returns `false`.
+    bool insert(cz::Allocator allocator, const Key& key, const Value& value) {
+        return insert(allocator, {key, value});
+    }
+    bool insert(cz::Allocator allocator, const Pair& pair) {
+        return detail::insert_comparator(&tree, allocator, pair, gen::key_comparator(pair.key));
+    }
+
+    /// Remove the element at the iterator.
+    /// If the iterator is `end` then nothing is done.
+    void remove(cz::Allocator allocator, Iterator<const Pair> iterator) {
+        return tree.remove(allocator, iterator);
+    }
+
+    /// Get iterators allowing you to iterate through the entire tree.
+    Iterator<Pair> start() { return tree.start(); }
+    Iterator<Pair> end() { return tree.end(); }
+    Iterator<const Pair> start() const { return tree.start(); }
+    Iterator<const Pair> end() const { return tree.end(); }
+
+    /// Convenience methods for loops.  See `splay::Map::start_iter`.
+    Iterator<Pair> start_iter(const Key& first) { return find_greater_equal(first); }
+    Iterator<Pair> end_iter(const Key& last) { return find_greater_equal(last); }
+    Iterator<const Pair> start_iter(const Key& first) const { return find_greater_equal(first); }
+    Iterator<const Pair> end_iter(const Key& last) const { return find_greater_equal(last); }
+
+    /// Get iterators based on the position of the element.
+    /// If there are no matches then `end` is returned.
+    Iterator<Pair> find(const Key& key) { return find_equal(key); }
+    Iterator<Pair> find_equal(const Key& key);
+    Iterator<Pair> find_less(const Key& key);
+    Iterator<Pair> find_greater(const Key& key);
+    Iterator<Pair> find_less_equal(const Key& key);
+    Iterator<Pair> find_greater_equal(const Key& key);
+
+    Iterator<const Pair> find(const Key& key) const { return find_equal(key); }
+    Iterator<const Pair> find_equal(const Key& key) const;
+    Iterator<const Pair> find_less(const Key& key) const;
+    Iterator<const Pair> find_greater(const Key& key) const;
+    Iterator<const Pair> find_less_equal(const Key& key) const;
+    Iterator<const Pair> find_greater_equal(const Key& key) const;
+
+    bool contains(const Key& key) const { return find(key) != end(); }
+
+    size_t count() const { return tree.count(); }
+    gen::Tree_Stats stats() const { return tree.stats(); }
+
+    Tree<Pair> tree;
+};
+
+}
+}
+
+#include "rb_map.cpp"
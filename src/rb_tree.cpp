@@ -0,0 +1,375 @@
+#ifndef DS_RB_TREE_CPP
+#define DS_RB_TREE_CPP
+
+#include "rb_tree.hpp"
+#include "profile.hpp"
+
+#include <Tracy.hpp>
+#include <cz/compare.hpp>
+
+namespace ds {
+namespace rb {
+
+template <class T>
+void Tree<T>::drop(cz::Allocator allocator) {
+    gen::recursive_dealloc(allocator, root, profile::rb_nodes);
+}
+
+namespace detail {
+
+template <class T>
+bool is_red(gen::Node_Base* node) {
+    return node && ((Node<T>*)node)->red;
+}
+
+template <class T>
+void set_red(gen::Node_Base* node, bool red) {
+    ((Node<T>*)node)->red = red;
+}
+
+/// Rotate and then update the root if it moved.
+template <class T>
+void rotate_left(Tree<T>* tree, gen::Node_Base* node) {
+    gen::rotate_left(node);
+    if (!node->parent->parent)
+        tree->root = (Node<T>*)node->parent;
+}
+template <class T>
+void rotate_right(Tree<T>* tree, gen::Node_Base* node) {
+    gen::rotate_right(node);
+    if (!node->parent->parent)
+        tree->root = (Node<T>*)node->parent;
+}
+
+/// Replace the subtree at `node` with the subtree at `replacement`.
+template <class T>
+void transplant(Tree<T>* tree, gen::Node_Base* node, gen::Node_Base* replacement) {
+    if (!node->parent) {
+        tree->root = (Node<T>*)replacement;
+    } else if (node->parent->left == node) {
+        node->parent->left = replacement;
+    } else {
+        node->parent->right = replacement;
+    }
+    if (replacement)
+        replacement->parent = node->parent;
+}
+
+template <class T>
+void insert_fixup(Tree<T>* tree, gen::Node_Base* node) {
+    while (is_red<T>(node->parent)) {
+        gen::Node_Base* parent = node->parent;
+        // The root is black so a red parent always has a parent.
+        gen::Node_Base* grand = parent->parent;
+
+        if (parent == grand->left) {
+            gen::Node_Base* uncle = grand->right;
+            if (is_red<T>(uncle)) {
+                set_red<T>(parent, false);
+                set_red<T>(uncle, false);
+                set_red<T>(grand, true);
+                node = grand;
+                continue;
+            }
+
+            if (node == parent->right) {
+                rotate_left(tree, parent);
+                node = parent;
+                parent = node->parent;
+            }
+            set_red<T>(parent, false);
+            set_red<T>(grand, true);
+            rotate_right(tree, grand);
+        } else {
+            gen::Node_Base* uncle = grand->left;
+            if (is_red<T>(uncle)) {
+                set_red<T>(parent, false);
+                set_red<T>(uncle, false);
+                set_red<T>(grand, true);
+                node = grand;
+                continue;
+            }
+
+            if (node == parent->left) {
+                rotate_right(tree, parent);
+                node = parent;
+                parent = node->parent;
+            }
+            set_red<T>(parent, false);
+            set_red<T>(grand, true);
+            rotate_left(tree, grand);
+        }
+    }
+
+    tree->root->red = false;
+}
+
+/// `node` may be null so its parent is passed separately.
+template <class T>
+void remove_fixup(Tree<T>* tree, gen::Node_Base* node, gen::Node_Base* parent) {
+    while (node != tree->root && !is_red<T>(node)) {
+        if (node == parent->left) {
+            // The sibling has a black height of at least one so isn't null.
+            gen::Node_Base* sibling = parent->right;
+            if (is_red<T>(sibling)) {
+                set_red<T>(sibling, false);
+                set_red<T>(parent, true);
+                rotate_left(tree, parent);
+                sibling = parent->right;
+            }
+
+            if (!is_red<T>(sibling->left) && !is_red<T>(sibling->right)) {
+                set_red<T>(sibling, true);
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+
+            if (!is_red<T>(sibling->right)) {
+                set_red<T>(sibling->left, false);
+                set_red<T>(sibling, true);
+                rotate_right(tree, sibling);
+                sibling = parent->right;
+            }
+            set_red<T>(sibling, is_red<T>(parent));
+            set_red<T>(parent, false);
+            set_red<T>(sibling->right, false);
+            rotate_left(tree, parent);
+            node = tree->root;
+        } else {
+            gen::Node_Base* sibling = parent->left;
+            if (is_red<T>(sibling)) {
+                set_red<T>(sibling, false);
+                set_red<T>(parent, true);
+                rotate_right(tree, parent);
+                sibling = parent->left;
+            }
+
+            if (!is_red<T>(sibling->left) && !is_red<T>(sibling->right)) {
+                set_red<T>(sibling, true);
+                node = parent;
+                parent = node->parent;
+                continue;
+            }
+
+            if (!is_red<T>(sibling->left)) {
+                set_red<T>(sibling->right, false);
+                set_red<T>(sibling, true);
+                rotate_left(tree, sibling);
+                sibling = parent->left;
+            }
+            set_red<T>(sibling, is_red<T>(parent));
+            set_red<T>(parent, false);
+            set_red<T>(sibling->left, false);
+            rotate_right(tree, parent);
+            node = tree->root;
+        }
+    }
+
+    if (node)
+        set_red<T>(node, false);
+}
+
+template <class T, class Comparator>
+bool insert_comparator(Tree<T>* tree,
+                       cz::Allocator allocator,
+                       const T& element,
+                       Comparator&& comparator) {
+    ZoneScoped;
+
+    int64_t last_comparison;
+    Node<T>* parent = (Node<T>*)gen::find_comparator<T>(tree->root, &last_comparison, comparator);
+
+    // Already present.
+    if (parent && last_comparison == 0) {
+        return false;
+    }
+
+    Node<T>* node = allocator.alloc<Node<T> >();
+    CZ_ASSERT(node);
+    TracyAllocN(node, sizeof(Node<T>), profile::rb_nodes);
+    node->parent = parent;
+    node->left = nullptr;
+    node->right = nullptr;
+    node->element = element;
+    node->red = true;
+
+    if (!parent) {
+        tree->root = node;
+    } else if (last_comparison < 0) {
+        parent->left = node;
+    } else {
+        parent->right = node;
+    }
+
+    insert_fixup(tree, node);
+    ++tree->num_elements;
+    TracyPlot(profile::rb_count, (int64_t)tree->num_elements);
+    return true;
+}
+
+}
+
+template <class T>
+bool Tree<T>::insert(cz::Allocator allocator, const T& element) {
+    return detail::insert_comparator(this, allocator, element, gen::element_comparator(element));
+}
+
+template <class T>
+void Tree<T>::remove(cz::Allocator allocator, Iterator<const T> iterator) {
+    ZoneScoped;
+    if (iterator == end())
+        return;
+
+    Node<T>* node = (Node<T>*)iterator.node;
+
+    // `moved` is the node that is removed from its position in the
+    // tree.  `child` takes its place and `parent` is its new parent.
+    gen::Node_Base* moved = node;
+    bool moved_red = node->red;
+    gen::Node_Base* child;
+    gen::Node_Base* parent;
+
+    if (!node->left) {
+        child = node->right;
+        parent = node->parent;
+        detail::transplant(this, node, node->right);
+    } else if (!node->right) {
+        child = node->left;
+        parent = node->parent;
+        detail::transplant(this, node, node->left);
+    } else {
+        // Replace the node with its successor.
+        moved = gen::leftmost(node->right);
+        moved_red = ((Node<T>*)moved)->red;
+        child = moved->right;
+
+        if (moved->parent == node) {
+            parent = moved;
+        } else {
+            parent = moved->parent;
+            detail::transplant(this, moved, moved->right);
+            moved->right = node->right;
+            moved->right->parent = moved;
+        }
+
+        detail::transplant(this, node, moved);
+        moved->left = node->left;
+        moved->left->parent = moved;
+        ((Node<T>*)moved)->red = node->red;
+    }
+
+    if (!moved_red)
+        detail::remove_fixup(this, child, parent);
+
+    TracyFreeN(node, profile::rb_nodes);
+    allocator.dealloc(node);
+    --num_elements;
+    TracyPlot(profile::rb_count, (int64_t)num_elements);
+}
+
+template <class T>
+Iterator<T> Tree<T>::start() {
+    return Iterator<T>{(gen::Node<T>*)gen::leftmost(root)};
+}
+template <class T>
+Iterator<const T> Tree<T>::start() const {
+    return Iterator<T>{(gen::Node<T>*)gen::leftmost(root)};
+}
+
+template <class T>
+Iterator<T> Tree<T>::end() {
+    return Iterator<T>{nullptr};
+}
+template <class T>
+Iterator<const T> Tree<T>::end() const {
+    return Iterator<const T>{nullptr};
+}
+
+template <class T>
+Iterator<T> Tree<T>::find_equal(const T& element) {
+    return detail::find_equal_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<T> Tree<T>::find_less(const T& element) {
+    return detail::find_less_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<T> Tree<T>::find_greater(const T& element) {
+    return detail::find_greater_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<T> Tree<T>::find_less_equal(const T& element) {
+    return detail::find_less_equal_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<T> Tree<T>::find_greater_equal(const T& element) {
+    return detail::find_greater_equal_comparator(this, gen::element_comparator(element));
+}
+
+template <class T>
+Iterator<const T> Tree<T>::find_equal(const T& element) const {
+    return detail::find_equal_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<const T> Tree<T>::find_less(const T& element) const {
+    return detail::find_less_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<const T> Tree<T>::find_greater(const T& element) const {
+    return detail::find_greater_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<const T> Tree<T>::find_less_equal(const T& element) const {
+    return detail::find_less_equal_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<const T> Tree<T>::find_greater_equal(const T& element) const {
+    return detail::find_greater_equal_comparator(this, gen::element_comparator(element));
+}
+
+namespace detail {
+
+template <class T, class Comparator>
+static Iterator<T> find_gen(const Tree<T>* tree, int64_t* last_comparison, Comparator&& comparator) {
+    gen::Node<T>* node = gen::find_comparator<T>(tree->root, last_comparison, comparator);
+    return Iterator<T>{node};
+}
+
+template <class T, class Comparator>
+Iterator<T> find_equal_comparator(const Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_equal(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<T> find_less_comparator(const Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_less(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<T> find_greater_comparator(const Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_greater(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<T> find_less_equal_comparator(const Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_less_equal(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<T> find_greater_equal_comparator(const Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_greater_equal(iterator, last_comparison, comparator);
+}
+
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cz/allocator.hpp>
+#include "gen_tree.hpp"
+
+namespace ds {
+namespace rb {
+
+using gen::Iterator;
+
+/// The color is stored after the element so that
+/// `gen::Iterator` can treat this as a `gen::Node<T>`.
+template <class T>
+struct Node : gen::Node<T> {
+    bool red;
+};
+
+/// A red-black tree.  Guarantees O(log n) worst case insertion, removal and lookup.
+template <class T>
+struct Tree {
+    void drop(cz::Allocator allocator);
+
+    /// Insert the element into the tree.  If the element already
+    /// is present then does nothing and returns `false`.
+    bool insert(cz::Allocator allocator, const T& element);
+
+    /// Remove the element at the iterator.
+    /// If the iterator is `end` then nothing is done.
+    void remove(cz::Allocator allocator, Iterator<const T> iterator);
+
+    /// Get iterators allowing you to iterate through the entire tree.
+    Iterator<T> start();
+    Iterator<T> end();
+    Iterator<const T> start() const;
+    Iterator<const T> end() const;
+
+    /// Convenience methods for loops.  See `splay::Tree::start_iter`.
+    Iterator<T> start_iter(const T& first) { return find_greater_equal(first); }
+    Iterator<T> end_iter(const T& last) { return find_greater_equal(last); }
+    Iterator<const T> start_iter(const T& first) const { return find_greater_equal(first); }
+    Iterator<const T> end_iter(const T& last) const { return find_greater_equal(last); }
+
+    /// Get iterators based on the position of the query.
+    /// If there are no matches then `end` is returned.
+    Iterator<T> find(const T& query) { return find_equal(query); }
+    Iterator<T> find_equal(const T& query);
+    Iterator<T> find_less(const T& query);
+    Iterator<T> find_greater(const T& query);
+    Iterator<T> find_less_equal(const T& query);
+    Iterator<T> find_greater_equal(const T& query);
+
+    Iterator<const T> find(const T& query) const { return find_equal(query); }
+    Iterator<const T> find_equal(const T& query) const;
+    Iterator<const T> find_less(const T& query) const;
+    Iterator<const T> find_greater(const T& query) const;
+    Iterator<const T> find_less_equal(const T& query) const;
+    Iterator<const T> find_greater_equal(const T& query) const;
+
+    bool contains(const T& element) const { return find(element) != end(); }
+
+    size_t count() const { return num_elements; }
+
+    /// Measure the shape and memory use of the tree.  This walks every node.
+    gen::Tree_Stats stats() const { return gen::measure(root); }
+
+    Node<T>* root;
+    size_t num_elements;
+};
+
+namespace detail {
+
+/// Same as `Tree` methods above except uses `comparator(node->element)`
+/// instead of `compare(query, node->element)` to compare.
+template <class T, class Comparator>
+Iterator<T> find_equal_comparator(const Tree<T>* tree, Comparator&& comparator);
+template <class T, class Comparator>
+Iterator<T> find_less_comparator(const Tree<T>* tree, Comparator&& comparator);
+template <class T, class Comparator>
+Iterator<T> find_greater_comparator(const Tree<T>* tree, Comparator&& comparator);
+template <class T, class Comparator>
+Iterator<T> find_less_equal_comparator(const Tree<T>* tree, Comparator&& comparator);
+template <class T, class Comparator>
+Iterator<T> find_greater_equal_comparator(const Tree<T>* tree, Comparator&& comparator);
+
+template <class T, class Comparator>
+bool insert_comparator(Tree<T>* tree,
+                       cz::Allocator allocator,
+                       const T& element,
+                       Comparator&& comparator);
+
+}
+
+}
+}
+
+#include "rb_tree.cpp"
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <Tracy.hpp>
 #include "gen_tree.hpp"
 
 namespace ds {
@@ -7,5 +8,114 @@ namespace splay {
 
 void splay(gen::Node_Base* elem);
 
+/// Search for the node matching `comparator` and splay it to the root
+/// in a single top down pass.  If there is no match then the last node
+/// visited becomes the root.  Returns the new root and stores the result
+/// of `comparator(root->element)` in `last_comparison`.  Allows null input.
+template <class T, class Comparator>
+gen::Node<T>* splay_comparator(gen::Node<T>* root,
+                               int64_t* last_comparison,
+                               Comparator&& comparator) {
+    ZoneScoped;
+
+    using Node = gen::Node<T>;
+
+    if (!root) {
+        *last_comparison = 0;
+        return nullptr;
+    }
+
+    // `header.right` is the root of the left tree and `header.left` is the root
+    // of the right tree.  `left` and `right` are their maximum and minimum nodes.
+    gen::Node_Base header;
+    header.left = nullptr;
+    header.right = nullptr;
+    gen::Node_Base* left = &header;
+    gen::Node_Base* right = &header;
+
+    Node* node = root;
+    int64_t comparison = comparator(node->element);
+    while (1) {
+        if (comparison < 0) {
+            Node* child = (Node*)node->left;
+            if (!child)
+                break;
+
+            int64_t child_comparison = comparator(child->element);
+            if (child_comparison < 0) {
+                // Zig-Zig: rotate right.
+                node->left = child->right;
+                if (node->left)
+                    node->left->parent = node;
+                child->right = node;
+                node->parent = child;
+
+                node = child;
+                comparison = child_comparison;
+                child = (Node*)node->left;
+                if (!child)
+                    break;
+                child_comparison = comparator(child->element);
+            }
+
+            // Link right.
+            right->left = node;
+            node->parent = right;
+            right = node;
+            node = child;
+            comparison = child_comparison;
+        } else if (comparison > 0) {
+            Node* child = (Node*)node->right;
+            if (!child)
+                break;
+
+            int64_t child_comparison = comparator(child->element);
+            if (child_comparison > 0) {
+                // Zag-Zag: rotate left.
+                node->right = child->left;
+                if (node->right)
+                    node->right->parent = node;
+                child->left = node;
+                node->parent = child;
+
+                node = child;
+                comparison = child_comparison;
+                child = (Node*)node->right;
+                if (!child)
+                    break;
+                child_comparison = comparator(child->element);
+            }
+
+            // Link left.
+            left->right = node;
+            node->parent = left;
+            left = node;
+            node = child;
+            comparison = child_comparison;
+        } else {
+            break;
+        }
+    }
+
+    // Assemble.
+    left->right = node->left;
+    if (left->right)
+        left->right->parent = left;
+    right->left = node->right;
+    if (right->left)
+        right->left->parent = right;
+
+    node->left = header.right;
+    if (node->left)
+        node->left->parent = node;
+    node->right = header.left;
+    if (node->right)
+        node->right->parent = node;
+    node->parent = nullptr;
+
+    *last_comparison = comparison;
+    return node;
+}
+
 }
 }
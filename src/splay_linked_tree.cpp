@@ -0,0 +1,143 @@
+#ifndef DS_SPLAY_LINKED_TREE_CPP
+#define DS_SPLAY_LINKED_TREE_CPP
+
+#include "splay_linked_tree.hpp"
+
+#include <Tracy.hpp>
+
+namespace ds {
+namespace splay {
+
+template <class T>
+void Linked_Tree<T>::drop(cz::Allocator allocator) {
+    tree.drop(allocator);
+}
+
+template <class T>
+bool Linked_Tree<T>::insert(cz::Allocator allocator, const T& element) {
+    ZoneScoped;
+
+    Linked<T> linked = {nullptr, nullptr, element};
+    if (!tree.insert(allocator, linked))
+        return false;
+
+    // `insert` splits the old root around the new node so one neighbor is
+    // a direct child with no children on our side.  The other neighbor
+    // is found through that one's links before they are updated.
+    Node<Linked<T> >* node = tree.root;
+    Node<Linked<T> >* left = (Node<Linked<T> >*)node->left;
+    Node<Linked<T> >* right = (Node<Linked<T> >*)node->right;
+    Node<Linked<T> >* prev;
+    Node<Linked<T> >* next;
+    if (left && !left->right) {
+        prev = left;
+        next = prev->element.next;
+    } else if (right) {
+        CZ_DEBUG_ASSERT(!right->left);
+        next = right;
+        prev = next->element.prev;
+    } else {
+        CZ_DEBUG_ASSERT(!left);
+        prev = nullptr;
+        next = nullptr;
+    }
+
+    node->element.prev = prev;
+    node->element.next = next;
+    if (prev)
+        prev->element.next = node;
+    else
+        first = node;
+    if (next)
+        next->element.prev = node;
+    else
+        last = node;
+    return true;
+}
+
+template <class T>
+void Linked_Tree<T>::remove(cz::Allocator allocator, Linked_Iterator<const T> iterator) {
+    ZoneScoped;
+    if (iterator == end())
+        return;
+
+    Node<Linked<T> >* node = (Node<Linked<T> >*)iterator.node;
+    Node<Linked<T> >* prev = node->element.prev;
+    Node<Linked<T> >* next = node->element.next;
+    if (prev)
+        prev->element.next = next;
+    else
+        first = next;
+    if (next)
+        next->element.prev = prev;
+    else
+        last = prev;
+
+    tree.remove(allocator, Iterator<const Linked<T> >{(Node<const Linked<T> >*)node});
+}
+
+template <class T>
+Linked_Iterator<T> Linked_Tree<T>::find_equal(const T& query) {
+    return {detail::find_equal_comparator(&tree, gen::linked_comparator(query)).node, &last};
+}
+template <class T>
+Linked_Iterator<T> Linked_Tree<T>::find_less(const T& query) {
+    return {detail::find_less_comparator(&tree, gen::linked_comparator(query)).node, &last};
+}
+template <class T>
+Linked_Iterator<T> Linked_Tree<T>::find_greater(const T& query) {
+    return {detail::find_greater_comparator(&tree, gen::linked_comparator(query)).node, &last};
+}
+template <class T>
+Linked_Iterator<T> Linked_Tree<T>::find_less_equal(const T& query) {
+    return {detail::find_less_equal_comparator(&tree, gen::linked_comparator(query)).node, &last};
+}
+template <class T>
+Linked_Iterator<T> Linked_Tree<T>::find_greater_equal(const T& query) {
+    return {detail::find_greater_equal_comparator(&tree, gen::linked_comparator(query)).node,
+            &last};
+}
+
+namespace detail {
+template <class T>
+Linked_Iterator<const T> linked_iterator(const Linked_Tree<T>* tree,
+                                         Iterator<const Linked<T> > iterator) {
+    return Linked_Iterator<T>{(Node<Linked<T> >*)iterator.node, &tree->last};
+}
+}
+
+template <class T>
+Linked_Iterator<const T> Linked_Tree<T>::find_equal(const T& query) const {
+    const Tree<Linked<T> >* tree = &this->tree;
+    return detail::linked_iterator(
+        this, detail::find_equal_comparator(tree, gen::linked_comparator(query)));
+}
+template <class T>
+Linked_Iterator<const T> Linked_Tree<T>::find_less(const T& query) const {
+    const Tree<Linked<T> >* tree = &this->tree;
+    return detail::linked_iterator(
+        this, detail::find_less_comparator(tree, gen::linked_comparator(query)));
+}
+template <class T>
+Linked_Iterator<const T> Linked_Tree<T>::find_greater(const T& query) const {
+    const Tree<Linked<T> >* tree = &this->tree;
+    return detail::linked_iterator(
+        this, detail::find_greater_comparator(tree, gen::linked_comparator(query)));
+}
+template <class T>
+Linked_Iterator<const T> Linked_Tree<T>::find_less_equal(const T& query) const {
+    const Tree<Linked<T> >* tree = &this->tree;
+    return detail::linked_iterator(
+        this, detail::find_less_equal_comparator(tree, gen::linked_comparator(query)));
+}
+template <class T>
+Linked_Iterator<const T> Linked_Tree<T>::find_greater_equal(const T& query) const {
+    const Tree<Linked<T> >* tree = &this->tree;
+    return detail::linked_iterator(
+        this, detail::find_greater_equal_comparator(tree, gen::linked_comparator(query)));
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cz/allocator.hpp>
+#include "gen_linked.hpp"
+#include "splay_tree.hpp"
+
+namespace ds {
+namespace splay {
+
+using gen::Linked;
+using gen::Linked_Iterator;
+
+/// A `Tree` whose elements are also threaded onto a sorted doubly linked list.
+/// Iterating costs O(1) per step regardless of the shape of the tree and
+/// never touches parent pointers.  This costs two extra pointers per node.
+///
+/// Iterators point back into the `Linked_Tree` so moving it invalidates them.
+template <class T>
+struct Linked_Tree {
+    void drop(cz::Allocator allocator);
+
+    /// Insert the element into the tree.  If the element already
+    /// is present then does nothing and returns `false`.
+    bool insert(cz::Allocator allocator, const T& element);
+
+    /// Remove the element at the iterator.
+    /// If the iterator is `end` then nothing is done.
+    void remove(cz::Allocator allocator, Linked_Iterator<const T> iterator);
+
+    /// Get iterators allowing you to iterate through the entire tree.
+    /// These are O(1).  Unlike `Tree`, `--end()` is the last element.
+    Linked_Iterator<T> start() { return {first, &last}; }
+    Linked_Iterator<T> end() { return {nullptr, &last}; }
+    Linked_Iterator<const T> start() const { return Linked_Iterator<T>{first, &last}; }
+    Linked_Iterator<const T> end() const { return Linked_Iterator<T>{nullptr, &last}; }
+
+    /// See `Tree::start_iter`.
+    Linked_Iterator<T> start_iter(const T& first) { return find_greater_equal(first); }
+    Linked_Iterator<T> end_iter(const T& last) { return find_greater_equal(last); }
+    Linked_Iterator<const T> start_iter(const T& first) const { return find_greater_equal(first); }
+    Linked_Iterator<const T> end_iter(const T& last) const { return find_greater_equal(last); }
+
+    /// Get iterators based on the position of the query.
+    /// If there are no matches then `end` is returned.
+    /// These methods `splay` so are not const.
+    Linked_Iterator<T> find(const T& query) { return find_equal(query); }
+    Linked_Iterator<T> find_equal(const T& query);
+    Linked_Iterator<T> find_less(const T& query);
+    Linked_Iterator<T> find_greater(const T& query);
+    Linked_Iterator<T> find_less_equal(const T& query);
+    Linked_Iterator<T> find_greater_equal(const T& query);
+
+    /// Same as above except these don't `splay` so multiple threads can search at once.
+    Linked_Iterator<const T> find(const T& query) const { return find_equal(query); }
+    Linked_Iterator<const T> find_equal(const T& query) const;
+    Linked_Iterator<const T> find_less(const T& query) const;
+    Linked_Iterator<const T> find_greater(const T& query) const;
+    Linked_Iterator<const T> find_less_equal(const T& query) const;
+    Linked_Iterator<const T> find_greater_equal(const T& query) const;
+
+    bool contains(const T& element) { return find(element) != end(); }
+    bool contains(const T& element) const { return find(element) != end(); }
+
+    size_t count() const { return tree.count(); }
+
+    /// Measure the shape and memory use of the tree.  This walks every node.
+    /// The threading pointers are counted as overhead rather than payload.
+    gen::Tree_Stats stats() const {
+        gen::Tree_Stats result = tree.stats();
+        result.bytes_payload = result.nodes * sizeof(T);
+        return result;
+    }
+
+    Tree<Linked<T> > tree;
+    Node<Linked<T> >* first;
+    Node<Linked<T> >* last;
+};
+
+}
+}
+
+#include "splay_linked_tree.cpp"
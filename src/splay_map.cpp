@@ -6,45 +6,91 @@
 namespace ds {
 namespace splay {
 
-template <class Key>
-struct Key_Comparator {
-    const Key* key;
-
-    template <class Value>
-    int64_t operator()(const Pair<Key, Value>& pair) const {
-        using cz::compare;
-        return compare(*key, pair.key);
-    }
-};
-
-template <class Key>
-Key_Comparator<Key> key_comparator(const Key& key) {
-    return {&key};
+template <class Key, class Value>
+Map<Key, Value> Map<Key, Value>::split(const Key& pivot) {
+    Map<Key, Value> right;
+    right.tree = detail::split_comparator(&tree, gen::key_comparator(pivot));
+    return right;
 }
 
 template <class Key, class Value>
 Iterator<Pair<Key, Value> > Map<Key, Value>::find_equal(const Key& key) {
-    return detail::find_equal_comparator(&tree, key_comparator(key));
+    return detail::find_equal_comparator(&tree, gen::key_comparator(key));
 }
 
 template <class Key, class Value>
 Iterator<Pair<Key, Value> > Map<Key, Value>::find_less(const Key& key) {
-    return detail::find_less_comparator(&tree, key_comparator(key));
+    return detail::find_less_comparator(&tree, gen::key_comparator(key));
 }
 
 template <class Key, class Value>
 Iterator<Pair<Key, Value> > Map<Key, Value>::find_greater(const Key& key) {
-    return detail::find_greater_comparator(&tree, key_comparator(key));
+    return detail::find_greater_comparator(&tree, gen::key_comparator(key));
 }
 
 template <class Key, class Value>
 Iterator<Pair<Key, Value> > Map<Key, Value>::find_less_equal(const Key& key) {
-    return detail::find_less_equal_comparator(&tree, key_comparator(key));
+    return detail::find_less_equal_comparator(&tree, gen::key_comparator(key));
 }
 
 template <class Key, class Value>
 Iterator<Pair<Key, Value> > Map<Key, Value>::find_greater_equal(const Key& key) {
-    return detail::find_greater_equal_comparator(&tree, key_comparator(key));
+    return detail::find_greater_equal_comparator(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<Pair<Key, Value> > Map<Key, Value>::find_equal_from(Iterator<Pair> finger,
+                                                             const Key& key) {
+    return detail::find_equal_from_comparator(&tree, finger, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<Pair<Key, Value> > Map<Key, Value>::find_less_from(Iterator<Pair> finger,
+                                                            const Key& key) {
+    return detail::find_less_from_comparator(&tree, finger, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<Pair<Key, Value> > Map<Key, Value>::find_greater_from(Iterator<Pair> finger,
+                                                               const Key& key) {
+    return detail::find_greater_from_comparator(&tree, finger, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<Pair<Key, Value> > Map<Key, Value>::find_less_equal_from(Iterator<Pair> finger,
+                                                                  const Key& key) {
+    return detail::find_less_equal_from_comparator(&tree, finger, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<Pair<Key, Value> > Map<Key, Value>::find_greater_equal_from(Iterator<Pair> finger,
+                                                                     const Key& key) {
+    return detail::find_greater_equal_from_comparator(&tree, finger, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<const Pair<Key, Value> > Map<Key, Value>::find_equal(const Key& key) const {
+    return detail::find_equal_comparator(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<const Pair<Key, Value> > Map<Key, Value>::find_less(const Key& key) const {
+    return detail::find_less_comparator(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<const Pair<Key, Value> > Map<Key, Value>::find_greater(const Key& key) const {
+    return detail::find_greater_comparator(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<const Pair<Key, Value> > Map<Key, Value>::find_less_equal(const Key& key) const {
+    return detail::find_less_equal_comparator(&tree, gen::key_comparator(key));
+}
+
+template <class Key, class Value>
+Iterator<const Pair<Key, Value> > Map<Key, Value>::find_greater_equal(const Key& key) const {
+    return detail::find_greater_equal_comparator(&tree, gen::key_comparator(key));
 }
 
 }
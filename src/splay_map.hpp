@@ -31,6 +31,20 @@ struct Map {
         return tree.remove(allocator, iterator);
     }
 
+    /// Remove every pair with a key greater than or equal to `pivot`
+    /// from this map and return them as a new map.
+    Map split(const Key& pivot);
+
+    /// Build a perfectly balanced map from `pairs` sorted by strictly increasing key.
+    /// See `Tree::build_from_sorted`.
+    void build_from_sorted(cz::Allocator allocator, cz::Slice<const Pair> pairs) {
+        return tree.build_from_sorted(allocator, pairs);
+    }
+
+    /// Move every pair from `right` to the end of this map.  Every key in `right`
+    /// must be greater than every key in this map.  `right` is left empty.
+    void join(Map* right) { return tree.join(&right->tree); }
+
     /// Get iterators allowing you to iterate through the entire tree.
     Iterator<Pair> start() { return tree.start(); }
     Iterator<Pair> end() { return tree.end(); }
@@ -48,6 +62,8 @@ struct Map {
     /// ```
     Iterator<Pair> start_iter(const Key& first) { return find_greater_equal(first); }
     Iterator<Pair> end_iter(const Key& last) { return find_greater_equal(last); }
+    Iterator<const Pair> start_iter(const Key& first) const { return find_greater_equal(first); }
+    Iterator<const Pair> end_iter(const Key& last) const { return find_greater_equal(last); }
 
     /// Get iterators based on the position of the element.
     /// If there are no matches then `end` is returned.
@@ -59,9 +75,31 @@ struct Map {
     Iterator<Pair> find_less_equal(const Key& key);
     Iterator<Pair> find_greater_equal(const Key& key);
 
+    /// Search starting at `finger` instead of the root.  Walking through the
+    /// map like a cursor is O(1) amortized per step.  See `Tree::find_from`.
+    Iterator<Pair> find_from(Iterator<Pair> finger, const Key& key) {
+        return find_equal_from(finger, key);
+    }
+    Iterator<Pair> find_equal_from(Iterator<Pair> finger, const Key& key);
+    Iterator<Pair> find_less_from(Iterator<Pair> finger, const Key& key);
+    Iterator<Pair> find_greater_from(Iterator<Pair> finger, const Key& key);
+    Iterator<Pair> find_less_equal_from(Iterator<Pair> finger, const Key& key);
+    Iterator<Pair> find_greater_equal_from(Iterator<Pair> finger, const Key& key);
+
+    /// Same as above except these don't `splay` so multiple threads can search at once.
+    Iterator<const Pair> find(const Key& key) const { return find_equal(key); }
+    Iterator<const Pair> find_equal(const Key& key) const;
+    Iterator<const Pair> find_less(const Key& key) const;
+    Iterator<const Pair> find_greater(const Key& key) const;
+    Iterator<const Pair> find_less_equal(const Key& key) const;
+    Iterator<const Pair> find_greater_equal(const Key& key) const;
+
     bool contains(const Key& key) { return find(key) != end(); }
+    bool contains(const Key& key) const { return find(key) != end(); }
 
+    /// O(1) except the first call after a `split` walks the tree once.  See `Tree::count`.
     size_t count() const { return tree.count(); }
+    gen::Tree_Stats stats() const { return tree.stats(); }
 
     Tree<Pair> tree;
 };
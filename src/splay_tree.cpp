@@ -2,91 +2,245 @@
 #define DS_SPLAY_TREE_CPP
 
 #include "splay_tree.hpp"
+#include "profile.hpp"
 #include "splay.hpp"
 
+#include <stdint.h>
 #include <Tracy.hpp>
 #include <cz/compare.hpp>
 
 namespace ds {
 namespace splay {
 
+namespace detail {
+/// The bytes before the nodes of a block.
+template <class T>
+size_t block_header_bytes() {
+    return (sizeof(Node_Block<T>) + alignof(Node<T>) - 1) / alignof(Node<T>) * alignof(Node<T>);
+}
+
+template <class T>
+size_t block_bytes(size_t len) {
+    return block_header_bytes<T>() + len * sizeof(Node<T>);
+}
+
+template <class T>
+Node<T>* block_nodes(const Node_Block<T>* block) {
+    return (Node<T>*)((char*)block + block_header_bytes<T>());
+}
+
+template <class T>
+Node_Block<T>* group_owner(Node_Block<T>* block) {
+    // Merging groups repoints every block so this is at most one step.
+    if (block && block->owner)
+        block = block->owner;
+    CZ_DEBUG_ASSERT(!block || !block->owner);
+    return block;
+}
+
+template <class T>
+bool Block_Group<T>::contains(const gen::Node_Base* node) const {
+    if (!owner)
+        return false;
+
+    uintptr_t address = (uintptr_t)node;
+    for (const Node_Block<T>* block = owner->index; block;) {
+        uintptr_t start = (uintptr_t)block_nodes(block);
+        if (address < start)
+            block = block->left;
+        else if (address < start + block->len * sizeof(Node<T>))
+            return true;
+        else
+            block = block->right;
+    }
+    return false;
+}
+
+/// A hash of the address so the index needs no space for priorities.
+template <class T>
+uint64_t block_priority(const Node_Block<T>* block) {
+    return (uint64_t)(uintptr_t)block * 0x9E3779B97F4A7C15;
+}
+
+/// Insert `block` into the index rooted at `root` and return the new root.
+template <class T>
+Node_Block<T>* index_insert(Node_Block<T>* root, Node_Block<T>* block) {
+    if (!root) {
+        block->left = nullptr;
+        block->right = nullptr;
+        return block;
+    }
+
+    if ((uintptr_t)block < (uintptr_t)root) {
+        root->left = index_insert(root->left, block);
+        if (block_priority(root->left) > block_priority(root)) {
+            Node_Block<T>* left = root->left;
+            root->left = left->right;
+            left->right = root;
+            return left;
+        }
+    } else {
+        root->right = index_insert(root->right, block);
+        if (block_priority(root->right) > block_priority(root)) {
+            Node_Block<T>* right = root->right;
+            root->right = right->left;
+            right->left = root;
+            return right;
+        }
+    }
+    return root;
+}
+
+/// Add `block` to the group owned by `owner`.
+template <class T>
+void group_add(Node_Block<T>* owner, Node_Block<T>* block) {
+    block->owner = owner;
+    block->next = owner->next;
+    owner->next = block;
+    owner->index = index_insert(owner->index, block);
+    ++owner->num_blocks;
+}
+
+/// Move every block of the group owned by `other` into the group owned by `owner`.
+template <class T>
+void group_merge(Node_Block<T>* owner, Node_Block<T>* other) {
+    owner->references += other->references;
+    for (Node_Block<T>* block = other; block;) {
+        Node_Block<T>* next = block->next;
+        group_add(owner, block);
+        block = next;
+    }
+}
+
+template <class T>
+size_t Block_Group<T>::num_nodes() const {
+    size_t total = 0;
+    for (const Node_Block<T>* block = owner; block; block = block->next) {
+        total += block->len;
+    }
+    return total;
+}
+
+/// Drop a tree's reference to a group and free the group if it was the last one.
+template <class T>
+void release_group(cz::Allocator allocator, Node_Block<T>* owner) {
+    if (!owner || --owner->references > 0)
+        return;
+
+    for (Node_Block<T>* block = owner; block;) {
+        Node_Block<T>* next = block->next;
+        TracyFreeN(block, profile::splay_nodes);
+        allocator.dealloc({block, block_bytes<T>(block->len)});
+        block = next;
+    }
+}
+}
+
 template <class T>
 void Tree<T>::drop(cz::Allocator allocator) {
-    gen::recursive_dealloc(allocator, root);
+    Node_Block<T>* owner = detail::group_owner(blocks);
+    gen::recursive_dealloc(allocator, root, detail::Block_Group<T>{owner}, profile::splay_nodes);
+    detail::release_group(allocator, owner);
 }
 
 template <class T, class Comparator>
 static Iterator<T> find_gen(Tree<T>* tree, int64_t* last_comparison, Comparator&& comparator) {
-    Node<T>* parent = gen::find_comparator(tree->root, last_comparison, comparator);
+    if (tree->splay_depth == 0) {
+        tree->root = splay_comparator(tree->root, last_comparison, comparator);
+        return Iterator<T>{tree->root};
+    }
+
+    // Only restructure the tree if the path is too long.
+    size_t depth;
+    Node<T>* node = gen::find_comparator_depth(tree->root, last_comparison, &depth, comparator);
+    TracyPlot(profile::splay_depth, (int64_t)depth);
+    if (depth > tree->splay_depth) {
+        splay(node);
+        tree->root = node;
+    }
+    return Iterator<T>{node};
+}
 
-    splay(parent);
-    tree->root = parent;
+template <class T, class Comparator>
+static Iterator<const T> find_gen(const Tree<T>* tree,
+                                  int64_t* last_comparison,
+                                  Comparator&& comparator) {
+    Node<T>* node = gen::find_comparator(tree->root, last_comparison, comparator);
+    return Iterator<T>{node};
+}
+
+template <class T, class Comparator>
+static Iterator<T> find_from_gen(Tree<T>* tree,
+                                 Iterator<T> finger,
+                                 int64_t* last_comparison,
+                                 Comparator&& comparator) {
+    if (!finger.node)
+        return find_gen(tree, last_comparison, comparator);
+
+    size_t steps;
+    Node<T>* node = gen::find_from_comparator(finger.node, last_comparison, &steps, comparator);
+    TracyPlot(profile::splay_depth, (int64_t)steps);
+    if (tree->splay_depth == 0 || steps > tree->splay_depth) {
+        splay(node);
+        tree->root = node;
+    }
+    return Iterator<T>{node};
+}
 
-    return Iterator<T>{parent};
+namespace detail {
+template <class T>
+struct Rightmost_Comparator {
+    int64_t operator()(const T&) const { return 1; }
+};
 }
 
 template <class T>
 bool Tree<T>::insert(cz::Allocator allocator, const T& element) {
     ZoneScoped;
 
-    // Special case empty tree.
-    if (!root) {
-        Node<T>* node = allocator.alloc<Node<T> >();
-        CZ_ASSERT(node);
-        node->parent = nullptr;
-        node->left = nullptr;
-        node->right = nullptr;
-        node->element = element;
-        root = node;
-        return true;
-    }
-
+    // Splay the closest node to the root.
     int64_t last_comparison;
-    Node<T>* guess = gen::find(root, &last_comparison, element);
+    root = splay_comparator(root, &last_comparison, gen::element_comparator(element));
 
     // Already present.
-    if (last_comparison == 0) {
+    if (root && last_comparison == 0) {
         return false;
     }
 
-    // Insert node.
-    // Create parent node.
     Node<T>* node = allocator.alloc<Node<T> >();
     CZ_ASSERT(node);
-    CZ_DEBUG_ASSERT(guess);
-
+    TracyAllocN(node, sizeof(Node<T>), profile::splay_nodes);
+    node->parent = nullptr;
     node->element = element;
 
-    // Hook parent.
-    node->parent = guess->parent;
-    if (node->parent) {
-        if (node->parent->left == guess) {
-            node->parent->left = node;
-        } else {
-            node->parent->right = node;
-        }
-    } else {
-        // Done below.
-        // root = node;
-    }
-
-    // Child's side depends on its relationship to element.
-    if (last_comparison > 0) {
-        node->left = guess;
+    // Split the old root's children around the new node.
+    if (!root) {
+        node->left = nullptr;
         node->right = nullptr;
+    } else if (last_comparison > 0) {
+        node->left = root;
+        node->right = root->right;
+        root->right = nullptr;
         using cz::compare;
         CZ_DEBUG_ASSERT(compare(node->element, ((Node<T>*)node->left)->element) > 0);
     } else {
-        node->left = nullptr;
-        node->right = guess;
+        node->left = root->left;
+        node->right = root;
+        root->left = nullptr;
         using cz::compare;
         CZ_DEBUG_ASSERT(compare(node->element, ((Node<T>*)node->right)->element) < 0);
     }
-    guess->parent = node;
 
-    splay(node);
-    root = node;
+    if (node->left)
+        node->left->parent = node;
+    if (node->right)
+        node->right->parent = node;
 
+    root = node;
+    if (num_elements != UNKNOWN_COUNT) {
+        ++num_elements;
+        TracyPlot(profile::splay_count, (int64_t)num_elements);
+    }
     return true;
 }
 
@@ -96,11 +250,158 @@ void Tree<T>::remove(cz::Allocator allocator, Iterator<const T> iterator) {
     if (iterator == end())
         return;
 
-    Node<T>* new_node = (Node<T>*)gen::remove(iterator.node);
-    allocator.dealloc(iterator.node);
+    Node<T>* node = (Node<T>*)iterator.node;
+
+    int64_t last_comparison;
+    root = splay_comparator(root, &last_comparison, gen::element_comparator(node->element));
+    CZ_DEBUG_ASSERT(root == node);
+
+    // Join the two subtrees.  The maximum of the left subtree has no right child.
+    Node<T>* left = (Node<T>*)node->left;
+    Node<T>* right = (Node<T>*)node->right;
+    if (left) {
+        left->parent = nullptr;
+        left = splay_comparator(left, &last_comparison, detail::Rightmost_Comparator<T>{});
+        CZ_DEBUG_ASSERT(!left->right);
+        left->right = right;
+        if (right)
+            right->parent = left;
+        root = left;
+    } else {
+        if (right)
+            right->parent = nullptr;
+        root = right;
+    }
+
+    blocks = detail::group_owner(blocks);
+    if (!detail::Block_Group<T>{blocks}.contains(node)) {
+        TracyFreeN(node, profile::splay_nodes);
+        allocator.dealloc(node);
+    }
+    if (num_elements != UNKNOWN_COUNT) {
+        --num_elements;
+        TracyPlot(profile::splay_count, (int64_t)num_elements);
+    }
+}
+
+namespace detail {
+/// Link `nodes` into a perfectly balanced subtree and return its root.
+template <class T>
+Node<T>* build_balanced(Node<T>* nodes, size_t len, Node<T>* parent) {
+    if (len == 0)
+        return nullptr;
+
+    size_t middle = len / 2;
+    Node<T>* node = &nodes[middle];
+    node->parent = parent;
+    node->left = build_balanced(nodes, middle, node);
+    node->right = build_balanced(nodes + middle + 1, len - middle - 1, node);
+    return node;
+}
+}
+
+template <class T>
+void Tree<T>::build_from_sorted(cz::Allocator allocator, cz::Slice<const T> elements) {
+    ZoneScoped;
+
+    CZ_ASSERT(!root);
+    if (elements.len == 0)
+        return;
+
+    size_t bytes = detail::block_bytes<T>(elements.len);
+    size_t alignment = alignof(Node<T>) > alignof(Node_Block<T>) ? alignof(Node<T>)
+                                                                  : alignof(Node_Block<T>);
+    Node_Block<T>* block = (Node_Block<T>*)allocator.alloc({bytes, alignment});
+    CZ_ASSERT(block);
+    TracyAllocN(block, bytes, profile::splay_nodes);
+    block->len = elements.len;
 
-    splay(new_node);
-    root = new_node;
+    // An empty tree can still reference a group so add the block to it.
+    Node_Block<T>* owner = detail::group_owner(blocks);
+    if (owner) {
+        detail::group_add(owner, block);
+    } else {
+        block->owner = nullptr;
+        block->next = nullptr;
+        block->left = nullptr;
+        block->right = nullptr;
+        block->index = block;
+        block->references = 1;
+        block->num_blocks = 1;
+        blocks = block;
+    }
+
+    Node<T>* nodes = detail::block_nodes(block);
+    for (size_t i = 0; i < elements.len; ++i) {
+        using cz::compare;
+        CZ_DEBUG_ASSERT(i == 0 || compare(elements[i - 1], elements[i]) < 0);
+        nodes[i].element = elements[i];
+    }
+
+    root = detail::build_balanced(nodes, elements.len, (Node<T>*)nullptr);
+    num_elements = elements.len;
+    TracyPlot(profile::splay_count, (int64_t)num_elements);
+}
+
+template <class T>
+const size_t Tree<T>::UNKNOWN_COUNT;
+
+template <class T>
+size_t Tree<T>::count() const {
+    if (num_elements == UNKNOWN_COUNT) {
+        num_elements = gen::count(root);
+        TracyPlot(profile::splay_count, (int64_t)num_elements);
+    }
+    return num_elements;
+}
+
+template <class T>
+Tree<T> Tree<T>::split(const T& pivot) {
+    return detail::split_comparator(this, gen::element_comparator(pivot));
+}
+
+template <class T>
+void Tree<T>::join(Tree* right) {
+    ZoneScoped;
+
+    // Take over `right`'s reference to its blocks, merging the groups if they differ.
+    Node_Block<T>* owner = detail::group_owner(blocks);
+    Node_Block<T>* right_owner = detail::group_owner(right->blocks);
+    if (!owner) {
+        owner = right_owner;
+    } else if (owner == right_owner) {
+        --owner->references;
+    } else if (right_owner) {
+        // Move the smaller group into the larger one so each block moves O(log blocks) times.
+        if (owner->num_blocks < right_owner->num_blocks) {
+            Node_Block<T>* temp = owner;
+            owner = right_owner;
+            right_owner = temp;
+        }
+        detail::group_merge(owner, right_owner);
+        --owner->references;
+    }
+    blocks = owner;
+    right->blocks = nullptr;
+
+    if (!root) {
+        root = right->root;
+    } else if (right->root) {
+        // After splaying the maximum to the root it has no right child.
+        int64_t last_comparison;
+        root = splay_comparator(root, &last_comparison, detail::Rightmost_Comparator<T>{});
+        CZ_DEBUG_ASSERT(!root->right);
+        root->right = right->root;
+        root->right->parent = root;
+    }
+
+    if (num_elements == UNKNOWN_COUNT || right->num_elements == UNKNOWN_COUNT) {
+        num_elements = UNKNOWN_COUNT;
+    } else {
+        num_elements += right->num_elements;
+    }
+    right->root = nullptr;
+    right->num_elements = 0;
 }
 
 template <class T>
@@ -142,75 +443,200 @@ Iterator<T> Tree<T>::find_greater_equal(const T& element) {
     return detail::find_greater_equal_comparator(this, gen::element_comparator(element));
 }
 
+template <class T>
+Iterator<T> Tree<T>::find_equal_from(Iterator<T> finger, const T& element) {
+    return detail::find_equal_from_comparator(this, finger, gen::element_comparator(element));
+}
+template <class T>
+Iterator<T> Tree<T>::find_less_from(Iterator<T> finger, const T& element) {
+    return detail::find_less_from_comparator(this, finger, gen::element_comparator(element));
+}
+template <class T>
+Iterator<T> Tree<T>::find_greater_from(Iterator<T> finger, const T& element) {
+    return detail::find_greater_from_comparator(this, finger, gen::element_comparator(element));
+}
+template <class T>
+Iterator<T> Tree<T>::find_less_equal_from(Iterator<T> finger, const T& element) {
+    return detail::find_less_equal_from_comparator(this, finger, gen::element_comparator(element));
+}
+template <class T>
+Iterator<T> Tree<T>::find_greater_equal_from(Iterator<T> finger, const T& element) {
+    return detail::find_greater_equal_from_comparator(this, finger,
+                                                      gen::element_comparator(element));
+}
+
+template <class T>
+Iterator<const T> Tree<T>::find_equal(const T& element) const {
+    return detail::find_equal_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<const T> Tree<T>::find_less(const T& element) const {
+    return detail::find_less_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<const T> Tree<T>::find_greater(const T& element) const {
+    return detail::find_greater_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<const T> Tree<T>::find_less_equal(const T& element) const {
+    return detail::find_less_equal_comparator(this, gen::element_comparator(element));
+}
+template <class T>
+Iterator<const T> Tree<T>::find_greater_equal(const T& element) const {
+    return detail::find_greater_equal_comparator(this, gen::element_comparator(element));
+}
+
 namespace detail {
 
 template <class T, class Comparator>
-Iterator<T> find_equal_comparator(Tree<T>* tree, Comparator&& comparator) {
+Tree<T> split_comparator(Tree<T>* tree, Comparator&& comparator) {
+    ZoneScoped;
+
+    Tree<T> right = {};
+    right.splay_depth = tree->splay_depth;
+    if (!tree->root)
+        return right;
+
     int64_t last_comparison;
-    Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
-    if (last_comparison == 0) {
-        return iterator;
+    Node<T>* root = splay_comparator(tree->root, &last_comparison, comparator);
+
+    // Detach the subtree on the other side of the pivot.
+    if (last_comparison <= 0) {
+        right.root = root;
+        tree->root = (Node<T>*)root->left;
+        root->left = nullptr;
     } else {
-        return tree->end();
+        tree->root = root;
+        right.root = (Node<T>*)root->right;
+        root->right = nullptr;
     }
+    if (tree->root)
+        tree->root->parent = nullptr;
+    if (right.root)
+        right.root->parent = nullptr;
+
+    // Both halves may have nodes in the blocks so share them.
+    tree->blocks = group_owner(tree->blocks);
+    if (right.root && tree->blocks) {
+        right.blocks = tree->blocks;
+        ++right.blocks->references;
+    }
+
+    // Counting the halves would walk one of them so wait until `count` is called.
+    if (!right.root) {
+        right.num_elements = 0;
+    } else if (!tree->root) {
+        right.num_elements = tree->num_elements;
+        tree->num_elements = 0;
+    } else {
+        right.num_elements = Tree<T>::UNKNOWN_COUNT;
+        tree->num_elements = Tree<T>::UNKNOWN_COUNT;
+    }
+    return right;
+}
+
+
+template <class T, class Comparator>
+Iterator<T> find_equal_comparator(Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_equal(iterator, last_comparison, comparator);
 }
 template <class T, class Comparator>
 Iterator<T> find_less_comparator(Tree<T>* tree, Comparator&& comparator) {
     int64_t last_comparison;
     Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
-    if (last_comparison > 0) {
-        return iterator;
-        // Not necessary because --tree->start() == tree->end().
-        // } else if (iterator == tree->start()) {
-        //     return tree->end();
-    } else {
-        --iterator;
-        CZ_DEBUG_ASSERT(iterator == tree->end() || comparator(*iterator) > 0);
-        return iterator;
-    }
+    return gen::select_less(iterator, last_comparison, comparator);
 }
 template <class T, class Comparator>
 Iterator<T> find_greater_comparator(Tree<T>* tree, Comparator&& comparator) {
     int64_t last_comparison;
     Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
-    if (last_comparison < 0) {
-        return iterator;
-    } else if (iterator == tree->end()) {
-        return tree->end();
-    } else {
-        ++iterator;
-        CZ_DEBUG_ASSERT(iterator == tree->end() || comparator(*iterator) < 0);
-        return iterator;
-    }
+    return gen::select_greater(iterator, last_comparison, comparator);
 }
 template <class T, class Comparator>
 Iterator<T> find_less_equal_comparator(Tree<T>* tree, Comparator&& comparator) {
     int64_t last_comparison;
     Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
-    if (last_comparison >= 0) {
-        return iterator;
-        // Not necessary because --tree->start() == tree->end().
-        // } else if (iterator == start()) {
-        //     return tree->end();
-    } else {
-        --iterator;
-        CZ_DEBUG_ASSERT(iterator == tree->end() || comparator(*iterator) > 0);
-        return iterator;
-    }
+    return gen::select_less_equal(iterator, last_comparison, comparator);
 }
 template <class T, class Comparator>
 Iterator<T> find_greater_equal_comparator(Tree<T>* tree, Comparator&& comparator) {
     int64_t last_comparison;
     Iterator<T> iterator = find_gen(tree, &last_comparison, comparator);
-    if (last_comparison <= 0) {
-        return iterator;
-    } else if (iterator == tree->end()) {
-        return tree->end();
-    } else {
-        ++iterator;
-        CZ_DEBUG_ASSERT(iterator == tree->end() || comparator(*iterator) < 0);
-        return iterator;
-    }
+    return gen::select_greater_equal(iterator, last_comparison, comparator);
+}
+
+template <class T, class Comparator>
+Iterator<T> find_equal_from_comparator(Tree<T>* tree,
+                                       Iterator<T> finger,
+                                       Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_from_gen(tree, finger, &last_comparison, comparator);
+    return gen::select_equal(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<T> find_less_from_comparator(Tree<T>* tree,
+                                      Iterator<T> finger,
+                                      Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_from_gen(tree, finger, &last_comparison, comparator);
+    return gen::select_less(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<T> find_greater_from_comparator(Tree<T>* tree,
+                                         Iterator<T> finger,
+                                         Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_from_gen(tree, finger, &last_comparison, comparator);
+    return gen::select_greater(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<T> find_less_equal_from_comparator(Tree<T>* tree,
+                                            Iterator<T> finger,
+                                            Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_from_gen(tree, finger, &last_comparison, comparator);
+    return gen::select_less_equal(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<T> find_greater_equal_from_comparator(Tree<T>* tree,
+                                               Iterator<T> finger,
+                                               Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<T> iterator = find_from_gen(tree, finger, &last_comparison, comparator);
+    return gen::select_greater_equal(iterator, last_comparison, comparator);
+}
+
+template <class T, class Comparator>
+Iterator<const T> find_equal_comparator(const Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<const T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_equal(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<const T> find_less_comparator(const Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<const T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_less(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<const T> find_greater_comparator(const Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<const T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_greater(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<const T> find_less_equal_comparator(const Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<const T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_less_equal(iterator, last_comparison, comparator);
+}
+template <class T, class Comparator>
+Iterator<const T> find_greater_equal_comparator(const Tree<T>* tree, Comparator&& comparator) {
+    int64_t last_comparison;
+    Iterator<const T> iterator = find_gen(tree, &last_comparison, comparator);
+    return gen::select_greater_equal(iterator, last_comparison, comparator);
 }
 
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cz/allocator.hpp>
+#include <cz/slice.hpp>
 #include "gen_tree.hpp"
 
 namespace ds {
@@ -9,6 +10,48 @@ namespace splay {
 using gen::Iterator;
 using gen::Node;
 
+/// Nodes allocated together by `Tree::build_from_sorted`.  The nodes follow this
+/// header in the same allocation.  Nodes move freely between trees with `split` and
+/// `join` so blocks are shared.  Every tree using a block holds a reference to it.
+///
+/// Joining trees with different blocks merges them into a group.  One block of a
+/// group owns it: the other blocks point directly to it through `owner` and are in
+/// its `next` list.  The whole group is freed when the last tree referencing it is
+/// dropped.  The blocks are also indexed by address in a treap so finding the block
+/// containing a node is O(log blocks).
+template <class T>
+struct Node_Block {
+    /// The block owning this block's group or `nullptr` if this block is the owner.
+    Node_Block* owner;
+    /// The next block in the group.  Only the owner's list is complete.
+    Node_Block* next;
+    /// The children in the index.  Blocks with lower addresses are to the left.
+    Node_Block* left;
+    Node_Block* right;
+    /// The root of the index.  Only kept by the owner.
+    Node_Block* index;
+    /// The number of trees referencing the group.  Only kept by the owner.
+    size_t references;
+    /// The number of blocks in the group.  Only kept by the owner.
+    size_t num_blocks;
+    /// The number of nodes in this block.
+    size_t len;
+};
+
+namespace detail {
+/// The blocks in the group owned by `owner`.  See `gen::No_Blocks`.
+template <class T>
+struct Block_Group {
+    const Node_Block<T>* owner;
+
+    bool contains(const gen::Node_Base* node) const;
+    size_t num_nodes() const;
+};
+
+template <class T>
+Node_Block<T>* group_owner(Node_Block<T>* block);
+}
+
 template <class T>
 struct Tree {
     void drop(cz::Allocator allocator);
@@ -21,6 +64,20 @@ struct Tree {
     /// If the iterator is `end` then nothing is done.
     void remove(cz::Allocator allocator, Iterator<const T> iterator);
 
+    /// Build a perfectly balanced tree from strictly increasing `elements` in O(n).
+    /// The nodes are allocated in one block, in order, for locality.  The tree must be empty.
+    void build_from_sorted(cz::Allocator allocator, cz::Slice<const T> elements);
+
+    /// Remove every element greater than or equal to `pivot` from
+    /// this tree and return them as a new tree.  The elements stay
+    /// in their nodes so this does not allocate.  This is O(log n) amortized.
+    /// Neither half knows its count afterwards.  See `count`.
+    Tree split(const T& pivot);
+
+    /// Move every element from `right` to the end of this tree.  Every element
+    /// in `right` must be greater than every element in this tree.  `right` is left empty.
+    void join(Tree* right);
+
     /// Get iterators allowing you to iterate through the entire tree.
     Iterator<T> start();
     Iterator<T> end();
@@ -37,6 +94,8 @@ struct Tree {
     /// ```
     Iterator<T> start_iter(const T& first) { return find_greater_equal(first); }
     Iterator<T> end_iter(const T& last) { return find_greater_equal(last); }
+    Iterator<const T> start_iter(const T& first) const { return find_greater_equal(first); }
+    Iterator<const T> end_iter(const T& last) const { return find_greater_equal(last); }
 
     /// Get iterators based on the position of the query.
     /// If there are no matches then `end` is returned.
@@ -48,17 +107,69 @@ struct Tree {
     Iterator<T> find_less_equal(const T& query);
     Iterator<T> find_greater_equal(const T& query);
 
+    /// Same as above except the search starts at `finger` (typically the result of
+    /// the previous search) instead of the root.  This is O(log d) amortized where `d`
+    /// is the number of elements between `finger` and the result, so walking through
+    /// the tree with a cursor is much cheaper than searching from the root each time.
+    /// If `finger` is `end` then this searches from the root.
+    ///
+    /// If `splay_depth` is non-zero then the result is only splayed when the
+    /// search visited more than `splay_depth` nodes, so successive accesses to
+    /// neighboring elements don't restructure the tree at all.
+    Iterator<T> find_from(Iterator<T> finger, const T& query) {
+        return find_equal_from(finger, query);
+    }
+    Iterator<T> find_equal_from(Iterator<T> finger, const T& query);
+    Iterator<T> find_less_from(Iterator<T> finger, const T& query);
+    Iterator<T> find_greater_from(Iterator<T> finger, const T& query);
+    Iterator<T> find_less_equal_from(Iterator<T> finger, const T& query);
+    Iterator<T> find_greater_equal_from(Iterator<T> finger, const T& query);
+
+    /// Same as above except these don't `splay` so multiple threads can search at once.
+    Iterator<const T> find(const T& query) const { return find_equal(query); }
+    Iterator<const T> find_equal(const T& query) const;
+    Iterator<const T> find_less(const T& query) const;
+    Iterator<const T> find_greater(const T& query) const;
+    Iterator<const T> find_less_equal(const T& query) const;
+    Iterator<const T> find_greater_equal(const T& query) const;
+
     bool contains(const T& element) { return find(element) != end(); }
+    bool contains(const T& element) const { return find(element) != end(); }
 
-    size_t count() const { return gen::count(root); }
+    /// Get the number of elements.  After a `split` the first call walks the
+    /// tree in O(n) and remembers the result so later calls are O(1).
+    size_t count() const;
+
+    /// Measure the shape and memory use of the tree.  This walks every node.
+    gen::Tree_Stats stats() const {
+        return gen::measure(root, detail::Block_Group<T>{detail::group_owner(blocks)});
+    }
 
     Node<T>* root;
+
+    /// The number of elements or `UNKNOWN_COUNT` if it hasn't been counted since a `split`.
+    /// This is `mutable` so `count` can remember the result even when called through a const
+    /// reference.  Thus `count` must not be called concurrently after a `split`.
+    mutable size_t num_elements;
+    static const size_t UNKNOWN_COUNT = (size_t)-1;
+
+    /// The group of blocks allocated by `build_from_sorted` that
+    /// this tree references or `nullptr`.  See `Node_Block`.
+    Node_Block<T>* blocks;
+
+    /// If non-zero then the non-const `find` methods only `splay` when the node
+    /// found is deeper than this.  This makes lookups in a read mostly tree
+    /// cheaper at the cost of the tree adapting more slowly to the access pattern.
+    size_t splay_depth;
 };
 
 namespace detail {
 
 /// Same as `Tree` methods above except uses `comparator(node->element)`
 /// instead of `compare(query, node->element)` to compare.
+template <class T, class Comparator>
+Tree<T> split_comparator(Tree<T>* tree, Comparator&& comparator);
+
 template <class T, class Comparator>
 Iterator<T> find_equal_comparator(Tree<T>* tree, Comparator&& comparator);
 template <class T, class Comparator>
@@ -70,6 +181,38 @@ Iterator<T> find_less_equal_comparator(Tree<T>* tree, Comparator&& comparator);
 template <class T, class Comparator>
 Iterator<T> find_greater_equal_comparator(Tree<T>* tree, Comparator&& comparator);
 
+template <class T, class Comparator>
+Iterator<T> find_equal_from_comparator(Tree<T>* tree,
+                                       Iterator<T> finger,
+                                       Comparator&& comparator);
+template <class T, class Comparator>
+Iterator<T> find_less_from_comparator(Tree<T>* tree,
+                                      Iterator<T> finger,
+                                      Comparator&& comparator);
+template <class T, class Comparator>
+Iterator<T> find_greater_from_comparator(Tree<T>* tree,
+                                         Iterator<T> finger,
+                                         Comparator&& comparator);
+template <class T, class Comparator>
+Iterator<T> find_less_equal_from_comparator(Tree<T>* tree,
+                                            Iterator<T> finger,
+                                            Comparator&& comparator);
+template <class T, class Comparator>
+Iterator<T> find_greater_equal_from_comparator(Tree<T>* tree,
+                                               Iterator<T> finger,
+                                               Comparator&& comparator);
+
+template <class T, class Comparator>
+Iterator<const T> find_equal_comparator(const Tree<T>* tree, Comparator&& comparator);
+template <class T, class Comparator>
+Iterator<const T> find_less_comparator(const Tree<T>* tree, Comparator&& comparator);
+template <class T, class Comparator>
+Iterator<const T> find_greater_comparator(const Tree<T>* tree, Comparator&& comparator);
+template <class T, class Comparator>
+Iterator<const T> find_less_equal_comparator(const Tree<T>* tree, Comparator&& comparator);
+template <class T, class Comparator>
+Iterator<const T> find_greater_equal_comparator(const Tree<T>* tree, Comparator&& comparator);
+
 }
 
 }
@@ -1,5 +1,7 @@
 #include "ssostr.hpp"
 
+#include "string_arena.hpp"
+
 namespace ds {
 namespace detail {
 
@@ -26,9 +28,65 @@ size_t Allocated_Str::len() const {
 
 void Short_Str::init(cz::Str str) {
     memcpy(_buffer, str.buffer, str.len);
+    memset(_buffer + str.len, 0, MAX - str.len);
     _buffer[MAX] = (char)((str.len << 1) | 1);
 }
 
+int64_t compare_long(cz::Str left, cz::Str right) {
+    // `memcmp` is already vectorized by the C library.
+    size_t len = left.len < right.len ? left.len : right.len;
+    int result = memcmp(left.buffer, right.buffer, len);
+    if (result != 0)
+        return result;
+    if (left.len == right.len)
+        return 0;
+    return left.len < right.len ? -1 : 1;
+}
+
+static const uint64_t HASH_MULTIPLIER = 0x9e3779b97f4a7c15;
+
+static uint64_t hash_word(uint64_t hash, uint64_t word) {
+    hash ^= word;
+    hash *= HASH_MULTIPLIER;
+    return hash ^ (hash >> 29);
+}
+
+/// Murmur3's finalizer so every input bit affects both the high and low bits.
+static uint64_t hash_finish(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccd;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+uint64_t hash_short(const Short_Str& str) {
+    uint64_t hash = 0;
+    for (size_t i = 0; i < sizeof(Short_Str); i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, str._buffer + i, sizeof(word));
+        hash = hash_word(hash, word);
+    }
+    return hash_finish(hash);
+}
+
+uint64_t hash_long(cz::Str str) {
+    uint64_t hash = str.len;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= str.len; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, str.buffer + i, sizeof(word));
+        hash = hash_word(hash, word);
+    }
+    if (i < str.len) {
+        uint64_t word = 0;
+        memcpy(&word, str.buffer + i, str.len - i);
+        hash = hash_word(hash, word);
+    }
+    return hash_finish(hash);
+}
+
 }
 
 SSOStr SSOStr::from_constant(cz::Str str) {
@@ -64,4 +122,11 @@ SSOStr SSOStr::as_duplicate(cz::Allocator allocator, cz::Str str) {
     return self;
 }
 
+SSOStr SSOStr::in_arena(String_Arena* arena, cz::Allocator allocator, cz::Str str) {
+    if (str.len <= detail::Short_Str::MAX) {
+        return SSOStr::from_constant(str);
+    }
+    return SSOStr::from_constant(arena->duplicate(allocator, str));
+}
+
 }
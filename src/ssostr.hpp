@@ -1,13 +1,20 @@
 #pragma once
 
 #include <limits.h>
+#include <stdint.h>
 #include <string.h>
 #include <cz/allocator.hpp>
 #include <cz/str.hpp>
 #include <new>
 
+#ifdef _MSC_VER
+#include <stdlib.h>
+#endif
+
 namespace ds {
 
+struct String_Arena;
+
 namespace detail {
 
 struct Allocated_Str {
@@ -22,6 +29,8 @@ struct Allocated_Str {
     size_t len() const;
 };
 
+/// The bytes after the string are zeroed so two short strings
+/// can be compared as whole words.  See `compare_short`.
 struct Short_Str {
     constexpr static const size_t MAX = sizeof(Allocated_Str) - 1;
 
@@ -49,6 +58,10 @@ struct SSOStr {
 
     static SSOStr as_duplicate(cz::Allocator allocator, cz::Str str);
 
+    /// Same as `as_duplicate` except long strings are copied into `arena`.
+    /// The result must not be dropped; it is freed when `arena` is reset or dropped.
+    static SSOStr in_arena(String_Arena* arena, cz::Allocator allocator, cz::Str str);
+
     void drop(cz::Allocator allocator) {
         if (!is_short()) {
             allocated.drop(allocator);
@@ -84,6 +97,88 @@ struct SSOStr {
     SSOStr clone(cz::Allocator allocator) const {
         return SSOStr::as_duplicate(allocator, as_str());
     }
+
+    /// Hash the contents.  Equal strings have equal hashes.
+    uint64_t hash() const;
+
+    bool operator==(const SSOStr& other) const;
+    bool operator!=(const SSOStr& other) const { return !(*this == other); }
+    bool operator<(const SSOStr& other) const;
+    bool operator>(const SSOStr& other) const { return other < *this; }
+    bool operator<=(const SSOStr& other) const { return !(other < *this); }
+    bool operator>=(const SSOStr& other) const { return !(*this < other); }
 };
 
+/// Compare the contents lexicographically.  This is in `ds` so
+/// it is found by argument dependent lookup from `cz::compare`
+/// call sites (`using cz::compare; compare(a, b);`).
+int64_t compare(const SSOStr& left, const SSOStr& right);
+
+namespace detail {
+
+/// Load 8 bytes such that comparing the results as integers compares the bytes.
+inline uint64_t load_big_endian(const char* buffer) {
+    uint64_t word;
+    memcpy(&word, buffer, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return word;
+#elif defined(_MSC_VER)
+    return _byteswap_uint64(word);
+#else
+    return __builtin_bswap64(word);
+#endif
+}
+
+/// Compare two short strings.  Because the padding is zeroed and the last
+/// byte is `(len << 1) | 1`, the whole buffer read as a big endian integer
+/// orders the same as the string.  This is two word comparisons on 64 bit.
+inline int64_t compare_short(const Short_Str& left, const Short_Str& right) {
+    static_assert(sizeof(Short_Str) % sizeof(uint64_t) == 0, "Short_Str must be whole words");
+    for (size_t i = 0; i < sizeof(Short_Str); i += sizeof(uint64_t)) {
+        uint64_t l = load_big_endian(left._buffer + i);
+        uint64_t r = load_big_endian(right._buffer + i);
+        if (l != r)
+            return l < r ? -1 : 1;
+    }
+    return 0;
+}
+
+int64_t compare_long(cz::Str left, cz::Str right);
+
+uint64_t hash_short(const Short_Str& str);
+uint64_t hash_long(cz::Str str);
+
+}
+
+inline int64_t compare(const SSOStr& left, const SSOStr& right) {
+    if (left.is_short() && right.is_short())
+        return detail::compare_short(left.short_, right.short_);
+    return detail::compare_long(left.as_str(), right.as_str());
+}
+
+inline bool SSOStr::operator==(const SSOStr& other) const {
+    // Strings of `MAX_SHORT_LEN` or fewer characters are always short so a
+    // short string never equals a long one.  The flag bit makes them differ here.
+    if (is_short() || other.is_short())
+        return memcmp(&short_, &other.short_, sizeof(short_)) == 0;
+
+    size_t length = allocated.len();
+    if (length != other.allocated.len())
+        return false;
+    // Interned strings share buffers.
+    if (allocated.buffer() == other.allocated.buffer())
+        return true;
+    return memcmp(allocated.buffer(), other.allocated.buffer(), length) == 0;
+}
+
+inline bool SSOStr::operator<(const SSOStr& other) const {
+    return compare(*this, other) < 0;
+}
+
+inline uint64_t SSOStr::hash() const {
+    if (is_short())
+        return detail::hash_short(short_);
+    return detail::hash_long(as_str());
+}
+
 }
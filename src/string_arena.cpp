@@ -0,0 +1,89 @@
+#include "string_arena.hpp"
+
+#include <string.h>
+#include <Tracy.hpp>
+
+namespace ds {
+
+static const size_t DEFAULT_CHUNK_SIZE = 1 << 16;
+
+void String_Arena::drop(cz::Allocator allocator) {
+    detail::String_Arena_Chunk* chunk = first;
+    while (chunk) {
+        detail::String_Arena_Chunk* next = chunk->next;
+        allocator.dealloc({chunk, chunk->size});
+        chunk = next;
+    }
+}
+
+static char* chunk_start(detail::String_Arena_Chunk* chunk) {
+    return (char*)(chunk + 1);
+}
+
+void String_Arena::reset() {
+    current = first;
+    if (first) {
+        pos = chunk_start(first);
+        end = (char*)first + first->size;
+    } else {
+        pos = nullptr;
+        end = nullptr;
+    }
+}
+
+static char* align_up(char* pointer, size_t alignment) {
+    size_t misalignment = (size_t)pointer & (alignment - 1);
+    return misalignment ? pointer + (alignment - misalignment) : pointer;
+}
+
+/// Advance to a chunk with room for `len` bytes, reusing chunks left by `reset` when they fit.
+static void next_chunk(String_Arena* arena, cz::Allocator allocator, size_t len, size_t alignment) {
+    ZoneScoped;
+
+    size_t needed = sizeof(detail::String_Arena_Chunk) + len + alignment - 1;
+    detail::String_Arena_Chunk* previous = arena->current;
+    detail::String_Arena_Chunk* chunk = previous ? previous->next : arena->first;
+
+    // An old chunk that is too small is moved after the new one so it is tried again next time.
+    if (!chunk || chunk->size < needed) {
+        size_t size = arena->chunk_size ? arena->chunk_size : DEFAULT_CHUNK_SIZE;
+        if (size < needed)
+            size = needed;
+
+        detail::String_Arena_Chunk* fresh = (detail::String_Arena_Chunk*)allocator.alloc(
+            {size, alignof(detail::String_Arena_Chunk)});
+        CZ_ASSERT(fresh);
+        fresh->size = size;
+        fresh->next = chunk;
+        if (previous)
+            previous->next = fresh;
+        else
+            arena->first = fresh;
+        chunk = fresh;
+    }
+
+    arena->current = chunk;
+    arena->pos = chunk_start(chunk);
+    arena->end = (char*)chunk + chunk->size;
+}
+
+char* String_Arena::alloc(cz::Allocator allocator, size_t len, size_t alignment) {
+    CZ_DEBUG_ASSERT((alignment & (alignment - 1)) == 0);
+
+    char* result = align_up(pos, alignment);
+    if (!pos || result > end || (size_t)(end - result) < len) {
+        next_chunk(this, allocator, len, alignment);
+        result = align_up(pos, alignment);
+    }
+
+    pos = result + len;
+    return result;
+}
+
+cz::Str String_Arena::duplicate(cz::Allocator allocator, cz::Str str) {
+    char* buffer = alloc(allocator, str.len);
+    memcpy(buffer, str.buffer, str.len);
+    return {buffer, str.len};
+}
+
+}
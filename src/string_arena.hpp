@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stddef.h>
+#include <cz/allocator.hpp>
+#include <cz/str.hpp>
+
+namespace ds {
+
+namespace detail {
+struct String_Arena_Chunk {
+    String_Arena_Chunk* next;
+    size_t size;
+};
+}
+
+/// Append only storage for many small allocations that are all freed at once.
+/// Memory is carved out of large chunks so there is no per string header or
+/// bookkeeping.  `reset` forgets every allocation in O(1) but keeps the chunks
+/// to be reused, which suits parse then discard workloads.
+struct String_Arena {
+    /// Deallocate every chunk.
+    void drop(cz::Allocator allocator);
+
+    /// Forget every allocation.  The chunks are kept and reused.
+    void reset();
+
+    /// Allocate `len` bytes.  The default alignment of 1 packs strings back to back.
+    char* alloc(cz::Allocator allocator, size_t len, size_t alignment = 1);
+
+    /// Copy `str` into the arena.
+    cz::Str duplicate(cz::Allocator allocator, cz::Str str);
+
+    /// Chunks in the order they are filled.  Chunks after `current` are empty.
+    detail::String_Arena_Chunk* first;
+    detail::String_Arena_Chunk* current;
+    char* pos;
+    char* end;
+
+    /// The minimum size of a chunk.  If zero then 64KiB is used.
+    size_t chunk_size;
+};
+
+}
@@ -0,0 +1,67 @@
+#include "string_pool.hpp"
+
+#include <Tracy.hpp>
+
+namespace ds {
+
+void String_Pool::drop(cz::Allocator allocator) {
+    allocator.dealloc(entries, entries_cap);
+    arena.drop(allocator);
+}
+
+static detail::String_Pool_Entry* probe(detail::String_Pool_Entry* entries,
+                                        size_t cap,
+                                        uint64_t hash,
+                                        cz::Str str) {
+    size_t mask = cap - 1;
+    for (size_t index = hash & mask;; index = (index + 1) & mask) {
+        detail::String_Pool_Entry* entry = &entries[index];
+        if (entry->hash == 0)
+            return entry;
+        if (entry->hash == hash && entry->str.as_str() == str)
+            return entry;
+    }
+}
+
+static void grow(String_Pool* pool, cz::Allocator allocator) {
+    size_t new_cap = pool->entries_cap == 0 ? 64 : pool->entries_cap * 2;
+    detail::String_Pool_Entry* new_entries = allocator.alloc<detail::String_Pool_Entry>(new_cap);
+    CZ_ASSERT(new_entries);
+    memset((void*)new_entries, 0, sizeof(detail::String_Pool_Entry) * new_cap);
+
+    for (size_t i = 0; i < pool->entries_cap; ++i) {
+        detail::String_Pool_Entry* entry = &pool->entries[i];
+        if (entry->hash == 0)
+            continue;
+        *probe(new_entries, new_cap, entry->hash, entry->str.as_str()) = *entry;
+    }
+
+    allocator.dealloc(pool->entries, pool->entries_cap);
+    pool->entries = new_entries;
+    pool->entries_cap = new_cap;
+}
+
+SSOStr String_Pool::intern(cz::Allocator allocator, cz::Str str) {
+    ZoneScoped;
+
+    if (str.len <= SSOStr::MAX_SHORT_LEN)
+        return SSOStr::from_constant(str);
+
+    // Keep the load factor at or below 3/4 so probe sequences stay short.
+    if ((entries_len + 1) * 4 > entries_cap * 3)
+        grow(this, allocator);
+
+    uint64_t hash = detail::hash_long(str);
+    if (hash == 0)
+        hash = 1;
+
+    detail::String_Pool_Entry* entry = probe(entries, entries_cap, hash, str);
+    if (entry->hash == 0) {
+        entry->hash = hash;
+        entry->str = SSOStr::in_arena(&arena, allocator, str);
+        ++entries_len;
+    }
+    return entry->str;
+}
+
+}
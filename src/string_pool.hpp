@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <cz/allocator.hpp>
+#include <cz/str.hpp>
+#include "ssostr.hpp"
+#include "string_arena.hpp"
+
+namespace ds {
+
+namespace detail {
+struct String_Pool_Entry {
+    /// Zero marks an empty slot.
+    uint64_t hash;
+    SSOStr str;
+};
+}
+
+/// Deduplicates strings.  Long strings are copied into a `String_Arena`
+/// once and every later request for the same contents gets the same buffer.
+/// Short strings are stored inline in the `SSOStr` so are never looked up.
+///
+/// `SSOStr`s returned by `intern` must not be dropped; they are all
+/// freed at once by `String_Pool::drop`.
+struct String_Pool {
+    void drop(cz::Allocator allocator);
+
+    /// Get the pooled copy of `str`, adding it if it isn't already present.
+    SSOStr intern(cz::Allocator allocator, cz::Str str);
+
+    /// The number of distinct long strings in the pool.
+    size_t count() const { return entries_len; }
+
+    /// Open addressing table with linear probing.  The capacity is a power of two.
+    detail::String_Pool_Entry* entries;
+    size_t entries_len;
+    size_t entries_cap;
+
+    /// Storage for the contents of long strings.
+    String_Arena arena;
+};
+
+/// Test if two strings interned in the same `String_Pool` are equal.  Equal strings
+/// share a buffer so this compares the pointer and length instead of the contents.
+inline bool interned_equal(const SSOStr& left, const SSOStr& right) {
+    return memcmp(&left, &right, sizeof(SSOStr)) == 0;
+}
+
+}
@@ -0,0 +1,135 @@
+#include <czt/test_base.hpp>
+
+#include <cz/defer.hpp>
+#include <cz/heap.hpp>
+#include <random>
+#include "avl_tree.hpp"
+
+using namespace cz;
+using namespace ds::avl;
+
+/// Returns the height.
+template <class T>
+static int val_heights(ds::gen::Node_Base* node) {
+    if (!node)
+        return 0;
+
+    int left = val_heights<T>(node->left);
+    int right = val_heights<T>(node->right);
+    CHECK(left - right <= 1);
+    CHECK(right - left <= 1);
+
+    int height = (left > right ? left : right) + 1;
+    CHECK(((Node<T>*)node)->height == height);
+    return height;
+}
+
+template <class T>
+static void val_tree(const Tree<T>& tree) {
+    ds::gen::val_node<T>(tree.root, nullptr);
+    val_heights<T>(tree.root);
+    CHECK(ds::gen::count(tree.root) == tree.count());
+}
+
+TEST_CASE("AVL_Tree insertion") {
+    Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    CHECK(tree.insert(cz::heap_allocator(), 1));
+    CHECK(tree.insert(cz::heap_allocator(), 2));
+    CHECK(tree.insert(cz::heap_allocator(), 3));
+    CHECK_FALSE(tree.insert(cz::heap_allocator(), 2));
+    val_tree(tree);
+    CHECK(tree.count() == 3);
+    CHECK(tree.root->element == 2);
+
+    Iterator<int> it = tree.start();
+    REQUIRE(it != tree.end());
+    CHECK(*it == 1);
+    ++it;
+    REQUIRE(it != tree.end());
+    CHECK(*it == 2);
+    ++it;
+    REQUIRE(it != tree.end());
+    CHECK(*it == 3);
+    ++it;
+    CHECK(it == tree.end());
+}
+
+TEST_CASE("AVL_Tree find family") {
+    Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    for (int i = 1; i <= 3; ++i) {
+        tree.insert(cz::heap_allocator(), i * 2);
+    }
+
+    CHECK(tree.find(3) == tree.end());
+    CHECK(*tree.find(4) == 4);
+    CHECK(tree.find_less(2) == tree.end());
+    CHECK(*tree.find_less(5) == 4);
+    CHECK(*tree.find_greater(4) == 6);
+    CHECK(tree.find_greater(6) == tree.end());
+    CHECK(*tree.find_less_equal(4) == 4);
+    CHECK(*tree.find_less_equal(5) == 4);
+    CHECK(*tree.find_greater_equal(5) == 6);
+    CHECK(tree.find_greater_equal(7) == tree.end());
+}
+
+TEST_CASE("AVL_Tree linear insertion and removal") {
+    Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+
+    for (int i = 0; i < 4096; ++i) {
+        tree.insert(cz::heap_allocator(), i);
+    }
+    val_tree(tree);
+
+    Iterator<int> iter = tree.start();
+    for (int i = 0; i < 4096; ++i) {
+        REQUIRE(iter != tree.end());
+        CHECK(*iter == i);
+        ++iter;
+    }
+
+    for (int i = 0; i < 4096; ++i) {
+        tree.remove(cz::heap_allocator(), tree.start());
+        if (i % 512 == 0) {
+            val_tree(tree);
+        }
+    }
+
+    CHECK(tree.start() == tree.end());
+    CHECK(tree.count() == 0);
+}
+
+TEST_CASE("AVL_Tree random insertion and removal") {
+    Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+
+    cz::Vector<int> nums = {};
+    CZ_DEFER(nums.drop(cz::heap_allocator()));
+    nums.reserve_exact(cz::heap_allocator(), 2048);
+    while (nums.len < nums.cap) {
+        nums.push((int)nums.len);
+    }
+
+    std::mt19937 g{std::random_device{}()};
+    std::shuffle(nums.begin(), nums.end(), g);
+    for (size_t i = 0; i < nums.len; ++i) {
+        tree.insert(cz::heap_allocator(), nums[i]);
+    }
+    val_tree(tree);
+
+    std::shuffle(nums.begin(), nums.end(), g);
+    for (size_t i = 0; i < nums.len; ++i) {
+        INFO("i = " << i);
+        Iterator<int> it = tree.find(nums[i]);
+        REQUIRE(it != tree.end());
+        tree.remove(cz::heap_allocator(), it);
+        CHECK_FALSE(tree.contains(nums[i]));
+        if (i % 128 == 0) {
+            val_tree(tree);
+        }
+    }
+
+    CHECK(tree.root == nullptr);
+}
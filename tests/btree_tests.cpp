@@ -1,6 +1,9 @@
 #include <czt/test_base.hpp>
 
+#include <random>
+#include <set>
 #include "btree.hpp"
+#include "btree_map.hpp"
 
 using namespace cz;
 using namespace ds::btree;
@@ -386,3 +389,318 @@ TEST_CASE("BTree find_ge") {
     it = btree.find_ge(4);
     CHECK(it == btree.end());
 }
+
+TEST_CASE("BTree stats") {
+    Tree<int, 4> btree = {};
+    CZ_DEFER(btree.drop(cz::heap_allocator()));
+
+    Stats empty = btree.stats();
+    CHECK(empty.nodes == 0);
+    CHECK(empty.height == 0);
+
+    for (int i = 0; i < 100; ++i) {
+        btree.insert(cz::heap_allocator(), i);
+    }
+
+    Stats stats = btree.stats();
+    CHECK(stats.elements == 100);
+    CHECK(stats.maximum_elements == 4);
+    REQUIRE(stats.height >= 3);
+    CHECK(stats.nodes_per_level[0] == 1);
+    CHECK(stats.nodes_per_level[stats.height - 1] == stats.leaves);
+
+    size_t level_total = 0;
+    for (size_t i = 0; i < stats.height; ++i) {
+        level_total += stats.nodes_per_level[i];
+    }
+    CHECK(level_total == stats.nodes);
+
+    size_t fill_total = 0;
+    for (size_t i = 0; i < Stats::FILL_BUCKETS; ++i) {
+        fill_total += stats.fill_histogram[i];
+    }
+    CHECK(fill_total == stats.nodes);
+
+    CHECK(stats.bytes_allocated == stats.nodes * sizeof(Node<int, 4>));
+    CHECK(stats.bytes_payload == 100 * sizeof(int));
+    CHECK(stats.average_elements_per_node() == (double)100 / stats.nodes);
+    CHECK(stats.fill_factor() <= 1);
+}
+
+TEST_CASE("BTree Multi_Tree duplicates") {
+    Multi_Tree<int, 4> btree = {};
+    CZ_DEFER(btree.drop(cz::heap_allocator()));
+
+    btree.insert(cz::heap_allocator(), 3);
+    btree.insert(cz::heap_allocator(), 5);
+    btree.insert(cz::heap_allocator(), 5);
+    btree.insert(cz::heap_allocator(), 7);
+    btree.insert(cz::heap_allocator(), 5);
+    CHECK(btree.count == 5);
+    CHECK(btree.count_eq(5) == 3);
+    CHECK(btree.count_eq(4) == 0);
+
+    Multi_Tree<int, 4>::Range range = btree.equal_range(5);
+    size_t matches = 0;
+    for (Iterator<int, 4> it = range.start; it != range.end; ++it) {
+        CHECK(*it == 5);
+        ++matches;
+    }
+    CHECK(matches == 3);
+
+    REQUIRE(range.end != btree.end());
+    CHECK(*range.end == 7);
+    CHECK(btree.find_eq(5) == range.start);
+    REQUIRE(btree.find_lt(5) != btree.end());
+    CHECK(*btree.find_lt(5) == 3);
+    REQUIRE(btree.find_gt(5) != btree.end());
+    CHECK(*btree.find_gt(5) == 7);
+    REQUIRE(btree.find_le(5) != btree.end());
+    CHECK(*btree.find_le(5) == 5);
+    CHECK(btree.find_eq(4) == btree.end());
+    CHECK(btree.find_lt(3) == btree.end());
+    CHECK(btree.find_gt(7) == btree.end());
+}
+
+TEST_CASE("BTree Multi_Tree random against std::multiset") {
+    Multi_Tree<int, 4> btree = {};
+    CZ_DEFER(btree.drop(cz::heap_allocator()));
+    std::multiset<int> reference;
+
+    std::mt19937 mt;
+    for (int i = 0; i < 5000; ++i) {
+        int element = mt() % 200;
+        btree.insert(cz::heap_allocator(), element);
+        reference.insert(element);
+    }
+
+    REQUIRE(btree.count == reference.size());
+    CHECK(btree.root->subtree_count == reference.size());
+
+    for (int element = -1; element < 201; ++element) {
+        CHECK(btree.count_eq(element) == reference.count(element));
+
+        Multi_Tree<int, 4>::Range range = btree.equal_range(element);
+        size_t matches = 0;
+        for (Iterator<int, 4> it = range.start; it != range.end; ++it) {
+            CHECK(*it == element);
+            ++matches;
+        }
+        CHECK(matches == reference.count(element));
+
+        auto ge = reference.lower_bound(element);
+        auto gt = reference.upper_bound(element);
+        Iterator<int, 4> it = btree.find_ge(element);
+        CHECK((it == btree.end() ? -1 : *it) == (ge == reference.end() ? -1 : *ge));
+        it = btree.find_gt(element);
+        CHECK((it == btree.end() ? -1 : *it) == (gt == reference.end() ? -1 : *gt));
+        it = btree.find_lt(element);
+        CHECK((it == btree.end() ? -1 : *it) == (ge == reference.begin() ? -1 : *--ge));
+        it = btree.find_le(element);
+        CHECK((it == btree.end() ? -1 : *it) == (gt == reference.begin() ? -1 : *--gt));
+    }
+}
+
+TEST_CASE("BTree Multi_Map keeps insertion order") {
+    Multi_Map<int, int, 4> map = {};
+    CZ_DEFER(map.drop(cz::heap_allocator()));
+
+    for (int i = 0; i < 100; ++i) {
+        map.insert(cz::heap_allocator(), 1, i);
+        map.insert(cz::heap_allocator(), i % 3, -i);
+    }
+
+    CHECK(map.tree.count == 200);
+    CHECK(map.count_eq(0) == 34);
+    CHECK(map.count_eq(1) == 133);
+    CHECK(map.count_eq(2) == 33);
+    CHECK(map.count_eq(3) == 0);
+
+    // Pairs with the key 1 that were inserted second in each iteration have negative values.
+    Multi_Map<int, int, 4>::Range range = map.equal_range(1);
+    int next = 0;
+    int next_negative = -1;
+    for (Multi_Map<int, int, 4>::Iterator it = range.start; it != range.end; ++it) {
+        CHECK(it->key == 1);
+        if (it->value >= 0) {
+            CHECK(it->value == next);
+            next = it->value + 1;
+        } else {
+            CHECK(it->value == next_negative);
+            next_negative -= 3;
+        }
+    }
+    CHECK(next == 100);
+
+    REQUIRE(map.find(2) != map.end());
+    CHECK(map.find(2)->value == -2);
+}
+
+TEST_CASE("BTree try_insert returns the element") {
+    Tree<int, 4> btree = {};
+    CZ_DEFER(btree.drop(cz::heap_allocator()));
+    std::set<int> reference;
+
+    std::mt19937 mt;
+    for (int i = 0; i < 2000; ++i) {
+        int element = mt() % 500;
+        Insert_Result<int, 4> result = btree.try_insert(cz::heap_allocator(), element);
+        CHECK(result.inserted == reference.insert(element).second);
+        REQUIRE(result.iterator != btree.end());
+        CHECK(*result.iterator == element);
+        CHECK(result.iterator == btree.find(element));
+    }
+    CHECK(btree.count == reference.size());
+}
+
+TEST_CASE("BTree Map insert_or_assign and get_or_insert_default") {
+    Map<int, int, 4> map = {};
+    CZ_DEFER(map.drop(cz::heap_allocator()));
+
+    for (int i = 0; i < 1000; ++i) {
+        ++map.get_or_insert_default(cz::heap_allocator(), i % 37)->value;
+    }
+    CHECK(map.tree.count == 37);
+    for (int key = 0; key < 37; ++key) {
+        REQUIRE(map.find(key) != map.end());
+        CHECK(map.find(key)->value == (1000 / 37) + (key < 1000 % 37));
+    }
+
+    Map<int, int, 4>::Insert_Result result = map.insert_or_assign(cz::heap_allocator(), 3, -3);
+    CHECK_FALSE(result.inserted);
+    CHECK(result.iterator->key == 3);
+    CHECK(map.find(3)->value == -3);
+
+    result = map.insert_or_assign(cz::heap_allocator(), 100, -100);
+    CHECK(result.inserted);
+    CHECK(result.iterator->key == 100);
+    CHECK(map.find(100)->value == -100);
+
+    result = map.try_insert(cz::heap_allocator(), 100, 5);
+    CHECK_FALSE(result.inserted);
+    CHECK(result.iterator->value == -100);
+}
+
+/// Check the structure of a subtree and get the number of elements in it.
+template <size_t M>
+static uint64_t check_node(const Node<int, M>* node, size_t depth, size_t* leaf_depth) {
+    CHECK(node->num_elements >= 1);
+    if (node->parent)
+        CHECK(node->num_elements >= (M - 1) / 2);
+    for (size_t i = 1; i < node->num_elements; ++i) {
+        CHECK(node->elements[i - 1] < node->elements[i]);
+    }
+
+    uint64_t count = node->num_elements;
+    if (!node->children[0]) {
+        if (*leaf_depth == 0)
+            *leaf_depth = depth;
+        CHECK(*leaf_depth == depth);
+    } else {
+        for (size_t i = 0; i < node->num_elements + 1; ++i) {
+            CHECK(node->children[i]->parent == node);
+            CHECK(node->children[i]->parent_index == i);
+            count += check_node(node->children[i], depth + 1, leaf_depth);
+        }
+    }
+    CHECK(node->subtree_count == count);
+    return count;
+}
+
+template <size_t M>
+static void check_tree(const Tree<int, M>& btree, const std::set<int>& reference) {
+    REQUIRE(btree.count == reference.size());
+    if (!btree.root)
+        return;
+    CHECK(btree.root->parent == nullptr);
+    size_t leaf_depth = 0;
+    CHECK(check_node(btree.root, 1, &leaf_depth) == reference.size());
+
+    auto expected = reference.begin();
+    for (Iterator<const int, M> it = btree.start(); it != btree.end(); ++it, ++expected) {
+        REQUIRE(expected != reference.end());
+        CHECK(*it == *expected);
+    }
+    CHECK(expected == reference.end());
+}
+
+template <size_t M>
+static void erase_random(uint32_t seed) {
+    Tree<int, M> btree = {};
+    CZ_DEFER(btree.drop(cz::heap_allocator()));
+    std::set<int> reference;
+
+    std::mt19937 mt(seed);
+    for (int round = 0; round < 200; ++round) {
+        for (int i = 0; i < 50; ++i) {
+            int element = mt() % 1000;
+            btree.insert(cz::heap_allocator(), element);
+            reference.insert(element);
+        }
+
+        int lo = mt() % 1000;
+        int hi = lo + mt() % (round % 4 == 0 ? 1000 : 40);
+        btree.erase_range(cz::heap_allocator(), lo, hi);
+        reference.erase(reference.lower_bound(lo), reference.lower_bound(hi));
+        check_tree(btree, reference);
+
+        int element = mt() % 1000;
+        btree.remove(cz::heap_allocator(), btree.find(element));
+        reference.erase(element);
+        check_tree(btree, reference);
+    }
+}
+
+TEST_CASE("BTree erase_range random against std::set") {
+    for (uint32_t seed = 0; seed < 4; ++seed) {
+        erase_random<3>(seed);
+        erase_random<4>(seed);
+        erase_random<7>(seed);
+    }
+}
+
+TEST_CASE("BTree erase_range prefix") {
+    Tree<int, 5> btree = {};
+    CZ_DEFER(btree.drop(cz::heap_allocator()));
+    std::set<int> reference;
+    for (int i = 0; i < 10000; ++i) {
+        btree.insert(cz::heap_allocator(), i);
+        reference.insert(i);
+    }
+
+    // Nothing is removed from empty or backwards ranges.
+    btree.erase_range(cz::heap_allocator(), 20, 20);
+    btree.erase_range(cz::heap_allocator(), 30, 20);
+    check_tree(btree, reference);
+
+    for (int cutoff = 1000; cutoff < 10000; cutoff += 3000) {
+        btree.erase_range(cz::heap_allocator(), 0, cutoff);
+        reference.erase(reference.begin(), reference.lower_bound(cutoff));
+        check_tree(btree, reference);
+        REQUIRE(btree.start() != btree.end());
+        CHECK(*btree.start() == cutoff);
+    }
+
+    btree.erase_range(cz::heap_allocator(), 0, 10000);
+    CHECK(btree.root == nullptr);
+    CHECK(btree.count == 0);
+}
+
+TEST_CASE("BTree Map remove and erase_range") {
+    Map<int, int, 4> map = {};
+    CZ_DEFER(map.drop(cz::heap_allocator()));
+    for (int i = 0; i < 100; ++i) {
+        map.insert(cz::heap_allocator(), i, -i);
+    }
+
+    map.remove(cz::heap_allocator(), map.find(50));
+    CHECK(map.find(50) == map.end());
+    CHECK(map.tree.count == 99);
+
+    map.erase_range(cz::heap_allocator(), 10, 90);
+    CHECK(map.tree.count == 20);
+    CHECK(map.find(9)->value == -9);
+    CHECK(map.find(10) == map.end());
+    CHECK(map.find(89) == map.end());
+    CHECK(map.find(90)->value == -90);
+}
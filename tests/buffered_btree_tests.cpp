@@ -0,0 +1,162 @@
+#include <czt/test_base.hpp>
+
+#include <cz/defer.hpp>
+#include <cz/heap.hpp>
+#include <random>
+#include <set>
+#include "buffered_btree.hpp"
+
+using namespace cz;
+using namespace ds::btree;
+
+TEST_CASE("Buffered_Tree empty") {
+    Buffered_Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+
+    CHECK(tree.find(3) == nullptr);
+    CHECK(tree.find_ge(3) == nullptr);
+    CHECK(tree.find_le(3) == nullptr);
+
+    tree.remove(cz::heap_allocator(), 3);
+    CHECK(tree.root == nullptr);
+    CHECK(tree.count == 0);
+}
+
+TEST_CASE("Buffered_Tree small tree is a leaf") {
+    Buffered_Tree<int, 4, 3, 8> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+
+    tree.insert(cz::heap_allocator(), 10);
+    tree.insert(cz::heap_allocator(), 7);
+    tree.insert(cz::heap_allocator(), 13);
+    tree.insert(cz::heap_allocator(), 7);
+
+    CHECK(tree.height == 1);
+    CHECK(tree.count == 3);
+    CHECK(tree.pending == 0);
+
+    REQUIRE(tree.find(7));
+    CHECK(*tree.find(7) == 7);
+    CHECK(tree.find(8) == nullptr);
+    REQUIRE(tree.find_gt(7));
+    CHECK(*tree.find_gt(7) == 10);
+    REQUIRE(tree.find_lt(7) == nullptr);
+
+    tree.remove(cz::heap_allocator(), 10);
+    CHECK(tree.count == 2);
+    CHECK(tree.find(10) == nullptr);
+}
+
+TEST_CASE("Buffered_Tree writes are buffered") {
+    Buffered_Tree<int, 4, 3, 8> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+
+    for (int i = 0; i < 5; ++i) {
+        tree.insert(cz::heap_allocator(), i);
+    }
+    REQUIRE(tree.height == 2);
+    CHECK(tree.count == 5);
+
+    // Inserts and removes wait in the root's buffer.
+    tree.insert(cz::heap_allocator(), 20);
+    tree.remove(cz::heap_allocator(), 2);
+    CHECK(tree.count == 5);
+    CHECK(tree.pending == 2);
+
+    REQUIRE(tree.find(20));
+    CHECK(*tree.find(20) == 20);
+    CHECK(tree.find(2) == nullptr);
+    REQUIRE(tree.find_gt(1));
+    CHECK(*tree.find_gt(1) == 3);
+    REQUIRE(tree.find_lt(3));
+    CHECK(*tree.find_lt(3) == 1);
+    REQUIRE(tree.find_ge(5));
+    CHECK(*tree.find_ge(5) == 20);
+
+    // A newer message for the same element replaces the older one.
+    tree.insert(cz::heap_allocator(), 2);
+    CHECK(tree.pending == 2);
+    REQUIRE(tree.find(2));
+
+    tree.flush(cz::heap_allocator());
+    CHECK(tree.pending == 0);
+    CHECK(tree.count == 6);
+    REQUIRE(tree.find(2));
+    REQUIRE(tree.find(20));
+}
+
+TEST_CASE("Buffered_Tree random against std::set") {
+    Buffered_Tree<int, 4, 3, 8> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    std::set<int> reference;
+
+    std::mt19937 mt;
+    for (int i = 0; i < 20000; ++i) {
+        int element = mt() % 2000;
+        if (mt() % 3 == 0) {
+            tree.remove(cz::heap_allocator(), element);
+            reference.erase(element);
+        } else {
+            tree.insert(cz::heap_allocator(), element);
+            reference.insert(element);
+        }
+
+        if (i % 97 == 0) {
+            int query = mt() % 2000;
+            auto eq = reference.find(query);
+            auto ge = reference.lower_bound(query);
+            auto gt = reference.upper_bound(query);
+            const int* result = tree.find_eq(query);
+            CHECK((result ? *result : -1) == (eq == reference.end() ? -1 : *eq));
+            result = tree.find_ge(query);
+            CHECK((result ? *result : -1) == (ge == reference.end() ? -1 : *ge));
+            result = tree.find_gt(query);
+            CHECK((result ? *result : -1) == (gt == reference.end() ? -1 : *gt));
+            result = tree.find_lt(query);
+            CHECK((result ? *result : -1) == (ge == reference.begin() ? -1 : *--ge));
+            result = tree.find_le(query);
+            CHECK((result ? *result : -1) == (gt == reference.begin() ? -1 : *--gt));
+        }
+    }
+
+    // Walk the whole tree in both directions.
+    size_t walked = 0;
+    auto expected = reference.begin();
+    for (const int* it = tree.find_ge(0); it; it = tree.find_gt(*it), ++expected, ++walked) {
+        REQUIRE(expected != reference.end());
+        CHECK(*it == *expected);
+    }
+    CHECK(walked == reference.size());
+
+    walked = 0;
+    auto reverse = reference.rbegin();
+    for (const int* it = tree.find_le(2000); it; it = tree.find_lt(*it), ++reverse, ++walked) {
+        REQUIRE(reverse != reference.rend());
+        CHECK(*it == *reverse);
+    }
+    CHECK(walked == reference.size());
+
+    tree.flush(cz::heap_allocator());
+    CHECK(tree.pending == 0);
+    CHECK(tree.count == reference.size());
+    for (int element = 0; element < 2000; ++element) {
+        CHECK((tree.find(element) != nullptr) == (reference.count(element) == 1));
+    }
+}
+
+TEST_CASE("Buffered_Tree remove everything frees leaves") {
+    Buffered_Tree<int, 4, 3, 8> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+
+    for (int i = 0; i < 1000; ++i) {
+        tree.insert(cz::heap_allocator(), i);
+    }
+    for (int i = 0; i < 1000; ++i) {
+        tree.remove(cz::heap_allocator(), i);
+    }
+    tree.flush(cz::heap_allocator());
+
+    CHECK(tree.count == 0);
+    CHECK(tree.find_ge(0) == nullptr);
+    CHECK(tree.find_le(1000) == nullptr);
+}
@@ -0,0 +1,274 @@
+#include <czt/test_base.hpp>
+
+#include <cz/defer.hpp>
+#include <cz/heap.hpp>
+#include <random>
+#include <string.h>
+#include "compact_splay_tree.hpp"
+
+using namespace cz;
+using namespace ds::splay;
+
+/// Check ordering of an in order walk and that every live node is reachable.
+template <class T>
+static void val_tree(const Compact_Tree<T>& tree) {
+    size_t count = 0;
+    // The depth is bounded by the number of nodes.
+    uint32_t* stack = cz::heap_allocator().alloc<uint32_t>(tree.count() + 1);
+    CZ_DEFER(cz::heap_allocator().dealloc(stack, tree.count() + 1));
+    size_t stack_len = 0;
+    uint32_t node = tree.root;
+    const T* previous = nullptr;
+    while (node || stack_len > 0) {
+        while (node) {
+            REQUIRE(stack_len <= tree.count());
+            stack[stack_len++] = node;
+            node = tree.nodes[node].left;
+        }
+        node = stack[--stack_len];
+        if (previous)
+            CHECK(*previous < tree.nodes[node].element);
+        previous = &tree.nodes[node].element;
+        ++count;
+        node = tree.nodes[node].right;
+    }
+    CHECK(count == tree.count());
+}
+
+TEST_CASE("Compact_Tree insertion") {
+    Compact_Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    CHECK(tree.insert(cz::heap_allocator(), 2));
+    CHECK(tree.insert(cz::heap_allocator(), 1));
+    CHECK(tree.insert(cz::heap_allocator(), 3));
+    CHECK_FALSE(tree.insert(cz::heap_allocator(), 2));
+    CHECK(tree.count() == 3);
+    CHECK(tree.nodes[tree.root].element == 2);
+    val_tree(tree);
+}
+
+TEST_CASE("Compact_Tree find") {
+    Compact_Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    for (int i = 0; i < 10; ++i) {
+        tree.insert(cz::heap_allocator(), i * 2);
+    }
+    val_tree(tree);
+
+    REQUIRE(tree.find(4));
+    CHECK(*tree.find(4) == 4);
+    CHECK_FALSE(tree.find(5));
+
+    REQUIRE(tree.find_less(5));
+    CHECK(*tree.find_less(5) == 4);
+    REQUIRE(tree.find_less(4));
+    CHECK(*tree.find_less(4) == 2);
+    CHECK_FALSE(tree.find_less(0));
+
+    REQUIRE(tree.find_greater(5));
+    CHECK(*tree.find_greater(5) == 6);
+    REQUIRE(tree.find_greater(4));
+    CHECK(*tree.find_greater(4) == 6);
+    CHECK_FALSE(tree.find_greater(18));
+
+    REQUIRE(tree.find_less_equal(4));
+    CHECK(*tree.find_less_equal(4) == 4);
+    REQUIRE(tree.find_less_equal(5));
+    CHECK(*tree.find_less_equal(5) == 4);
+    CHECK_FALSE(tree.find_less_equal(-1));
+
+    REQUIRE(tree.find_greater_equal(4));
+    CHECK(*tree.find_greater_equal(4) == 4);
+    REQUIRE(tree.find_greater_equal(3));
+    CHECK(*tree.find_greater_equal(3) == 4);
+    CHECK_FALSE(tree.find_greater_equal(19));
+    val_tree(tree);
+}
+
+TEST_CASE("Compact_Tree remove reuses nodes") {
+    Compact_Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(cz::heap_allocator(), i);
+    }
+    uint32_t nodes_len = tree.nodes_len;
+
+    for (int i = 0; i < 100; i += 2) {
+        CHECK(tree.remove(i));
+    }
+    CHECK_FALSE(tree.remove(0));
+    CHECK(tree.count() == 50);
+    val_tree(tree);
+
+    for (int i = 0; i < 100; i += 2) {
+        CHECK(tree.insert(cz::heap_allocator(), i));
+    }
+    CHECK(tree.count() == 100);
+    CHECK(tree.nodes_len == nodes_len);
+    val_tree(tree);
+}
+
+TEST_CASE("Compact_Tree random insertion and removal") {
+    Compact_Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    std::mt19937 mt;
+    std::uniform_int_distribution<int> dist(0, 1000);
+    bool present[1001] = {};
+
+    for (int i = 0; i < 10000; ++i) {
+        int value = dist(mt);
+        if (mt() & 1) {
+            CHECK(tree.insert(cz::heap_allocator(), value) == !present[value]);
+            present[value] = true;
+        } else {
+            CHECK(tree.remove(value) == present[value]);
+            present[value] = false;
+        }
+    }
+    val_tree(tree);
+
+    for (int i = 0; i <= 1000; ++i) {
+        CHECK(tree.contains(i) == present[i]);
+    }
+}
+
+namespace {
+struct Collect {
+    int* elements;
+    size_t len;
+    void operator()(const int& element) { elements[len++] = element; }
+};
+}
+
+TEST_CASE("Compact_Tree for_each") {
+    Compact_Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    std::mt19937 mt;
+    std::uniform_int_distribution<int> dist(0, 1000);
+    bool present[1001] = {};
+    int elements[1001];
+
+    Collect empty = {elements, 0};
+    tree.for_each(cz::heap_allocator(), empty);
+    CHECK(empty.len == 0);
+
+    // Inserting in order makes a chain deeper than the walk's inline path.
+    for (int i = 0; i < 1000; i += 2) {
+        tree.insert(cz::heap_allocator(), i);
+        present[i] = true;
+    }
+
+    for (int i = 0; i < 5000; ++i) {
+        int value = dist(mt);
+        if (mt() & 1) {
+            tree.insert(cz::heap_allocator(), value);
+            present[value] = true;
+        } else {
+            tree.remove(value);
+            present[value] = false;
+        }
+
+        if (i % 500 == 0) {
+            Collect collect = {elements, 0};
+            tree.for_each(cz::heap_allocator(), collect);
+            REQUIRE(collect.len == tree.count());
+            size_t index = 0;
+            for (int value = 0; value <= 1000; ++value) {
+                if (present[value])
+                    CHECK(elements[index++] == value);
+            }
+        }
+    }
+
+    // Chains to the left and to the right.
+    for (int i = 0; i <= 1000; ++i) {
+        tree.insert(cz::heap_allocator(), i);
+    }
+    for (int direction = 0; direction < 2; ++direction) {
+        if (direction == 0)
+            tree.find(0);
+        else
+            tree.find(1000);
+        Collect collect = {elements, 0};
+        tree.for_each(cz::heap_allocator(), collect);
+        REQUIRE(collect.len == 1001);
+        for (int i = 0; i <= 1000; ++i) {
+            CHECK(elements[i] == i);
+        }
+    }
+    val_tree(tree);
+}
+
+TEST_CASE("Compact_Tree for_each deep chain") {
+    Compact_Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+
+    // Inserting in order makes a chain down the left as deep as the tree.
+    const int count = 100000;
+    for (int i = 0; i < count; ++i) {
+        tree.insert(cz::heap_allocator(), i);
+    }
+
+    Collect collect = {cz::heap_allocator().alloc<int>(count), 0};
+    CZ_DEFER(cz::heap_allocator().dealloc(collect.elements, count));
+    tree.for_each(cz::heap_allocator(), collect);
+    REQUIRE(collect.len == count);
+    for (int i = 0; i < count; ++i) {
+        if (collect.elements[i] != i) {
+            CHECK(collect.elements[i] == i);
+            break;
+        }
+    }
+}
+
+TEST_CASE("Compact_Tree stats") {
+    Compact_Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+
+    ds::gen::Tree_Stats empty = tree.stats(cz::heap_allocator());
+    CHECK(empty.nodes == 0);
+    CHECK(empty.height == 0);
+
+    // Inserting in order makes a chain down the left.
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(cz::heap_allocator(), i);
+    }
+
+    // The walk is deeper than its inline path but
+    // still finds every depth and never touches the links.
+    Compact_Node<int> before[101];
+    memcpy(before, tree.nodes, sizeof(before));
+    ds::gen::Tree_Stats stats = tree.stats(cz::heap_allocator());
+    CHECK(memcmp(before, tree.nodes, sizeof(before)) == 0);
+    CHECK(stats.nodes == 100);
+    CHECK(stats.height == 100);
+    CHECK(stats.average_depth() == 50.5);
+    CHECK(stats.bytes_allocated == tree.nodes_cap * sizeof(Compact_Node<int>));
+    CHECK(stats.bytes_payload == 100 * sizeof(int));
+
+    val_tree(tree);
+
+    std::mt19937 mt;
+    for (int i = 0; i < 1000; ++i) {
+        tree.insert(cz::heap_allocator(), (int)(mt() % 10000));
+    }
+    stats = tree.stats(cz::heap_allocator());
+    CHECK(stats.nodes == tree.count());
+    CHECK(stats.total_depth >= stats.nodes);
+    val_tree(tree);
+}
+
+TEST_CASE("Compact_Tree stats deep chain") {
+    Compact_Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+
+    const int count = 100000;
+    for (int i = 0; i < count; ++i) {
+        tree.insert(cz::heap_allocator(), i);
+    }
+
+    ds::gen::Tree_Stats stats = tree.stats(cz::heap_allocator());
+    CHECK(stats.nodes == count);
+    CHECK(stats.height == count);
+    CHECK(stats.total_depth == (uint64_t)count * (count + 1) / 2);
+}
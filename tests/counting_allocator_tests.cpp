@@ -0,0 +1,175 @@
+#include <czt/test_base.hpp>
+
+#include <cz/defer.hpp>
+#include <cz/heap.hpp>
+#include <thread>
+#include "btree.hpp"
+#include "counting_allocator.hpp"
+#include "page_table.hpp"
+#include "splay_tree.hpp"
+
+using namespace cz;
+using namespace ds;
+
+TEST_CASE("Counting_Allocator counts allocations") {
+    Counting_Allocator counter = {};
+    counter.inner = cz::heap_allocator();
+    cz::Allocator allocator = counter.allocator();
+
+    char* small = (char*)allocator.alloc({10, 1});
+    char* big = (char*)allocator.alloc({100, 1});
+    big = (char*)allocator.realloc({big, 100}, {200, 1});
+
+    Allocation_Counts counts = counter.counts();
+    CHECK(counts.allocations == 2);
+    CHECK(counts.reallocations == 1);
+    CHECK(counts.deallocations == 0);
+    CHECK(counts.bytes_allocated == 310);
+    CHECK(counts.bytes_deallocated == 100);
+    CHECK(counts.live_bytes == 210);
+    CHECK(counts.peak_live_bytes == 210);
+    CHECK(counter.size_histogram[3] == 1);  // 10 bytes
+    CHECK(counter.size_histogram[6] == 1);  // 100 bytes
+    CHECK(counter.size_histogram[7] == 1);  // 200 bytes
+
+    allocator.dealloc({small, 10});
+    allocator.dealloc({big, 200});
+
+    counts = counter.counts();
+    CHECK(counts.deallocations == 2);
+    CHECK(counts.live_bytes == 0);
+    CHECK(counts.live_allocations() == 0);
+    CHECK(counts.peak_live_bytes == 210);
+
+    counter.reset();
+    CHECK(counter.counts().peak_live_bytes == 0);
+}
+
+TEST_CASE("Counting_Allocator call sites") {
+    Counting_Allocator counter = {};
+    counter.inner = cz::heap_allocator();
+    counter.track_call_sites = true;
+    cz::Allocator allocator = counter.allocator();
+
+    for (int i = 0; i < 3; ++i) {
+        allocator.dealloc({allocator.alloc({8, 1}), 8});
+    }
+
+    Allocation_Site sites[Counting_Allocator::MAX_SITES];
+    size_t len = counter.call_sites(sites, Counting_Allocator::MAX_SITES);
+    REQUIRE(len >= 1);
+    uint64_t total = 0;
+    for (size_t i = 0; i < len; ++i) {
+        CHECK(sites[i].address);
+        CHECK(i == 0 || sites[i - 1].allocations >= sites[i].allocations);
+        total += sites[i].allocations;
+    }
+    CHECK(total == 3);
+}
+
+TEST_CASE("Counting_Allocator is thread safe") {
+    Counting_Allocator counter = {};
+    counter.inner = cz::heap_allocator();
+    cz::Allocator allocator = counter.allocator();
+
+    std::thread threads[4];
+    for (size_t t = 0; t < 4; ++t) {
+        threads[t] = std::thread([allocator]() {
+            for (int i = 0; i < 1000; ++i) {
+                allocator.dealloc({allocator.alloc({16, 1}), 16});
+            }
+        });
+    }
+    for (size_t t = 0; t < 4; ++t) {
+        threads[t].join();
+    }
+
+    Allocation_Counts counts = counter.counts();
+    CHECK(counts.allocations == 4000);
+    CHECK(counts.deallocations == 4000);
+    CHECK(counts.live_bytes == 0);
+    CHECK(counts.peak_live_bytes >= 16);
+    CHECK(counts.peak_live_bytes <= 64);
+}
+
+// The tests below pin down how many allocations each container operation makes
+// so that a change which allocates more fails here instead of only in benchmarks.
+
+TEST_CASE("Counting_Allocator btree split allocations") {
+    Counting_Allocator counter = {};
+    counter.inner = cz::heap_allocator();
+    cz::Allocator allocator = counter.allocator();
+
+    btree::Tree<int, 4> tree = {};
+    for (int i = 0; i < 4; ++i) {
+        tree.insert(allocator, i);
+    }
+    CHECK(counter.counts().allocations == 1);
+
+    // Splitting the root allocates the right half and a new root.
+    tree.insert(allocator, 4);
+    CHECK(counter.counts().allocations == 3);
+
+    // Failed inserts don't allocate.
+    tree.insert(allocator, 2);
+    CHECK(counter.counts().allocations == 3);
+
+    for (int i = 5; i < 1000; ++i) {
+        tree.insert(allocator, i);
+    }
+    CHECK(counter.counts().allocations == tree.stats().nodes);
+    CHECK(counter.counts().live_bytes == tree.stats().bytes_allocated);
+
+    tree.drop(allocator);
+    Allocation_Counts counts = counter.counts();
+    CHECK(counts.live_allocations() == 0);
+    CHECK(counts.live_bytes == 0);
+    CHECK(counts.reallocations == 0);
+}
+
+TEST_CASE("Counting_Allocator splay tree allocations") {
+    Counting_Allocator counter = {};
+    counter.inner = cz::heap_allocator();
+    cz::Allocator allocator = counter.allocator();
+
+    splay::Tree<int> tree = {};
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(allocator, i);
+    }
+    CHECK(counter.counts().allocations == 100);
+
+    tree.remove(allocator, tree.find_equal(50));
+    CHECK(counter.counts().deallocations == 1);
+
+    tree.drop(allocator);
+    CHECK(counter.counts().live_bytes == 0);
+
+    // Building from sorted elements makes a single allocation.
+    counter.reset();
+    int elements[] = {1, 2, 3, 4, 5};
+    splay::Tree<int> built = {};
+    built.build_from_sorted(allocator, {elements, 5});
+    CHECK(counter.counts().allocations == 1);
+    built.drop(allocator);
+    CHECK(counter.counts().live_bytes == 0);
+}
+
+TEST_CASE("Counting_Allocator page table allocations") {
+    Counting_Allocator counter = {};
+    counter.inner = cz::heap_allocator();
+    cz::Allocator allocator = counter.allocator();
+
+    pt::Page_Table<uint64_t> page_table = {};
+    page_table.add(allocator, 0);
+    CHECK(counter.counts().allocations == 1);
+
+    for (uint64_t i = 1; i < 10000; ++i) {
+        page_table.add(allocator, i);
+    }
+    pt::Stats stats = page_table.stats();
+    CHECK(counter.counts().allocations == stats.branches + stats.leaves);
+    CHECK(counter.counts().live_bytes == stats.bytes_allocated);
+
+    page_table.drop(allocator);
+    CHECK(counter.counts().live_bytes == 0);
+}
@@ -0,0 +1,125 @@
+#include <czt/test_base.hpp>
+
+#include <cz/defer.hpp>
+#include <cz/heap.hpp>
+#include <random>
+#include <set>
+#include "hash_map.hpp"
+
+using namespace cz;
+using namespace ds;
+using namespace ds::hash;
+
+TEST_CASE("Hash_Map empty") {
+    Map<int, int> map = {};
+    CZ_DEFER(map.drop(cz::heap_allocator()));
+
+    CHECK(map.count() == 0);
+    CHECK(map.start() == map.end());
+    CHECK(map.find(3) == map.end());
+    CHECK_FALSE(map.remove(cz::heap_allocator(), 3));
+}
+
+TEST_CASE("Hash_Map insert find remove") {
+    Map<int, int> map = {};
+    CZ_DEFER(map.drop(cz::heap_allocator()));
+
+    CHECK(map.insert(cz::heap_allocator(), 1, 10));
+    CHECK(map.insert(cz::heap_allocator(), 2, 20));
+    CHECK_FALSE(map.insert(cz::heap_allocator(), 1, 30));
+    CHECK(map.count() == 2);
+
+    Iterator<Map<int, int>::Pair> it = map.find(1);
+    REQUIRE(it != map.end());
+    CHECK(it->value == 10);
+    it->value = 11;
+    CHECK(map.find(1)->value == 11);
+
+    CHECK(map.remove(cz::heap_allocator(), 1));
+    CHECK(map.find(1) == map.end());
+    CHECK(map.contains(2));
+    CHECK(map.count() == 1);
+
+    map.remove(cz::heap_allocator(), map.find(2));
+    CHECK(map.count() == 0);
+    CHECK(map.start() == map.end());
+}
+
+TEST_CASE("Hash_Map random against std::set") {
+    Map<uint64_t, uint64_t> map = {};
+    CZ_DEFER(map.drop(cz::heap_allocator()));
+    std::set<uint64_t> reference;
+
+    std::mt19937 mt;
+    for (int i = 0; i < 20000; ++i) {
+        uint64_t key = mt() % 2000;
+        if (mt() % 3 == 0) {
+            CHECK(map.remove(cz::heap_allocator(), key) == (reference.erase(key) == 1));
+        } else {
+            CHECK(map.insert(cz::heap_allocator(), key, key * 2) == reference.insert(key).second);
+        }
+        REQUIRE(map.count() == reference.size());
+    }
+
+    for (uint64_t key = 0; key < 2000; ++key) {
+        Iterator<const Map<uint64_t, uint64_t>::Pair> it =
+            ((const Map<uint64_t, uint64_t>&)map).find(key);
+        if (reference.count(key)) {
+            REQUIRE(it != map.end());
+            CHECK(it->value == key * 2);
+        } else {
+            CHECK(it == map.end());
+        }
+    }
+
+    size_t iterated = 0;
+    for (Iterator<Map<uint64_t, uint64_t>::Pair> it = map.start(); it != map.end(); ++it) {
+        CHECK(reference.count(it->key) == 1);
+        ++iterated;
+    }
+    CHECK(iterated == reference.size());
+}
+
+TEST_CASE("Hash_Map insert and remove doesn't grow") {
+    Map<int, int> map = {};
+    CZ_DEFER(map.drop(cz::heap_allocator()));
+
+    map.reserve(cz::heap_allocator(), 100);
+    size_t capacity = map.capacity;
+    CHECK(capacity >= 100);
+
+    // Deleted slots are reclaimed by rehashing in place.
+    for (int i = 0; i < 100000; ++i) {
+        map.insert(cz::heap_allocator(), i, i);
+        if (i >= 50)
+            map.remove(cz::heap_allocator(), i - 50);
+    }
+    CHECK(map.count() == 50);
+    CHECK(map.capacity == capacity);
+    for (int i = 100000 - 50; i < 100000; ++i) {
+        CHECK(map.contains(i));
+    }
+}
+
+TEST_CASE("Hash_Map SSOStr keys") {
+    Map<SSOStr, int> map = {};
+    CZ_DEFER(map.drop(cz::heap_allocator()));
+
+    const char* strings[] = {"a", "short", "a string that is too long to be stored inline",
+                             "another string that is too long to be stored inline"};
+    SSOStr keys[4];
+    for (int i = 0; i < 4; ++i) {
+        keys[i] = SSOStr::from_constant(strings[i]);
+        CHECK(map.insert(cz::heap_allocator(), keys[i], i));
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        // Look up with a separate copy so the comparison is by contents.
+        SSOStr copy = SSOStr::as_duplicate(cz::heap_allocator(), strings[i]);
+        CZ_DEFER(copy.drop(cz::heap_allocator()));
+        Iterator<Map<SSOStr, int>::Pair> it = map.find(copy);
+        REQUIRE(it != map.end());
+        CHECK(it->value == i);
+    }
+    CHECK(map.find(SSOStr::from_constant("missing")) == map.end());
+}
@@ -1,5 +1,7 @@
 #include <czt/test_base.hpp>
 
+#include <stdio.h>
+#include <unistd.h>
 #include "page_table.hpp"
 
 using namespace cz;
@@ -40,3 +42,179 @@ TEST_CASE("Page_Table uint64_t 10000 items") {
         REQUIRE(i == *num);
     }
 }
+
+TEST_CASE("Page_Table uint64_t depth 3") {
+    Page_Table<uint64_t> page_table = {};
+    CZ_DEFER(page_table.drop(cz::heap_allocator()));
+
+    const uint64_t count = 512 * 512 + 10;
+    for (uint64_t i = 0; i < count; ++i) {
+        page_table.add(cz::heap_allocator(), i);
+    }
+    CHECK(page_table.depth == 3);
+
+    for (uint64_t i = 0; i < count; i += 97) {
+        INFO("i = " << i);
+        uint64_t* num = page_table.lookup(i);
+        REQUIRE(num);
+        REQUIRE(i == *num);
+    }
+    CHECK(page_table.lookup(count) == nullptr);
+}
+
+TEST_CASE("Page_Table lookup cursor") {
+    Page_Table<uint64_t> page_table = {};
+    CZ_DEFER(page_table.drop(cz::heap_allocator()));
+
+    Lookup_Cursor<uint64_t> cursor = {};
+    CHECK(page_table.lookup(&cursor, 0) == nullptr);
+
+    for (uint64_t i = 0; i < 10000; ++i) {
+        page_table.add(cz::heap_allocator(), i);
+    }
+
+    for (uint64_t i = 0; i < 10000; ++i) {
+        INFO("i = " << i);
+        uint64_t* num = page_table.lookup(&cursor, i);
+        REQUIRE(num);
+        REQUIRE(i == *num);
+    }
+
+    for (uint64_t i = 10000; i-- > 0;) {
+        INFO("i = " << i);
+        uint64_t* num = page_table.lookup(&cursor, i);
+        REQUIRE(num);
+        REQUIRE(i == *num);
+    }
+
+    CHECK(page_table.lookup(&cursor, 10000) == nullptr);
+}
+
+TEST_CASE("Page_Table save and load") {
+    FILE* file = tmpfile();
+    REQUIRE(file);
+    CZ_DEFER(fclose(file));
+
+    const uint64_t count = 512 * 3 + 7;
+
+    {
+        Page_Table<uint64_t> page_table = {};
+        CZ_DEFER(page_table.drop(cz::heap_allocator()));
+
+        for (uint64_t i = 0; i < count; ++i) {
+            page_table.add(cz::heap_allocator(), i * 3);
+        }
+
+        REQUIRE(page_table.save(fileno(file)));
+    }
+
+    Page_Table<uint64_t> page_table = {};
+    CZ_DEFER(page_table.drop(cz::heap_allocator()));
+    REQUIRE(page_table.load(cz::heap_allocator(), fileno(file)));
+    CHECK(page_table.next_id == count);
+
+    for (uint64_t i = 0; i < count; ++i) {
+        INFO("i = " << i);
+        uint64_t* num = page_table.lookup(i);
+        REQUIRE(num);
+        REQUIRE(i * 3 == *num);
+    }
+    CHECK(page_table.lookup(count) == nullptr);
+
+    // The unused end of the last leaf is saved as zeros.
+    const uint64_t per_leaf = Leaf_Elements<uint64_t>::value;
+    const uint64_t* last = page_table.lookup(count - 1);
+    for (uint64_t i = count % per_leaf; i < per_leaf; ++i) {
+        INFO("i = " << i);
+        CHECK(last[i - count % per_leaf + 1] == 0);
+    }
+
+    // Adding after loading fills the last mapped leaf then allocates new ones.
+    for (uint64_t i = count; i < count + 1000; ++i) {
+        REQUIRE(page_table.add(cz::heap_allocator(), i * 3) == i);
+    }
+    for (uint64_t i = 0; i < count + 1000; ++i) {
+        INFO("i = " << i);
+        uint64_t* num = page_table.lookup(i);
+        REQUIRE(num);
+        REQUIRE(i * 3 == *num);
+    }
+}
+
+/// Overwrite the `next_id` in a saved snapshot's header.
+static void set_next_id(FILE* file, uint64_t next_id) {
+    fseek(file, 24, SEEK_SET);
+    fwrite(&next_id, sizeof(next_id), 1, file);
+    fflush(file);
+}
+
+/// Try to load the snapshot into a fresh table.
+static bool try_load(FILE* file) {
+    Page_Table<uint64_t> page_table = {};
+    CZ_DEFER(page_table.drop(cz::heap_allocator()));
+    return page_table.load(cz::heap_allocator(), fileno(file));
+}
+
+TEST_CASE("Page_Table load rejects a corrupt next_id") {
+    FILE* file = tmpfile();
+    REQUIRE(file);
+    CZ_DEFER(fclose(file));
+
+    // A header with no leaves.
+    {
+        Page_Table<uint64_t> page_table = {};
+        CZ_DEFER(page_table.drop(cz::heap_allocator()));
+        REQUIRE(page_table.save(fileno(file)));
+    }
+    CHECK(try_load(file));
+    set_next_id(file, UINT64_MAX);
+    CHECK_FALSE(try_load(file));
+    set_next_id(file, 1);
+    CHECK_FALSE(try_load(file));
+
+    // One leaf.
+    REQUIRE(ftruncate(fileno(file), 0) == 0);
+    REQUIRE(lseek(fileno(file), 0, SEEK_SET) == 0);
+    {
+        Page_Table<uint64_t> page_table = {};
+        CZ_DEFER(page_table.drop(cz::heap_allocator()));
+        for (uint64_t i = 0; i < 10; ++i) {
+            page_table.add(cz::heap_allocator(), i);
+        }
+        REQUIRE(page_table.save(fileno(file)));
+    }
+    const uint64_t per_leaf = Leaf_Elements<uint64_t>::value;
+    CHECK(try_load(file));
+    set_next_id(file, per_leaf);
+    CHECK(try_load(file));
+    set_next_id(file, 0);
+    CHECK_FALSE(try_load(file));
+    set_next_id(file, per_leaf + 1);
+    CHECK_FALSE(try_load(file));
+    set_next_id(file, UINT64_MAX);
+    CHECK_FALSE(try_load(file));
+}
+
+TEST_CASE("Page_Table stats") {
+    Page_Table<uint64_t> page_table = {};
+    CZ_DEFER(page_table.drop(cz::heap_allocator()));
+
+    Stats empty = page_table.stats();
+    CHECK(empty.leaves == 0);
+    CHECK(empty.bytes_allocated == 0);
+
+    for (uint64_t i = 0; i < 10000; ++i) {
+        page_table.add(cz::heap_allocator(), i);
+    }
+
+    const uint64_t per_leaf = Leaf_Elements<uint64_t>::value;
+    const uint64_t leaves = (10000 + per_leaf - 1) / per_leaf;
+    Stats stats = page_table.stats();
+    CHECK(stats.elements == 10000);
+    CHECK(stats.depth == 2);
+    CHECK(stats.branches == 1);
+    CHECK(stats.leaves == leaves);
+    CHECK(stats.mapped_leaves == 0);
+    CHECK(stats.bytes_allocated == 4096 + leaves * per_leaf * sizeof(uint64_t));
+    CHECK(stats.bytes_payload == 10000 * sizeof(uint64_t));
+}
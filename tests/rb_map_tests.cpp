@@ -0,0 +1,37 @@
+#include <czt/test_base.hpp>
+
+#include <cz/defer.hpp>
+#include <cz/heap.hpp>
+#include <cz/str.hpp>
+#include "rb_map.hpp"
+
+using namespace cz;
+using namespace ds::rb;
+
+TEST_CASE("RB_Map insertion") {
+    Map<int, const char*> map = {};
+    CZ_DEFER(map.drop(cz::heap_allocator()));
+    map.insert(cz::heap_allocator(), 1, "hello");
+    map.insert(cz::heap_allocator(), 2, "world");
+    CHECK_FALSE(map.insert(cz::heap_allocator(), 2, "again"));
+    CHECK(map.count() == 2);
+
+    Map_Iterator<int, const char*> it;
+    it = map.find(1);
+    REQUIRE(it != map.end());
+    CHECK(it->key == 1);
+    CHECK(cz::Str(it->value) == "hello");
+    it = map.find(2);
+    REQUIRE(it != map.end());
+    CHECK(it->key == 2);
+    CHECK(cz::Str(it->value) == "world");
+    it = map.find(3);
+    CHECK(it == map.end());
+    it = map.find_less(2);
+    REQUIRE(it != map.end());
+    CHECK(it->key == 1);
+
+    map.remove(cz::heap_allocator(), map.find(1));
+    CHECK(map.count() == 1);
+    CHECK_FALSE(map.contains(1));
+}
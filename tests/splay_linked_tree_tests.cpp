@@ -0,0 +1,114 @@
+#include <czt/test_base.hpp>
+
+#include <cz/defer.hpp>
+#include <cz/heap.hpp>
+#include <random>
+#include "splay_linked_tree.hpp"
+
+using namespace cz;
+using namespace ds::splay;
+using namespace ds::gen;
+
+/// Check the links agree with the in order walk of the tree.
+template <class T>
+static void val_tree(Linked_Tree<T>* tree) {
+    val_node<Linked<T> >(tree->tree.root, nullptr);
+
+    Iterator<Linked<T> > it = tree->tree.start();
+    Node<Linked<T> >* prev = nullptr;
+    for (; it != tree->tree.end(); ++it) {
+        CHECK(it->prev == prev);
+        if (prev)
+            CHECK(prev->element.next == it.node);
+        else
+            CHECK(tree->first == it.node);
+        prev = it.node;
+    }
+    CHECK(tree->last == prev);
+}
+
+TEST_CASE("Linked_Tree iteration") {
+    Linked_Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    CHECK(tree.start() == tree.end());
+
+    CHECK(tree.insert(cz::heap_allocator(), 2));
+    CHECK(tree.insert(cz::heap_allocator(), 1));
+    CHECK(tree.insert(cz::heap_allocator(), 3));
+    CHECK_FALSE(tree.insert(cz::heap_allocator(), 2));
+    val_tree(&tree);
+
+    Linked_Iterator<int> it = tree.start();
+    REQUIRE(it != tree.end());
+    CHECK(*it == 1);
+    ++it;
+    REQUIRE(it != tree.end());
+    CHECK(*it == 2);
+    ++it;
+    REQUIRE(it != tree.end());
+    CHECK(*it == 3);
+    ++it;
+    CHECK(it == tree.end());
+
+    --it;
+    REQUIRE(it != tree.end());
+    CHECK(*it == 3);
+    --it;
+    CHECK(*it == 2);
+    --it;
+    CHECK(*it == 1);
+    CHECK(it == tree.start());
+}
+
+TEST_CASE("Linked_Tree find") {
+    Linked_Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    for (int i = 0; i < 10; ++i) {
+        tree.insert(cz::heap_allocator(), i * 2);
+    }
+
+    REQUIRE(tree.find(4) != tree.end());
+    CHECK(*tree.find(4) == 4);
+    CHECK(tree.find(5) == tree.end());
+    CHECK(*tree.find_less(5) == 4);
+    CHECK(*tree.find_greater(5) == 6);
+    CHECK(*tree.find_less_equal(4) == 4);
+    CHECK(*tree.find_greater_equal(5) == 6);
+    CHECK(tree.find_greater(18) == tree.end());
+
+    const Linked_Tree<int>& ctree = tree;
+    CHECK(*ctree.find(4) == 4);
+    CHECK(*ctree.find_less(4) == 2);
+    CHECK(*--ctree.end() == 18);
+
+    int expected = 4;
+    for (Linked_Iterator<int> it = tree.start_iter(3), end = tree.end_iter(11); it != end; ++it) {
+        CHECK(*it == expected);
+        expected += 2;
+    }
+    CHECK(expected == 12);
+    val_tree(&tree);
+}
+
+TEST_CASE("Linked_Tree random insertion and removal") {
+    Linked_Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    std::mt19937 mt;
+    std::uniform_int_distribution<int> dist(0, 200);
+
+    for (int i = 0; i < 2000; ++i) {
+        int value = dist(mt);
+        if (mt() & 1) {
+            tree.insert(cz::heap_allocator(), value);
+        } else {
+            tree.remove(cz::heap_allocator(), tree.find(value));
+        }
+        val_tree(&tree);
+    }
+
+    size_t count = 0;
+    for (Linked_Iterator<int> it = tree.start(); it != tree.end(); ++it) {
+        ++count;
+    }
+    CHECK(count == tree.count());
+}
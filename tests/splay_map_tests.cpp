@@ -20,6 +20,9 @@ TEST_CASE("Splay_Map insertion") {
     CZ_DEFER(map.drop(cz::heap_allocator()));
     map.insert(cz::heap_allocator(), 1, "hello");
     map.insert(cz::heap_allocator(), 2, "world");
+    CHECK(map.count() == 2);
+    CHECK_FALSE(map.insert(cz::heap_allocator(), 2, "again"));
+    CHECK(map.count() == 2);
 
     Map_Iterator<int, const char*> it;
     it = map.find(1);
@@ -33,3 +36,76 @@ TEST_CASE("Splay_Map insertion") {
     it = map.find(3);
     CHECK(it == map.end());
 }
+
+TEST_CASE("Splay_Map const find") {
+    Map<int, int> map = {};
+    CZ_DEFER(map.drop(cz::heap_allocator()));
+    for (int i = 0; i < 10; ++i) {
+        map.insert(cz::heap_allocator(), i, i * i);
+    }
+
+    const Map<int, int>& cmap = map;
+    Iterator<const Pair<int, int> > it = cmap.find(3);
+    REQUIRE(it != cmap.end());
+    CHECK(it->value == 9);
+    it = cmap.find_greater(3);
+    REQUIRE(it != cmap.end());
+    CHECK(it->key == 4);
+    CHECK_FALSE(cmap.contains(10));
+    CHECK(map.tree.root->element.key == 9);
+}
+
+TEST_CASE("Splay_Map split and join") {
+    Map<int, int> map = {};
+    CZ_DEFER(map.drop(cz::heap_allocator()));
+    for (int i = 0; i < 10; ++i) {
+        map.insert(cz::heap_allocator(), i, i * i);
+    }
+
+    Map<int, int> right = map.split(4);
+    CZ_DEFER(right.drop(cz::heap_allocator()));
+    CHECK(map.count() == 4);
+    CHECK(right.count() == 6);
+    CHECK(map.contains(3));
+    CHECK_FALSE(map.contains(4));
+    CHECK(right.contains(4));
+    val_map(map);
+    val_map(right);
+
+    map.join(&right);
+    CHECK(map.count() == 10);
+    CHECK(right.count() == 0);
+    CHECK(map.find(9)->value == 81);
+    val_map(map);
+}
+
+TEST_CASE("Splay_Map build_from_sorted") {
+    Map<int, int> map = {};
+    CZ_DEFER(map.drop(cz::heap_allocator()));
+
+    Pair<int, int> pairs[10];
+    for (int i = 0; i < 10; ++i) {
+        pairs[i] = {i, i * i};
+    }
+    map.build_from_sorted(cz::heap_allocator(), {pairs, 10});
+    val_map(map);
+    CHECK(map.count() == 10);
+    CHECK(map.find(7)->value == 49);
+}
+
+TEST_CASE("Splay_Map find_from") {
+    Map<int, int> map = {};
+    CZ_DEFER(map.drop(cz::heap_allocator()));
+    for (int i = 0; i < 20; ++i) {
+        map.insert(cz::heap_allocator(), i * 2, i);
+    }
+
+    Map_Iterator<int, int> finger = map.find(10);
+    CHECK(map.find_from(finger, 12)->value == 6);
+    CHECK(map.find_from(finger, 13) == map.end());
+    CHECK(map.find_greater_from(finger, 13)->key == 14);
+    CHECK(map.find_less_from(map.find(0), 37)->key == 36);
+    CHECK(map.find_less_equal_from(map.end(), 5)->key == 4);
+    CHECK(map.find_greater_equal_from(map.find(38), 1)->key == 2);
+    val_map(map);
+}
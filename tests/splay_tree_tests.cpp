@@ -275,8 +275,10 @@ TEST_CASE("Splay_Tree random insertion") {
         std::shuffle(nums.begin(), nums.end(), g);
 
         for (size_t i = 0; i < 4096; ++i) {
+            CHECK(tree.count() == i);
             tree.insert(cz::heap_allocator(), nums[i]);
         }
+        CHECK(tree.count() == 4096);
     }
 
     Iterator<int> iter = tree.start();
@@ -323,3 +325,390 @@ TEST_CASE("Splay_Tree slice iteration") {
         CHECK(*start < 13);
     }
 }
+
+TEST_CASE("Splay_Tree random removal") {
+    Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+
+    cz::Vector<int> nums = {};
+    CZ_DEFER(nums.drop(cz::heap_allocator()));
+    nums.reserve_exact(cz::heap_allocator(), 1024);
+
+    while (nums.len < nums.cap) {
+        nums.push((int)nums.len);
+    }
+
+    std::mt19937 g{std::random_device{}()};
+    std::shuffle(nums.begin(), nums.end(), g);
+    for (size_t i = 0; i < nums.len; ++i) {
+        tree.insert(cz::heap_allocator(), nums[i]);
+    }
+    val_tree(tree);
+
+    std::shuffle(nums.begin(), nums.end(), g);
+    for (size_t i = 0; i < nums.len; ++i) {
+        INFO("i = " << i);
+        CHECK(tree.count() == nums.len - i);
+        Iterator<int> it = tree.find(nums[i]);
+        REQUIRE(it != tree.end());
+        tree.remove(cz::heap_allocator(), it);
+        CHECK_FALSE(tree.contains(nums[i]));
+        if (i % 64 == 0) {
+            val_tree(tree);
+        }
+    }
+
+    CHECK(tree.root == nullptr);
+    CHECK(tree.count() == 0);
+}
+
+TEST_CASE("Splay_Tree const find doesn't splay") {
+    Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    for (int i = 0; i < 10; ++i) {
+        tree.insert(cz::heap_allocator(), i * 2);
+    }
+
+    const Tree<int>& ctree = tree;
+    Node<int>* root = tree.root;
+
+    Iterator<const int> it;
+    it = ctree.find(4);
+    REQUIRE(it != ctree.end());
+    CHECK(*it == 4);
+    it = ctree.find(5);
+    CHECK(it == ctree.end());
+    it = ctree.find_less(5);
+    REQUIRE(it != ctree.end());
+    CHECK(*it == 4);
+    it = ctree.find_greater(5);
+    REQUIRE(it != ctree.end());
+    CHECK(*it == 6);
+    it = ctree.find_less_equal(6);
+    REQUIRE(it != ctree.end());
+    CHECK(*it == 6);
+    it = ctree.find_greater_equal(19);
+    CHECK(it == ctree.end());
+    it = ctree.find_less(0);
+    CHECK(it == ctree.end());
+    CHECK(ctree.contains(0));
+    CHECK_FALSE(ctree.contains(1));
+
+    CHECK(tree.root == root);
+    val_tree(tree);
+}
+
+TEST_CASE("Splay_Tree splay_depth") {
+    Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    tree.splay_depth = 4;
+
+    // Linear insertion makes a chain so 0 is at depth 100.
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(cz::heap_allocator(), i);
+    }
+
+    // Shallow nodes aren't splayed.
+    Iterator<int> it = tree.find(98);
+    REQUIRE(it != tree.end());
+    CHECK(*it == 98);
+    CHECK(tree.root->element == 99);
+
+    // Deep nodes are.
+    it = tree.find(0);
+    REQUIRE(it != tree.end());
+    CHECK(*it == 0);
+    CHECK(tree.root->element == 0);
+    val_tree(tree);
+}
+
+TEST_CASE("Splay_Tree split and join") {
+    Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(cz::heap_allocator(), i * 2);
+    }
+
+    Tree<int> right = tree.split(51);
+    CZ_DEFER(right.drop(cz::heap_allocator()));
+    val_tree(tree);
+    val_tree(right);
+
+    // The halves aren't counted until they are asked.
+    CHECK(tree.num_elements == Tree<int>::UNKNOWN_COUNT);
+    CHECK(right.num_elements == Tree<int>::UNKNOWN_COUNT);
+    // Counting through a const reference is remembered too.
+    const Tree<int>& const_tree = tree;
+    CHECK(const_tree.count() == 26);
+    CHECK(tree.num_elements == 26);
+    CHECK(tree.count() == 26);
+    CHECK(right.count() == 74);
+    CHECK(*tree.start() == 0);
+    CHECK(*tree.find_less(1000) == 50);
+    CHECK(*right.start() == 52);
+
+    Tree<int> right2 = right.split(52);
+    CZ_DEFER(right2.drop(cz::heap_allocator()));
+    CHECK(right.count() == 0);
+    CHECK(right2.count() == 74);
+
+    Tree<int> empty = tree.split(1000);
+    CHECK(empty.root == nullptr);
+    CHECK(empty.count() == 0);
+    CHECK(tree.count() == 26);
+
+    tree.join(&right2);
+    val_tree(tree);
+    CHECK(right2.root == nullptr);
+    CHECK(right2.count() == 0);
+    CHECK(tree.count() == 100);
+
+    Iterator<int> it = tree.start();
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(it != tree.end());
+        CHECK(*it == i * 2);
+        ++it;
+    }
+    CHECK(it == tree.end());
+
+    tree.join(&empty);
+    CHECK(tree.count() == 100);
+    empty.join(&tree);
+    CHECK(empty.count() == 100);
+    CHECK(tree.root == nullptr);
+    tree.join(&empty);
+    CHECK(tree.count() == 100);
+}
+
+TEST_CASE("Splay_Tree split and join trees made by build_from_sorted") {
+    int low[50];
+    int high[50];
+    for (int i = 0; i < 50; ++i) {
+        low[i] = i;
+        high[i] = i + 50;
+    }
+
+    Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    tree.build_from_sorted(cz::heap_allocator(), {low, 50});
+    Tree<int> other = {};
+    CZ_DEFER(other.drop(cz::heap_allocator()));
+    other.build_from_sorted(cz::heap_allocator(), {high, 50});
+
+    // Both halves keep using the block.
+    Tree<int> right = tree.split(25);
+    CZ_DEFER(right.drop(cz::heap_allocator()));
+    CHECK(tree.count() == 25);
+    CHECK(right.count() == 25);
+    CHECK(tree.blocks == right.blocks);
+
+    // Joining trees with different blocks merges their groups.
+    right.join(&other);
+    val_tree(right);
+    CHECK(right.count() == 75);
+    CHECK(other.blocks == nullptr);
+    CHECK(right.stats().bytes_allocated == 100 * sizeof(Node<int>));
+
+    Tree<int> last = right.split(90);
+    CZ_DEFER(last.drop(cz::heap_allocator()));
+    CHECK(last.count() == 10);
+
+    // Removing every node from the blocks doesn't free them.
+    for (int i = 0; i < 25; ++i) {
+        tree.remove(cz::heap_allocator(), tree.start());
+    }
+    CHECK(tree.root == nullptr);
+    tree.insert(cz::heap_allocator(), -1);
+    tree.join(&right);
+    val_tree(tree);
+    CHECK(tree.count() == 66);
+
+    Iterator<int> it = tree.start();
+    CHECK(*it == -1);
+    for (int i = 25; i < 90; ++i) {
+        ++it;
+        REQUIRE(it != tree.end());
+        CHECK(*it == i);
+    }
+}
+
+TEST_CASE("Splay_Tree join many trees made by build_from_sorted") {
+    const int num_trees = 64;
+    const int per_tree = 16;
+    Tree<int> trees[num_trees] = {};
+    for (int t = 0; t < num_trees; ++t) {
+        int elements[per_tree];
+        for (int i = 0; i < per_tree; ++i) {
+            elements[i] = (t * per_tree + i) * 2;
+        }
+        trees[t].build_from_sorted(cz::heap_allocator(), {elements, per_tree});
+    }
+
+    // Join pairwise so groups of every size are merged.
+    for (int step = 1; step < num_trees; step *= 2) {
+        for (int t = 0; t + step < num_trees; t += step * 2) {
+            trees[t].join(&trees[t + step]);
+        }
+    }
+    Tree<int> tree = trees[0];
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    val_tree(tree);
+    CHECK(tree.count() == num_trees * per_tree);
+
+    // Every block points directly at the owner.
+    Node_Block<int>* owner = tree.blocks;
+    REQUIRE(owner);
+    CHECK(owner->owner == nullptr);
+    CHECK(owner->num_blocks == num_trees);
+    for (Node_Block<int>* block = owner->next; block; block = block->next) {
+        CHECK(block->owner == owner);
+    }
+    CHECK(tree.stats().bytes_allocated == num_trees * per_tree * sizeof(Node<int>));
+
+    // Mix in heap nodes, split apart and join back.
+    for (int i = 0; i < num_trees * per_tree; i += 7) {
+        tree.insert(cz::heap_allocator(), i * 2 + 1);
+    }
+    size_t total = tree.count();
+    for (int pivot = 100; pivot < num_trees * per_tree * 2; pivot += 300) {
+        Tree<int> right = tree.split(pivot);
+        right.remove(cz::heap_allocator(), right.start());
+        tree.join(&right);
+        --total;
+    }
+    val_tree(tree);
+    CHECK(tree.count() == total);
+    CHECK(tree.stats().nodes == total);
+}
+
+TEST_CASE("Splay_Tree deep chain doesn't recurse") {
+    Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+
+    // Linear insertion makes a chain down the left side.
+    const int n = 1 << 20;
+    for (int i = 0; i < n; ++i) {
+        tree.insert(cz::heap_allocator(), i);
+    }
+
+    CHECK(ds::gen::count(tree.root) == n);
+    val_tree(tree);
+}
+
+TEST_CASE("Splay_Tree build_from_sorted") {
+    Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+
+    int nums[100];
+    for (int i = 0; i < 100; ++i) {
+        nums[i] = i * 2;
+    }
+
+    tree.build_from_sorted(cz::heap_allocator(), {nums, 100});
+    val_tree(tree);
+    CHECK(tree.count() == 100);
+    CHECK(tree.root->element == 100);
+
+    Iterator<int> it = tree.start();
+    for (int i = 0; i < 100; ++i) {
+        REQUIRE(it != tree.end());
+        CHECK(*it == i * 2);
+        ++it;
+    }
+    CHECK(it == tree.end());
+
+    // Mixing in individually allocated nodes works.
+    tree.insert(cz::heap_allocator(), 51);
+    tree.remove(cz::heap_allocator(), tree.find(50));
+    tree.remove(cz::heap_allocator(), tree.find(51));
+    tree.insert(cz::heap_allocator(), 1001);
+    CHECK(tree.count() == 100);
+    CHECK(tree.contains(1001));
+    CHECK_FALSE(tree.contains(50));
+    val_tree(tree);
+}
+
+TEST_CASE("Splay_Tree find_from matches find") {
+    Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    std::mt19937 mt;
+    std::uniform_int_distribution<int> dist(0, 400);
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(cz::heap_allocator(), dist(mt) * 2);
+    }
+
+    for (int mode = 0; mode < 2; ++mode) {
+        tree.splay_depth = mode * 3;
+        Iterator<int> finger = tree.end();
+        for (int i = 0; i < 500; ++i) {
+            int query = dist(mt);
+            const Tree<int>& ctree = tree;
+            Iterator<const int> expected_equal = ctree.find_equal(query);
+            Iterator<const int> expected_less = ctree.find_less(query);
+            Iterator<const int> expected_greater = ctree.find_greater(query);
+            Iterator<const int> expected_less_equal = ctree.find_less_equal(query);
+            Iterator<const int> expected_greater_equal = ctree.find_greater_equal(query);
+
+            CHECK(Iterator<const int>(tree.find_equal_from(finger, query)) == expected_equal);
+            CHECK(Iterator<const int>(tree.find_less_from(finger, query)) == expected_less);
+            CHECK(Iterator<const int>(tree.find_greater_from(finger, query)) == expected_greater);
+            CHECK(Iterator<const int>(tree.find_less_equal_from(finger, query)) ==
+                  expected_less_equal);
+            finger = tree.find_greater_equal_from(finger, query);
+            CHECK(Iterator<const int>(finger) == expected_greater_equal);
+            val_tree(tree);
+        }
+    }
+}
+
+TEST_CASE("Splay_Tree find_from cursor doesn't splay neighbors") {
+    Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(cz::heap_allocator(), i);
+    }
+    tree.splay_depth = 4;
+
+    // Walk the whole tree like a paginating cursor.
+    Iterator<int> cursor = tree.find_from(tree.end(), 0);
+    Node<int>* root = tree.root;
+    int expected = 0;
+    for (; cursor != tree.end(); cursor = tree.find_greater_from(cursor, *cursor)) {
+        CHECK(*cursor == expected);
+        ++expected;
+    }
+    CHECK(expected == 100);
+    CHECK(tree.root == root);
+    val_tree(tree);
+}
+
+TEST_CASE("Splay_Tree stats") {
+    Tree<int> tree = {};
+    CZ_DEFER(tree.drop(cz::heap_allocator()));
+
+    // Inserting in order makes a chain down the left.
+    for (int i = 0; i < 100; ++i) {
+        tree.insert(cz::heap_allocator(), i);
+    }
+
+    Tree_Stats stats = tree.stats();
+    CHECK(stats.nodes == 100);
+    CHECK(stats.height == 100);
+    CHECK(stats.average_depth() == 50.5);
+    CHECK(stats.nodes_per_level[0] == 1);
+    CHECK(stats.nodes_per_level[Tree_Stats::LEVELS - 1] == 100 - Tree_Stats::LEVELS + 1);
+    CHECK(stats.bytes_allocated == 100 * sizeof(Node<int>));
+    CHECK(stats.bytes_payload == 100 * sizeof(int));
+
+    Tree<int> balanced = {};
+    CZ_DEFER(balanced.drop(cz::heap_allocator()));
+    int elements[] = {1, 2, 3, 4, 5, 6, 7};
+    balanced.build_from_sorted(cz::heap_allocator(), {elements, 7});
+    balanced.remove(cz::heap_allocator(), balanced.find_equal(7));
+
+    stats = balanced.stats();
+    CHECK(stats.nodes == 6);
+    // Removed nodes stay allocated in the block.
+    CHECK(stats.bytes_allocated == 7 * sizeof(Node<int>));
+    CHECK(stats.bytes_payload == 6 * sizeof(int));
+}
@@ -0,0 +1,99 @@
+#include <czt/test_base.hpp>
+
+#include <cz/defer.hpp>
+#include <cz/heap.hpp>
+#include <random>
+#include "ssostr.hpp"
+
+using namespace cz;
+using namespace ds;
+
+static int64_t sign(int64_t value) {
+    return (value > 0) - (value < 0);
+}
+
+/// Reference comparison on the raw bytes.
+static int64_t reference_compare(Str left, Str right) {
+    size_t len = left.len < right.len ? left.len : right.len;
+    for (size_t i = 0; i < len; ++i) {
+        if (left.buffer[i] != right.buffer[i])
+            return (unsigned char)left.buffer[i] < (unsigned char)right.buffer[i] ? -1 : 1;
+    }
+    return sign((int64_t)left.len - (int64_t)right.len);
+}
+
+TEST_CASE("SSOStr short strings are padded") {
+    SSOStr a = SSOStr::from_constant("abc");
+    SSOStr b = SSOStr::as_duplicate(cz::heap_allocator(), "abc");
+    CHECK(a.is_short());
+    CHECK(a == b);
+    CHECK(a.hash() == b.hash());
+    CHECK(compare(a, b) == 0);
+
+    SSOStr c = SSOStr::from_char('a');
+    CHECK(c < a);
+    CHECK(compare(c, a) < 0);
+    CHECK(compare(a, c) > 0);
+}
+
+TEST_CASE("SSOStr prefixes and embedded nulls") {
+    SSOStr empty = SSOStr::from_constant("");
+    SSOStr a = SSOStr::from_constant("ab");
+    SSOStr b = SSOStr::from_constant({"ab\0", 3});
+    SSOStr c = SSOStr::from_constant("abc");
+    CHECK(empty < a);
+    CHECK(a < b);
+    CHECK(b < c);
+    CHECK(a != b);
+    CHECK(a.hash() != b.hash());
+}
+
+TEST_CASE("SSOStr long strings") {
+    const char* text = "a string that is definitely too long to be short";
+    SSOStr a = SSOStr::as_duplicate(cz::heap_allocator(), text);
+    CZ_DEFER(a.drop(cz::heap_allocator()));
+    SSOStr b = SSOStr::as_duplicate(cz::heap_allocator(), text);
+    CZ_DEFER(b.drop(cz::heap_allocator()));
+    SSOStr c = SSOStr::from_constant(text);
+    CHECK_FALSE(a.is_short());
+    CHECK(a == b);
+    CHECK(a == c);
+    CHECK(a.hash() == b.hash());
+
+    SSOStr shorter = SSOStr::from_constant({text, 20});
+    SSOStr short_ = SSOStr::from_constant({text, 10});
+    CHECK(shorter < a);
+    CHECK(short_ < shorter);
+    CHECK(short_ != shorter);
+    CHECK(compare(a, short_) > 0);
+}
+
+TEST_CASE("SSOStr compare matches byte comparison") {
+    std::mt19937 mt;
+    // Few distinct characters so there are lots of shared prefixes.
+    const char alphabet[] = {'a', 'b', '\0', (char)0xff};
+    char buffers[2][40];
+    for (int i = 0; i < 10000; ++i) {
+        size_t lens[2];
+        for (int j = 0; j < 2; ++j) {
+            lens[j] = mt() % 40;
+            for (size_t k = 0; k < lens[j]; ++k) {
+                buffers[j][k] = alphabet[mt() % 4];
+            }
+        }
+        if (mt() & 1) {
+            // Make one a prefix of the other.
+            memcpy(buffers[1], buffers[0], lens[0] < lens[1] ? lens[0] : lens[1]);
+        }
+
+        Str left = {buffers[0], lens[0]};
+        Str right = {buffers[1], lens[1]};
+        SSOStr a = SSOStr::from_constant(left);
+        SSOStr b = SSOStr::from_constant(right);
+        int64_t expected = reference_compare(left, right);
+        CHECK(sign(compare(a, b)) == expected);
+        CHECK((a == b) == (expected == 0));
+        if (expected == 0)
+            CHECK(a.hash() == b.hash());
+    }
+}
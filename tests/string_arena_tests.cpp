@@ -0,0 +1,110 @@
+#include <czt/test_base.hpp>
+
+#include <stdio.h>
+#include <cz/defer.hpp>
+#include <cz/heap.hpp>
+#include "btree_map.hpp"
+#include "ssostr.hpp"
+#include "string_arena.hpp"
+
+using namespace cz;
+using namespace ds;
+
+TEST_CASE("String_Arena packs allocations") {
+    String_Arena arena = {};
+    CZ_DEFER(arena.drop(cz::heap_allocator()));
+
+    char* a = arena.alloc(cz::heap_allocator(), 3);
+    char* b = arena.alloc(cz::heap_allocator(), 5);
+    CHECK(b == a + 3);
+
+    char* c = arena.alloc(cz::heap_allocator(), 8, 8);
+    CHECK(((size_t)c & 7) == 0);
+
+    Str str = arena.duplicate(cz::heap_allocator(), "hello");
+    CHECK(str == "hello");
+}
+
+TEST_CASE("String_Arena large allocations get their own chunk") {
+    String_Arena arena = {};
+    arena.chunk_size = 256;
+    CZ_DEFER(arena.drop(cz::heap_allocator()));
+
+    char* small = arena.alloc(cz::heap_allocator(), 10);
+    char* big = arena.alloc(cz::heap_allocator(), 1000);
+    memset(big, 'x', 1000);
+    CHECK(arena.first != arena.current);
+
+    // Small allocations continue after the big one.
+    char* after = arena.alloc(cz::heap_allocator(), 10);
+    CHECK(after != small + 10);
+}
+
+TEST_CASE("String_Arena reset reuses chunks") {
+    String_Arena arena = {};
+    arena.chunk_size = 256;
+    CZ_DEFER(arena.drop(cz::heap_allocator()));
+
+    char* first = arena.alloc(cz::heap_allocator(), 100);
+    for (int i = 0; i < 10; ++i) {
+        arena.alloc(cz::heap_allocator(), 100);
+    }
+    detail::String_Arena_Chunk* chunks = arena.first;
+    detail::String_Arena_Chunk* last = arena.current;
+
+    arena.reset();
+    CHECK(arena.alloc(cz::heap_allocator(), 100) == first);
+    for (int i = 0; i < 10; ++i) {
+        arena.alloc(cz::heap_allocator(), 100);
+    }
+    CHECK(arena.first == chunks);
+    CHECK(arena.current == last);
+}
+
+TEST_CASE("SSOStr::in_arena") {
+    String_Arena arena = {};
+    CZ_DEFER(arena.drop(cz::heap_allocator()));
+
+    SSOStr a = SSOStr::in_arena(&arena, cz::heap_allocator(), "short");
+    CHECK(a.is_short());
+    CHECK(a.as_str() == "short");
+
+    SSOStr b = SSOStr::in_arena(&arena, cz::heap_allocator(), "a string too long to be short");
+    CHECK_FALSE(b.is_short());
+    CHECK(b.as_str() == "a string too long to be short");
+    CHECK(b.buffer() == (char*)(arena.first + 1));
+}
+
+TEST_CASE("btree::Map with keys in a String_Arena") {
+    String_Arena arena = {};
+    CZ_DEFER(arena.drop(cz::heap_allocator()));
+
+    for (int round = 0; round < 2; ++round) {
+        btree::Map<SSOStr, int> map = {};
+        for (int i = 0; i < 100; ++i) {
+            char buffer[64];
+            int len = snprintf(buffer, sizeof(buffer), "a fairly long key number %d", i);
+            map.insert(cz::heap_allocator(),
+                       SSOStr::in_arena(&arena, cz::heap_allocator(), {buffer, (size_t)len}), i);
+        }
+
+        SSOStr key = SSOStr::from_constant("a fairly long key number 42");
+        REQUIRE(map.find(key) != map.end());
+        CHECK(map.find(key)->value == 42);
+
+        // No per key drop.
+        map.drop(cz::heap_allocator());
+        arena.reset();
+    }
+}
+
+TEST_CASE("btree::Map drop_with_keys") {
+    btree::Map<SSOStr, int> map = {};
+    for (int i = 0; i < 100; ++i) {
+        char buffer[64];
+        int len = snprintf(buffer, sizeof(buffer), "a fairly long key number %d", i);
+        map.insert(cz::heap_allocator(),
+                   SSOStr::as_duplicate(cz::heap_allocator(), {buffer, (size_t)len}), i);
+    }
+    map.drop_with_keys(cz::heap_allocator(), cz::heap_allocator());
+}
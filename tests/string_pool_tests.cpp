@@ -0,0 +1,62 @@
+#include <czt/test_base.hpp>
+
+#include <stdio.h>
+#include <cz/defer.hpp>
+#include <cz/heap.hpp>
+#include "string_pool.hpp"
+
+using namespace cz;
+using namespace ds;
+
+TEST_CASE("String_Pool short strings are inline") {
+    String_Pool pool = {};
+    CZ_DEFER(pool.drop(cz::heap_allocator()));
+
+    SSOStr a = pool.intern(cz::heap_allocator(), "abc");
+    SSOStr b = pool.intern(cz::heap_allocator(), "abc");
+    CHECK(a.is_short());
+    CHECK(interned_equal(a, b));
+    CHECK(pool.count() == 0);
+}
+
+TEST_CASE("String_Pool long strings share buffers") {
+    String_Pool pool = {};
+    CZ_DEFER(pool.drop(cz::heap_allocator()));
+
+    char buffer[] = "a string long enough to be allocated";
+    SSOStr a = pool.intern(cz::heap_allocator(), buffer);
+    buffer[0] = 'b';
+    SSOStr b = pool.intern(cz::heap_allocator(), buffer);
+    buffer[0] = 'a';
+    SSOStr c = pool.intern(cz::heap_allocator(), buffer);
+
+    CHECK_FALSE(a.is_short());
+    CHECK(a.buffer() != buffer);
+    CHECK(a.as_str() == "a string long enough to be allocated");
+    CHECK(b.as_str() == "b string long enough to be allocated");
+    CHECK(a.buffer() == c.buffer());
+    CHECK(interned_equal(a, c));
+    CHECK_FALSE(interned_equal(a, b));
+    CHECK(pool.count() == 2);
+}
+
+TEST_CASE("String_Pool many strings") {
+    String_Pool pool = {};
+    CZ_DEFER(pool.drop(cz::heap_allocator()));
+
+    SSOStr strings[1000];
+    for (int i = 0; i < 1000; ++i) {
+        char buffer[64];
+        int len = snprintf(buffer, sizeof(buffer), "identifier_number_%d", i);
+        strings[i] = pool.intern(cz::heap_allocator(), {buffer, (size_t)len});
+    }
+    CHECK(pool.count() == 1000);
+
+    for (int i = 0; i < 1000; ++i) {
+        char buffer[64];
+        int len = snprintf(buffer, sizeof(buffer), "identifier_number_%d", i);
+        SSOStr str = pool.intern(cz::heap_allocator(), {buffer, (size_t)len});
+        CHECK(interned_equal(str, strings[i]));
+    }
+    CHECK(pool.count() == 1000);
+}